@@ -1,6 +1,7 @@
 //
 // Created by Ion Agorria on 8/04/18
 //
+#include "engine/core/profiler.h"
 #include "engine/core/utils.h"
 #include "engine/io/log.h"
 #include "asset_palette.h"
@@ -75,6 +76,10 @@ int AssetManager::getAssetsCount() {
     return assetsCount;
 }
 
+size_t AssetManager::getResidentBytes() {
+    return residentBytes;
+}
+
 void AssetManager::clearAssets() {
     //Delete all stored assets
     if (assetsCount) {
@@ -82,6 +87,7 @@ void AssetManager::clearAssets() {
     }
     assets.clear();
     assetsCount = 0;
+    residentBytes = 0;
 }
 
 void AssetManager::registerAssetContainer(const std::string& containerName, bool required) {
@@ -89,6 +95,7 @@ void AssetManager::registerAssetContainer(const std::string& containerName, bool
 }
 
 void AssetManager::loadAssets() {
+    PROFILE_ZONE("AssetManager::loadAssets");
     //Clear any old assets
     clearAssets();
 
@@ -248,6 +255,7 @@ void AssetManager::processImages(
         std::shared_ptr<Image> atlasImage = std::make_shared<Image>(Vector2(static_cast<int>(textureSize)), withPalette);
         error = atlasImage->getError();
         if (!error.empty()) return;
+        residentBytes += static_cast<size_t>(textureSize) * textureSize * (withPalette ? 1 : 4);
 
         //Setup the rects and add the index so we know which image does reference
         unsigned int imageCount = (unsigned int) std::min((size_t) batchSize, lastSize);
@@ -51,6 +51,11 @@ private:
      */
     int assetsCount = 0;
 
+    /**
+     * Bytes used by the atlas textures of loaded images
+     */
+    size_t residentBytes = 0;
+
     /**
      * Loads the assets data in the container from files into memory
      *
@@ -139,6 +144,11 @@ public:
      */
     int getAssetsCount();
 
+    /**
+     * @return the bytes used by the atlas textures of loaded images
+     */
+    size_t getResidentBytes();
+
     /**
      * Clears all loaded assets from manager
      */
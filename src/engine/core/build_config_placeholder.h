@@ -44,4 +44,14 @@
 #define GAME_UPDATES_PER_SECOND 30
 #endif
 
+/* Enables debug log calls, they are removed from build otherwise */
+#ifndef GAME_LOG_DEBUG
+#define GAME_LOG_DEBUG true
+#endif
+
+/* Enables the zone profiler instrumentation */
+#ifndef GAME_PROFILER
+#define GAME_PROFILER false
+#endif
+
 #endif //OPENE2140_BUILD_CONFIG_PLACEHOLDER_H
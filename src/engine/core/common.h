@@ -49,12 +49,15 @@
 #define TEXTURE_UNIT_PALETTE_EXTRA GL_TEXTURE3
 /** Constant for infinity cost */
 #define PATHFINDER_INFINITY (static_cast<path_cost_t>(-1))
+/** Default amount of vertices that pathfinders of all players can expand in each simulation update */
+#define PATHFINDER_DEFAULT_BUDGET 4000
 /** Flags for program */
 #define FLAG_DEBUG               static_cast<unsigned>(               0b1)
 #define FLAG_DEBUG_ALL           static_cast<unsigned>(              0b10)
 #define FLAG_DEBUG_OPENGL        static_cast<unsigned>(             0b100)
 #define FLAG_INSTALLATION_PARENT static_cast<unsigned>(         0b1000000)
 #define FLAG_HEADLESS            static_cast<unsigned>(        0b10000000)
+#define FLAG_BENCHMARK_JOBS      static_cast<unsigned>(       0b100000000)
 /** Flags for tile states */
 #define TILE_FLAG_PASSABLE       static_cast<unsigned>(               0b1)
 #define TILE_FLAG_WATER          static_cast<unsigned>(              0b10)
@@ -63,5 +66,19 @@
 #define TILE_FLAG_SAND           static_cast<unsigned>(           0b10000)
 #define TILE_FLAG_ENTITY_TERRAIN static_cast<unsigned>(          0b100000) //Flag if contains an entity in ground/water
 #define TILE_FLAG_ENTITY_AIR     static_cast<unsigned>(         0b1000000) //Flag if contains entity in air
+/** Flags for image component animation state */
+#define ANIMATION_FLAG_PLAY      static_cast<unsigned>(               0b1) //Animation advances with simulation ticks
+#define ANIMATION_FLAG_REVERSE   static_cast<unsigned>(              0b10) //Frames are played from last to first
+#define ANIMATION_FLAG_PINGPONG  static_cast<unsigned>(             0b100) //Frames are played forth and back continuously
+/** Flags for entity changes notified to components */
+#define ENTITY_CHANGE_POSITION   static_cast<unsigned>(               0b1) //Position or bounds
+#define ENTITY_CHANGE_DIRECTION  static_cast<unsigned>(              0b10)
+#define ENTITY_CHANGE_ROTATION   static_cast<unsigned>(             0b100) //Target direction or rotation speed
+#define ENTITY_CHANGE_HEALTH     static_cast<unsigned>(            0b1000)
+#define ENTITY_CHANGE_ENERGY     static_cast<unsigned>(           0b10000)
+#define ENTITY_CHANGE_SELECTION  static_cast<unsigned>(          0b100000) //Selectable or disable state
+#define ENTITY_CHANGE_ATTACHMENT static_cast<unsigned>(         0b1000000) //Parent or attached entities
+#define ENTITY_CHANGE_PLAYER     static_cast<unsigned>(        0b10000000)
+#define ENTITY_CHANGE_ALL        static_cast<unsigned>(        0b11111111)
 
 #endif //OPENE2140_COMMON_H
@@ -8,12 +8,18 @@
 #include "engine/graphics/window.h"
 #include "engine/gui/gui_root.h"
 #include "engine/simulation/simulation.h"
+#include "engine/simulation/replay.h"
+#include "engine/simulation/save_stream.h"
 #include "engine/simulation/faction.h"
 #include "engine/simulation/world/world.h"
 #include "src/engine/entities/entity_manager.h"
 #include "engine/io/event_handler.h"
 #include "engine/core/utils.h"
 #include "engine/io/timer.h"
+#include "engine/io/scheduler.h"
+#include "engine/io/metrics.h"
+#include "engine/core/job_system.h"
+#include "engine/core/profiler.h"
 #include "engine/io/config.h"
 #include "engine/gui/locale.h"
 #include "engine.h"
@@ -23,6 +29,7 @@ int Engine::main(int argc, char** argv, std::shared_ptr<Engine> engine) {
     Utils::setSignalHandler(Utils::handleHaltAndCatchFire, Utils::handleTerminate);
 
     //Parse args
+    float profileSeconds = 0;
     for(int i=1; i < argc; i++) {
         std::string arg = argv[i];
         std::transform(BEGIN_END(arg), arg.begin(), ::tolower);
@@ -37,6 +44,42 @@ int Engine::main(int argc, char** argv, std::shared_ptr<Engine> engine) {
             Utils::setFlag(FLAG_INSTALLATION_PARENT, true);
         } else if (arg == "--headless" || arg == "-hl") {
             Utils::setFlag(FLAG_HEADLESS, true);
+        } else if (arg == "--profile") {
+            //Optional amount of seconds to capture
+            profileSeconds = PROFILER_DEFAULT_SECONDS;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                profileSeconds = std::stof(argv[++i]);
+            }
+        } else if (arg == "--record") {
+            //Optional path to record into
+            engine->recordPath = Utils::getUserPath() + REPLAY_DEFAULT_FILE;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                engine->recordPath = argv[++i];
+            }
+        } else if (arg == "--replay") {
+            //Replays are played headless at maximum speed
+            if (i + 1 < argc) {
+                engine->replayPath = argv[++i];
+                Utils::setFlag(FLAG_HEADLESS, true);
+            } else {
+                std::cout << "Missing replay path\n";
+            }
+        } else if (arg == "--batch") {
+            //Batches are run headless at maximum speed
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                engine->batchCount = std::stoul(argv[++i]);
+                Utils::setFlag(FLAG_HEADLESS, true);
+            } else {
+                std::cout << "Missing batch simulations count\n";
+            }
+        } else if (arg == "--load") {
+            if (i + 1 < argc) {
+                engine->loadPath = argv[++i];
+            } else {
+                std::cout << "Missing save path\n";
+            }
+        } else if (arg == "--benchmark_jobs") {
+            Utils::setFlag(FLAG_BENCHMARK_JOBS, true);
         } else {
             std::cout << "Unknown arg " << arg << "\n";
         }
@@ -45,6 +88,21 @@ int Engine::main(int argc, char** argv, std::shared_ptr<Engine> engine) {
     //Initialize log
     log_ptr log = Log::get(MAIN_LOG);
 
+    //Start capturing zones if requested
+    if (0 < profileSeconds) {
+        Profiler::start(profileSeconds);
+        Profiler::setThreadName("Main");
+        log->info("Profiling first {0} seconds", profileSeconds);
+    }
+
+    //Run the job system benchmark instead of engine if requested
+    if (Utils::isFlag(FLAG_BENCHMARK_JOBS)) {
+        JobSystem::benchmark(log);
+        Log::closeAll();
+        Utils::restoreSignalHandler();
+        return 0;
+    }
+
     //Initialize SDL2 and run if success
     std::string error;
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_TIMER) != 0) {
@@ -86,6 +144,8 @@ Engine::~Engine() {
 
 void Engine::close() {
     log->debug("Closing");
+    stopRenderThread();
+    Profiler::stop();
     if (eventHandler) {
         eventHandler.reset();
     }
@@ -93,6 +153,16 @@ void Engine::close() {
         guiRoot.reset();
     }
     if (simulation) {
+        //Write the recorded replay if any
+        std::unique_ptr<Replay> recorded = simulation->stopRecording();
+        if (recorded) {
+            recorded->write(recordPath);
+            if (recorded->hasError()) {
+                log->error("Error writing replay to {0}:\n{1}", recordPath, recorded->getError());
+            } else {
+                log->info("Replay with {0} ticks written to {1}", recorded->ticks, recordPath);
+            }
+        }
         simulation->close();
         simulation.reset();
     }
@@ -114,6 +184,25 @@ void Engine::close() {
     if (drawTimer) {
         drawTimer.reset();
     }
+    if (scheduler) {
+        scheduler.reset();
+    }
+    if (jobSystem) {
+        jobSystem.reset();
+    }
+    if (replay) {
+        replay.reset();
+    }
+    if (saveReader) {
+        saveReader.reset();
+    }
+    if (autosaveTimer) {
+        autosaveTimer.reset();
+    }
+    if (metrics) {
+        metrics->update(true);
+        metrics.reset();
+    }
 }
 
 void Engine::run() {
@@ -142,9 +231,61 @@ void Engine::run() {
         return;
     }
 
+    //Load replay to play if requested
+    if (!replayPath.empty()) {
+        replay = std::make_unique<Replay>();
+        replay->read(replayPath);
+        error = replay->getError();
+        if (hasError()) {
+            error = "Error loading replay " + replayPath + "\n" + error;
+            return;
+        }
+
+        //Replays recorded after loading a save start from that save
+        if (loadPath.empty()) {
+            loadPath = replay->save;
+        } else if (loadPath != replay->save) {
+            error = "Replay " + replayPath + " was recorded from save '" + replay->save + "' instead of " + loadPath;
+            return;
+        }
+    }
+
+    //Load save to restore if requested
+    if (!loadPath.empty()) {
+        saveReader = std::make_unique<SaveReader>();
+        saveReader->open(loadPath);
+        error = saveReader->getError();
+        if (hasError()) {
+            error = "Error loading save " + loadPath + "\n" + error;
+            return;
+        }
+    }
+
     //Initialize timers
     updateTimer = std::make_unique<Timer>();
+    autosaveTimer = std::make_unique<Timer>();
+    autosaveInterval = getData<float>("autosave_interval", 0);
     drawTimer = std::make_unique<Timer>();
+    scheduler = std::make_unique<Scheduler>(
+            GAME_UPDATES_PER_SECOND,
+            getData<unsigned int>("max_catchup_ticks", 5),
+            getData<unsigned int>("fps_limit", 120)
+    );
+
+    //Initialize metrics, dumping is disabled unless an interval is set
+    metrics = std::make_unique<Metrics>();
+    metrics->setDump(
+            getData<float>("metrics_interval", 0),
+            getData<const std::string>("metrics_format", "csv")
+    );
+    metricTick = metrics->histogram(METRIC_TICK_MS);
+    metricFrame = metrics->histogram(METRIC_FRAME_MS);
+    metricDrawCalls = metrics->counter(METRIC_DRAW_CALLS);
+    metricVerticesUploaded = metrics->counter(METRIC_VERTICES_UPLOADED);
+
+    //Initialize job system, 0 threads uses all available cores
+    jobSystem = std::make_unique<JobSystem>(getData<unsigned int>("job_threads", 0));
+    log->debug("Job system threads: {0}", jobSystem->getThreadsCount());
 
     //Initialize event handler
     eventHandler = std::make_unique<EventHandler>(this_ptr);
@@ -201,29 +342,219 @@ void Engine::run() {
     }
 }
 
-void Engine::update() {
-    //Check if we should skip update
-    float updateTimerElapsed = updateTimer->elapsed();
-    if (GAME_DELTA > updateTimerElapsed * 1000) {
+void Engine::loop() {
+    //Play the replay instead if any
+    if (replay) {
+        playReplay();
         return;
     }
+
+    //Record from here so the setup done before loop is not recorded as commands
+    if (simulation && !recordPath.empty()) {
+        simulation->startRecording(loadPath);
+    }
+
+    //Render in separate thread if requested so updates and drawing don't delay each other
+    bool drawing = window && renderer;
+    if (drawing && getData<bool>("render_thread", false)) {
+        startRenderThread();
+    }
+
+    while (!eventHandler->isClosing()) {
+        //Dump the profiler trace once capture time passes and metrics when interval passes
+        Profiler::update();
+        metrics->update();
+
+        //Poll input
+        {
+            std::lock_guard<std::mutex> lock(guiMutex);
+            eventHandler->poll();
+        }
+
+        //Run the due fixed updates
+        unsigned int ticks = scheduler->advance();
+        for (unsigned int i = 0; i < ticks && !eventHandler->isClosing(); ++i) {
+            update();
+        }
+
+        //Autosave between updates if interval passed
+        if (simulation && 0 < autosaveInterval && autosaveInterval <= autosaveTimer->elapsed()) {
+            autosaveTimer->update();
+            saveSimulation(Utils::getUserPath() + SAVE_AUTOSAVE_FILE);
+        }
+
+        //Draw the current state and wait for next frame or tick
+        if (renderThread.joinable()) {
+            updateTitle();
+            scheduler->waitTick();
+        } else if (drawing) {
+            draw();
+            updateTitle();
+            scheduler->waitFrame();
+        } else {
+            scheduler->waitTick();
+        }
+    }
+
+    stopRenderThread();
+}
+
+void Engine::playReplay() {
+    if (!simulation) {
+        error = "No simulation to replay";
+        return;
+    }
+    log->info("Playing replay from tick {0} to {1} with {2} commands", replay->startTick, replay->ticks, replay->commands.size());
+    uint64_t startTick = simulation->getTick();
+    Timer timer;
+    error = runSimulation(simulation.get(), replay->ticks, true);
+    if (!hasError()) {
+        log->info("Replay state matches recording");
+    }
+
+    //Show how much faster than realtime it was
+    float elapsed = std::max(0.0001f, timer.elapsed());
+    uint64_t ticks = simulation->getTick() - startTick;
+    float simulated = static_cast<float>(ticks) * (GAME_DELTA / 1000.0f);
+    log->info("Replay finished {0} ticks in {1} seconds, {2}x realtime", ticks, elapsed, simulated / elapsed);
+}
+
+void Engine::runBatch() {
+    //Replays define how long to run, otherwise use the configured amount
+    uint64_t ticks = replay ? replay->ticks : getData<uint64_t>("batch_ticks", GAME_UPDATES_PER_SECOND * 60 * 10);
+
+    //Simulations only split their updates when there are more threads than simulations to run
+    bool parallelUpdates = batchCount < jobSystem->getThreadsCount();
+
+    //Create simulations sequentially since loading reads assets which is not thread safe
+    std::vector<std::unique_ptr<Simulation>> simulations;
+    for (size_t i = 0; i < batchCount; ++i) {
+        std::unique_ptr<SimulationParameters> parameters = createSimulationParameters();
+        if (!parameters) {
+            error = "No simulation parameters to run batch";
+            return;
+        }
+        //Each simulation gets a different seed, replays and saves override it with their own
+        parameters->seed += static_cast<long>(i);
+        parameters->parallelUpdates = parallelUpdates;
+
+        //Each simulation reads its own save
+        std::unique_ptr<SaveReader> reader;
+        if (!loadPath.empty()) {
+            reader = std::make_unique<SaveReader>();
+            reader->open(loadPath);
+            error = reader->getError();
+            if (hasError()) {
+                error = "Error loading save " + loadPath + "\n" + error;
+                return;
+            }
+        }
+        std::unique_ptr<Simulation> simulationPtr = createSimulation(std::move(parameters), reader.get());
+        if (hasError()) {
+            return;
+        }
+        simulations.emplace_back(std::move(simulationPtr));
+    }
+
+    //Run each simulation in its own job, they don't share mutable state so no synchronization is required
+    log->info("Running batch of {0} simulations for {1} ticks", simulations.size(), ticks);
+    std::vector<std::string> errors(simulations.size());
+    Timer timer;
+    jobSystem->parallelFor(simulations.size(), 1, [&](size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+            errors[i] = runSimulation(simulations[i].get(), ticks, false);
+        }
+    });
+    float elapsed = std::max(0.0001f, timer.elapsed());
+
+    //Show results of each simulation
+    uint64_t totalTicks = 0;
+    for (size_t i = 0; i < simulations.size(); ++i) {
+        Simulation* simulationPtr = simulations[i].get();
+        totalTicks += simulationPtr->getTick();
+        if (!errors[i].empty()) {
+            log->error("Batch simulation {0} failed: {1}", i, errors[i]);
+            error = errors[i];
+            continue;
+        }
+        log->info("Batch simulation {0} finished at tick {1} with state hash {2:x}", i, simulationPtr->getTick(), simulationPtr->getStateHash().get());
+    }
+
+    //Show throughput of whole batch
+    float simulated = static_cast<float>(totalTicks) * (GAME_DELTA / 1000.0f);
+    log->info("Batch finished {0} ticks in {1} seconds, {2} ticks per second, {3}x realtime", totalTicks, elapsed, static_cast<float>(totalTicks) / elapsed, simulated / elapsed);
+}
+
+std::string Engine::runSimulation(Simulation* simulationPtr, uint64_t ticks, bool mainThread) {
+    if (replay && simulationPtr->getTick() != replay->startTick) {
+        return "Replay starts at tick " + std::to_string(replay->startTick)
+               + " but simulation is at tick " + std::to_string(simulationPtr->getTick());
+    }
+    size_t next = 0;
+    while (simulationPtr->getTick() < ticks && !eventHandler->isClosing()) {
+        //Profiler and metrics dumps are done by main thread only
+        if (mainThread) {
+            Profiler::update();
+            metrics->update();
+        }
+
+        //Apply the commands issued before this update
+        uint64_t tick = simulationPtr->getTick();
+        while (replay && next < replay->commands.size() && replay->commands[next].tick <= tick) {
+            applyCommand(simulationPtr, replay->commands[next]);
+            next++;
+        }
+
+        Timer tickTimer;
+        simulationPtr->update();
+        metricTick->record(tickTimer.elapsed() * 1000.0);
+
+        //Check the state matches the recorded one
+        if (!replay) {
+            continue;
+        }
+        tick = simulationPtr->getTick();
+        uint64_t elapsed = tick - replay->startTick;
+        size_t hashIndex = elapsed / REPLAY_HASH_INTERVAL;
+        if (elapsed % REPLAY_HASH_INTERVAL == 0 && 0 < hashIndex && hashIndex <= replay->hashes.size()) {
+            uint64_t hash = simulationPtr->getStateHash().get();
+            if (hash != replay->hashes[hashIndex - 1]) {
+                std::string divergence = "Replay diverged from recording at tick " + std::to_string(tick);
+                log->error("{0}, state hash {1:x} expected {2:x}", divergence, hash, replay->hashes[hashIndex - 1]);
+                return divergence;
+            }
+        }
+    }
+    if (replay && simulationPtr->getTick() == replay->ticks && simulationPtr->getStateHash().get() != replay->hash) {
+        return "Replay final state differs from recording";
+    }
+    return "";
+}
+
+void Engine::applyCommand(Simulation* simulationPtr, const SimulationCommand& command) {
+    log->warn("Unhandled command type {0} for entity {1}", static_cast<int>(command.type), command.entity);
+}
+
+void Engine::update() {
+    float updateTimerElapsed = updateTimer->elapsed();
     updateElapsedAvg *= 0.8;
     updateElapsedAvg += (std::max(0.0001f, updateTimerElapsed) * 0.2f);
     updateTimer->update();
 
-    //Update simulation
+    //Update simulation, this is not guarded as render thread only reads the published snapshots
     if (simulation) {
+        Timer tickTimer;
         simulation->update();
+        metricTick->record(tickTimer.elapsed() * 1000.0);
     }
 
+    std::lock_guard<std::mutex> lock(guiMutex);
+
     //Update UI
     if (guiRoot) {
         guiRoot->update();
     }
 
-    //Poll input
-    eventHandler->poll();
-
     //Update event handlers
     eventHandler->eventUpdate();
 }
@@ -234,32 +565,80 @@ void Engine::draw() {
         return;
     }
 
-    //Clear
-    window->clear();
+    {
+        std::lock_guard<std::mutex> lock(guiMutex);
 
-    //Draw UI
-    if (guiRoot) {
-        renderer->changeCamera(0, 0);
-        guiRoot->draw();
-    }
+        //Prepare and clear
+        renderer->prepareFrame();
+        window->clear();
 
-    //Flush renderer
-    renderer->flush();
-    size_t flushes = renderer->flushes;
-    renderer->flushes = 0;
+        //Draw UI
+        if (guiRoot) {
+            renderer->changeCamera(0, 0);
+            guiRoot->draw();
+        }
 
-    //Update timer and title
-    drawElapsedAvg *= 0.8;
-    drawElapsedAvg += (std::max(0.0001f, drawTimer->elapsed()) * 0.2f);
-    int ups = static_cast<int>(std::round(1.0f / updateElapsedAvg));
-    int fps = static_cast<int>(std::round(1.0f / drawElapsedAvg));
-    window->setTitle(std::to_string(ups) + " UPS " + std::to_string(fps) + " FPS " + std::to_string(flushes) + " Flushes");
+        //Flush renderer
+        renderer->flush();
+        drawFlushes = renderer->flushes;
+        metricDrawCalls->add(renderer->flushes);
+        metricVerticesUploaded->add(renderer->verticesUploaded);
+        renderer->flushes = 0;
+        renderer->verticesUploaded = 0;
+    }
+
+    //Update timer
+    float drawTimerElapsed = drawTimer->elapsed();
+    metricFrame->record(drawTimerElapsed * 1000.0);
+    drawElapsedAvg = drawElapsedAvg * 0.8f + std::max(0.0001f, drawTimerElapsed) * 0.2f;
     drawTimer->update();
 
     //Update window content
     window->swap();
 }
 
+void Engine::renderLoop() {
+    if (!window->setContextCurrent(true)) {
+        log->error("Couldn't make context current in render thread\n{0}", Utils::checkSDLError());
+        return;
+    }
+    Profiler::setThreadName("Render");
+    while (renderThreadRunning) {
+        draw();
+        scheduler->waitFrame();
+    }
+    window->setContextCurrent(false);
+}
+
+void Engine::startRenderThread() {
+    if (renderThread.joinable()) {
+        return;
+    }
+    log->debug("Starting render thread");
+    window->setContextCurrent(false);
+    renderThreadRunning = true;
+    renderThread = std::thread(&Engine::renderLoop, this);
+}
+
+void Engine::stopRenderThread() {
+    if (!renderThread.joinable()) {
+        return;
+    }
+    log->debug("Stopping render thread");
+    renderThreadRunning = false;
+    renderThread.join();
+    window->setContextCurrent(true);
+}
+
+void Engine::updateTitle() {
+    if (!window) {
+        return;
+    }
+    int ups = static_cast<int>(std::round(1.0f / std::max(0.0001f, updateElapsedAvg)));
+    int fps = static_cast<int>(std::round(1.0f / std::max(0.0001f, drawElapsedAvg.load())));
+    window->setTitle(std::to_string(ups) + " UPS " + std::to_string(fps) + " FPS " + std::to_string(drawFlushes) + " Flushes");
+}
+
 void Engine::setupEventHandler() {
 }
 
@@ -277,6 +656,7 @@ void Engine::setupAssetManager() {
     assetManager->loadAssets();
     error = assetManager->getError();
     if (!error.empty()) return;
+    metrics->gauge(METRIC_ASSET_BYTES)->set(static_cast<double>(assetManager->getResidentBytes()));
 }
 
 void Engine::setupEntityManager() {
@@ -287,13 +667,77 @@ void Engine::setupEntityManager() {
 }
 
 void Engine::setupSimulation(std::unique_ptr<SimulationParameters> parameters) {
+    simulation = createSimulation(std::move(parameters), saveReader.get());
+    saveReader.reset();
+}
+
+std::unique_ptr<SimulationParameters> Engine::createSimulationParameters() {
+    return nullptr;
+}
+
+std::unique_ptr<Simulation> Engine::createSimulation(std::unique_ptr<SimulationParameters> parameters, SaveReader* reader) {
+    if (!parameters) {
+        error = "Simulation parameters not provided";
+        return nullptr;
+    }
+
+    parameters->pathfinderBudget = getData<unsigned int>("pathfinder_budget", PATHFINDER_DEFAULT_BUDGET);
+
+    //Use the same parameters as recorded simulation
+    if (replay) {
+        parameters->seed = replay->seed;
+        parameters->world = replay->world;
+        parameters->pathfinderBudget = replay->pathfinderBudget;
+        parameters->testEntities = replay->testEntities;
+    }
+
+    //Use the parameters of save being loaded
+    if (reader) {
+        Simulation::loadParameters(*reader, *parameters);
+        error = reader->getError();
+        if (hasError()) return nullptr;
+    }
+
+    //Simulation doesn't read program flags itself so each instance is self contained
+    parameters->debug = Utils::isFlag(FLAG_DEBUG);
+    parameters->debugAll = Utils::isFlag(FLAG_DEBUG_ALL);
+
     //Create simulation instance
-    simulation = std::make_unique<Simulation>(this_shared_ptr<Engine>(), std::move(parameters));
-    error = simulation->getError();
-    if (hasError()) return;
+    std::unique_ptr<Simulation> simulationPtr = std::make_unique<Simulation>(this_shared_ptr<Engine>(), std::move(parameters));
+    error = simulationPtr->getError();
+    if (hasError()) return nullptr;
 
     //Load stuff before doing simulation load
-    loadFactions();
+    loadFactions(simulationPtr.get());
+    if (hasError()) return nullptr;
+
+    return simulationPtr;
+}
+
+void Engine::loadSimulationState(Simulation* simulationPtr, SaveReader& reader) {
+    Timer timer;
+    simulationPtr->load(reader);
+    error = simulationPtr->getError();
+    if (hasError()) {
+        error = "Error loading save " + loadPath + "\n" + error;
+        return;
+    }
+    log->info("Loaded save {0} at tick {1} in {2} ms", loadPath, simulationPtr->getTick(), timer.elapsed() * 1000.0f);
+}
+
+void Engine::saveSimulation(const std::string& path) {
+    Timer timer;
+    SaveWriter writer;
+    writer.open(path);
+    if (!writer.hasError()) {
+        simulation->save(writer);
+        writer.close();
+    }
+    if (writer.hasError()) {
+        log->error("Error saving to {0}:\n{1}", path, writer.getError());
+        return;
+    }
+    log->debug("Saved {0} bytes to {1} in {2} ms", writer.getSize(), path, timer.elapsed() * 1000.0f);
 }
 
 void Engine::setupGUI() {
@@ -323,6 +767,18 @@ Simulation* Engine::getSimulation() {
     return simulation.get();
 }
 
+JobSystem* Engine::getJobSystem() {
+    return jobSystem.get();
+}
+
+Scheduler* Engine::getScheduler() {
+    return scheduler.get();
+}
+
+Metrics* Engine::getMetrics() {
+    return metrics.get();
+}
+
 input_key_code_t Engine::getKeyBind(const std::string& name) {
     //TODO there should be a configurable keybinds and falling back to default if not set
 
@@ -411,7 +867,7 @@ void Engine::setLocale(const std::string& code, bool persistent) {
     }
 }
 
-void Engine::loadFactions() {
+void Engine::loadFactions(Simulation* simulationPtr) {
     //Load factions
     Config config(Utils::getDataPath() + "factions.json");
     config.read();
@@ -427,7 +883,7 @@ void Engine::loadFactions() {
         faction->code = data.value("code", "");
         faction->name = getText("faction."+faction->code);
         faction->loadData(data["data"]);
-        simulation->addFaction(std::move(faction));
+        simulationPtr->addFaction(std::move(faction));
     }
 }
 
@@ -4,6 +4,9 @@
 #ifndef OPENE2140_ENGINE_H
 #define OPENE2140_ENGINE_H
 
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include "engine/core/macros.h"
 #include "engine/simulation/simulation_parameters.h"
 #include "engine/core/error_possible.h"
@@ -19,9 +22,17 @@ class EventHandler;
 class Renderer;
 class Simulation;
 class Timer;
+class Scheduler;
+class JobSystem;
+class Metrics;
+class MetricCounter;
+class MetricHistogram;
 class GUIRoot;
 class Locale;
 class Entity;
+class Replay;
+class SaveReader;
+struct SimulationCommand;
 
 /**
  * Contains the central game code that calls and coordinates the subsystems
@@ -68,6 +79,29 @@ protected:
      */
     std::unique_ptr<Timer> drawTimer;
 
+    /**
+     * Schedules the fixed updates and paces the main loop
+     */
+    std::unique_ptr<Scheduler> scheduler;
+
+    /**
+     * Job system for parallel work such as simulation update phases
+     */
+    std::unique_ptr<JobSystem> jobSystem;
+
+    /**
+     * Registry of runtime metrics
+     */
+    std::unique_ptr<Metrics> metrics;
+
+    /**
+     * Cached metrics updated by engine
+     */
+    MetricHistogram* metricTick = nullptr;
+    MetricHistogram* metricFrame = nullptr;
+    MetricCounter* metricDrawCalls = nullptr;
+    MetricCounter* metricVerticesUploaded = nullptr;
+
     /**
      * Average elapsed update time
      */
@@ -76,7 +110,67 @@ protected:
     /**
      * Average elapsed draw time
      */
-    float drawElapsedAvg = 0;
+    std::atomic<float> drawElapsedAvg = 0;
+
+    /**
+     * Renderer flushes done in last frame
+     */
+    std::atomic<size_t> drawFlushes = 0;
+
+    /**
+     * Thread that draws frames when render thread is enabled, owns the OpenGL context while running
+     */
+    std::thread renderThread;
+
+    /**
+     * Flag to keep render thread running
+     */
+    std::atomic<bool> renderThreadRunning = false;
+
+    /**
+     * Guards the GUI and renderer state between main thread and render thread
+     */
+    std::mutex guiMutex;
+
+    /**
+     * Path where replay of simulation commands is written on close, empty if not recording
+     */
+    std::string recordPath;
+
+    /**
+     * Path of replay to play instead of running the main loop, empty if not replaying
+     */
+    std::string replayPath;
+
+    /**
+     * Replay being played
+     */
+    std::unique_ptr<Replay> replay;
+
+    /**
+     * Path of save to load into simulation instead of level content, empty if not loading
+     */
+    std::string loadPath;
+
+    /**
+     * Save being loaded until simulation is setup
+     */
+    std::unique_ptr<SaveReader> saveReader;
+
+    /**
+     * Amount of headless simulations to run concurrently in batch instead of the main loop, 0 if not batching
+     */
+    size_t batchCount = 0;
+
+    /**
+     * Seconds between each autosave, 0 disables autosaving
+     */
+    float autosaveInterval = 0;
+
+    /**
+     * Timer since last autosave
+     */
+    std::unique_ptr<Timer> autosaveTimer;
 
     /**
      * Current active menu if any
@@ -104,7 +198,41 @@ protected:
     virtual void run();
 
     /**
-     * Updates engine data
+     * Runs the main loop until engine is closing
+     */
+    virtual void loop();
+
+    /**
+     * Plays the loaded replay at maximum speed without drawing
+     */
+    virtual void playReplay();
+
+    /**
+     * Creates the batch simulations and steps them concurrently at maximum speed, one simulation per job
+     */
+    virtual void runBatch();
+
+    /**
+     * Updates the simulation until reaching the amount of ticks or engine closing, applying and checking the replay if any
+     * Can be called from any thread as long as each simulation is only updated by one thread
+     *
+     * @param simulationPtr simulation to update
+     * @param ticks to reach
+     * @param mainThread if called from main thread so profiler and metrics are updated too
+     * @return error if replay diverged, empty otherwise
+     */
+    std::string runSimulation(Simulation* simulationPtr, uint64_t ticks, bool mainThread);
+
+    /**
+     * Applies a recorded command to simulation
+     *
+     * @param simulationPtr simulation to apply command
+     * @param command to apply
+     */
+    virtual void applyCommand(Simulation* simulationPtr, const SimulationCommand& command);
+
+    /**
+     * Updates engine data by a single fixed tick
      */
     void update();
 
@@ -113,6 +241,26 @@ protected:
      */
     void draw();
 
+    /**
+     * Render thread loop, draws frames until stopped
+     */
+    virtual void renderLoop();
+
+    /**
+     * Starts the render thread and passes the OpenGL context to it
+     */
+    void startRenderThread();
+
+    /**
+     * Stops the render thread and takes back the OpenGL context
+     */
+    void stopRenderThread();
+
+    /**
+     * Updates window title with stats
+     */
+    void updateTitle();
+
     /**
      * Called from engine to setup EventHandler
      */
@@ -150,6 +298,38 @@ protected:
      */
     virtual void setupSimulation(std::unique_ptr<SimulationParameters> parameters);
 
+    /**
+     * Creates the parameters for a new simulation
+     *
+     * @return parameters or null if engine doesn't provide any
+     */
+    virtual std::unique_ptr<SimulationParameters> createSimulationParameters();
+
+    /**
+     * Creates and loads a new simulation, all state is contained in simulation so many can exist at same time
+     * Must be called from main thread as assets are read during load
+     *
+     * @param parameters for simulation
+     * @param reader save to restore in simulation if not null, parameters are overridden by save ones
+     * @return simulation or null if error occurred
+     */
+    virtual std::unique_ptr<Simulation> createSimulation(std::unique_ptr<SimulationParameters> parameters, SaveReader* reader);
+
+    /**
+     * Loads the save into simulation, should be called once simulation world and players are loaded
+     *
+     * @param simulationPtr simulation to restore
+     * @param reader save to read
+     */
+    void loadSimulationState(Simulation* simulationPtr, SaveReader& reader);
+
+    /**
+     * Saves the current simulation state
+     *
+     * @param path of save file
+     */
+    void saveSimulation(const std::string& path);
+
     /**
      * Called from engine to load engine config
      */
@@ -182,8 +362,10 @@ protected:
 
     /**
      * Loads factions from data
+     *
+     * @param simulationPtr simulation to add factions
      */
-    virtual void loadFactions();
+    virtual void loadFactions(Simulation* simulationPtr);
 
 public:
     /**
@@ -255,6 +437,21 @@ public:
      */
     Simulation* getSimulation();
 
+    /**
+     * @return JobSystem
+     */
+    JobSystem* getJobSystem();
+
+    /**
+     * @return Scheduler
+     */
+    Scheduler* getScheduler();
+
+    /**
+     * @return Metrics
+     */
+    Metrics* getMetrics();
+
     /**
      * @return key code for provided bind
      */
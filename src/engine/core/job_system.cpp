@@ -0,0 +1,252 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "engine/core/profiler.h"
+#include "job_system.h"
+
+/**
+ * Job system which current thread is worker of, if any
+ */
+static thread_local const JobSystem* currentJobSystem = nullptr;
+
+/**
+ * Queue index of current thread in current job system
+ */
+static thread_local size_t currentJobQueue = 0;
+
+bool JobCounter::isDone() const {
+    return pending == 0;
+}
+
+JobSystem::JobSystem(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    //First queue is shared by non worker threads which also run jobs while waiting
+    for (size_t i = 0; i < threads; ++i) {
+        queues.emplace_back(std::make_unique<JobQueue>());
+    }
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    sleepCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+size_t JobSystem::getThreadsCount() const {
+    return queues.size();
+}
+
+void JobSystem::workerLoop(size_t index) {
+    currentJobSystem = this;
+    currentJobQueue = index;
+    Profiler::setThreadName("Job " + std::to_string(index));
+    Job job;
+    while (true) {
+        if (take(index, job)) {
+            execute(job);
+            continue;
+        }
+
+        //Nothing to do, stop if requested or sleep until jobs are queued
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping && queuedJobs == 0) {
+            break;
+        }
+        sleepCondition.wait(lock, [this] { return stopping || 0 < queuedJobs; });
+    }
+    currentJobSystem = nullptr;
+}
+
+size_t JobSystem::getCurrentQueue() const {
+    return currentJobSystem == this ? currentJobQueue : 0;
+}
+
+void JobSystem::push(Job&& job) {
+    JobQueue& queue = *queues[getCurrentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.emplace_back(std::move(job));
+    }
+    queuedJobs++;
+
+    //Lock so a worker about to sleep doesn't miss the notification
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    sleepCondition.notify_one();
+}
+
+bool JobSystem::take(size_t index, Job& job) {
+    if (queuedJobs == 0) {
+        return false;
+    }
+
+    //Take newest job from own queue
+    {
+        JobQueue& queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            queuedJobs--;
+            return true;
+        }
+    }
+
+    //Steal oldest job from other queues
+    for (size_t i = 1; i < queues.size(); ++i) {
+        JobQueue& queue = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            queuedJobs--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::execute(Job& job) {
+    job.function();
+    job.function = nullptr;
+
+    //Decrement counter and schedule continuations if this was the last job
+    JobCounter* counter = job.counter;
+    if (counter) {
+        std::vector<Job> continuations;
+        {
+            std::lock_guard<std::mutex> lock(counter->mutex);
+            if (counter->pending == 1) {
+                continuations.swap(counter->continuations);
+            }
+            counter->pending--;
+        }
+        for (Job& continuation : continuations) {
+            push(std::move(continuation));
+        }
+    }
+}
+
+void JobSystem::run(job_function_t function, JobCounter* counter) {
+    if (counter) {
+        counter->pending++;
+    }
+    push({std::move(function), counter});
+}
+
+void JobSystem::runAfter(JobCounter& dependency, job_function_t function, JobCounter* counter) {
+    if (counter) {
+        counter->pending++;
+    }
+    Job job = {std::move(function), counter};
+    {
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (0 < dependency.pending) {
+            dependency.continuations.emplace_back(std::move(job));
+            return;
+        }
+    }
+    push(std::move(job));
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    //Help running jobs while waiting
+    size_t index = getCurrentQueue();
+    Job job;
+    while (0 < counter.pending) {
+        if (take(index, job)) {
+            execute(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    //Ensure the last job released the counter before caller can destroy it
+    std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+void JobSystem::parallelFor(size_t count, size_t chunk, const job_range_function_t& function) {
+    if (count == 0) {
+        return;
+    }
+    chunk = std::max(static_cast<size_t>(1), chunk);
+
+    //Not worth to queue jobs
+    if (workers.empty() || count <= chunk) {
+        function(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    for (size_t start = 0; start < count; start += chunk) {
+        size_t end = std::min(count, start + chunk);
+        run([&function, start, end] { function(start, end); }, &counter);
+    }
+    wait(counter);
+}
+
+void JobSystem::benchmark(const log_ptr& log) {
+    const size_t count = 1 << 20;
+    const size_t chunk = 1024;
+    const int iterations = 10;
+    std::vector<float> data(count);
+    size_t maxThreads = std::max(1U, std::thread::hardware_concurrency());
+    log->info("Job system benchmark: {0} items, {1} chunk, {2} iterations", count, chunk, iterations);
+
+    //Measure parallel for with different thread counts
+    double baseline = 0;
+    for (size_t threads = 1; threads <= maxThreads; threads = threads < maxThreads ? std::min(threads * 2, maxThreads) : threads + 1) {
+        JobSystem jobSystem(threads);
+        auto work = [&data](size_t start, size_t end) {
+            for (size_t i = start; i < end; ++i) {
+                float value = static_cast<float>(i);
+                for (int j = 0; j < 32; ++j) {
+                    value = std::sqrt(value + static_cast<float>(j));
+                }
+                data[i] = value;
+            }
+        };
+
+        //Warm up and measure
+        jobSystem.parallelFor(count, chunk, work);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            jobSystem.parallelFor(count, chunk, work);
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+        if (threads == 1) {
+            baseline = elapsed;
+        }
+        log->info("parallelFor threads {0}: {1:.3f} ms speedup {2:.2f}x", threads, elapsed, baseline / elapsed);
+
+        //Measure dependency chains of small jobs
+        JobCounter first;
+        JobCounter second;
+        std::atomic<size_t> done = 0;
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < 4096; ++i) {
+            jobSystem.run([&done] { done++; }, &first);
+        }
+        for (size_t i = 0; i < 4096; ++i) {
+            jobSystem.runAfter(first, [&done] { done++; }, &second);
+        }
+        jobSystem.wait(second);
+        elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        log->info("dependent jobs threads {0}: {1} jobs in {2:.3f} ms", threads, done.load(), elapsed);
+    }
+}
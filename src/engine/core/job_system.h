@@ -0,0 +1,231 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_JOB_SYSTEM_H
+#define OPENE2140_JOB_SYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include "engine/core/macros.h"
+#include "engine/io/log.h"
+
+class JobCounter;
+
+/**
+ * Function to run in a job
+ */
+using job_function_t = std::function<void()>;
+
+/**
+ * Function to run in a parallel for job with [start, end) range
+ */
+using job_range_function_t = std::function<void(size_t, size_t)>;
+
+/**
+ * Job queued in a worker
+ */
+struct Job {
+    /**
+     * Function to run
+     */
+    job_function_t function;
+
+    /**
+     * Counter to decrement once job is done if any
+     */
+    JobCounter* counter = nullptr;
+};
+
+/**
+ * Counts the pending jobs of a group so they can be waited or used as dependency for other jobs
+ */
+class JobCounter {
+    friend class JobSystem;
+private:
+    /**
+     * Amount of jobs not done yet
+     */
+    std::atomic<size_t> pending = 0;
+
+    /**
+     * Guards the continuations
+     */
+    std::mutex mutex;
+
+    /**
+     * Jobs to schedule once pending reaches zero
+     */
+    std::vector<Job> continuations;
+
+public:
+    /**
+     * Constructor
+     */
+    JobCounter() = default;
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(JobCounter)
+
+    /**
+     * @return true if there is no pending jobs
+     */
+    bool isDone() const;
+};
+
+/**
+ * Work stealing job system
+ *
+ * Each worker has its own deque where jobs created from that worker are pushed,
+ * workers run own jobs in LIFO order and steal from other workers in FIFO order when empty.
+ * Threads that are not workers such as main thread share the first deque and
+ * can help running jobs while waiting for a counter
+ */
+class JobSystem {
+private:
+    /**
+     * Deque of jobs for each worker
+     */
+    struct JobQueue {
+        /** Guards the jobs */
+        std::mutex mutex;
+        /** Queued jobs */
+        std::deque<Job> jobs;
+    };
+
+    /**
+     * Job queues, first one is for non worker threads
+     */
+    std::vector<std::unique_ptr<JobQueue>> queues;
+
+    /**
+     * Worker threads
+     */
+    std::vector<std::thread> workers;
+
+    /**
+     * Amount of jobs queued in all queues
+     */
+    std::atomic<size_t> queuedJobs = 0;
+
+    /**
+     * Guards the sleeping of workers
+     */
+    std::mutex sleepMutex;
+
+    /**
+     * Wakes sleeping workers when jobs are queued or system is stopping
+     */
+    std::condition_variable sleepCondition;
+
+    /**
+     * Flag for stopping the workers
+     */
+    std::atomic<bool> stopping = false;
+
+    /**
+     * Worker thread loop
+     *
+     * @param index of worker queue
+     */
+    void workerLoop(size_t index);
+
+    /**
+     * @return queue index of current thread for this job system
+     */
+    size_t getCurrentQueue() const;
+
+    /**
+     * Pushes the job into current thread queue and wakes a worker
+     *
+     * @param job to push
+     */
+    void push(Job&& job);
+
+    /**
+     * Takes a job from own queue or steals one from other queues
+     *
+     * @param index of own queue
+     * @param job to store the taken job
+     * @return true if a job was taken
+     */
+    bool take(size_t index, Job& job);
+
+    /**
+     * Runs the job and handles the counter
+     *
+     * @param job to run
+     */
+    void execute(Job& job);
+
+public:
+    /**
+     * Constructor
+     *
+     * @param threads amount of threads including caller, 0 to use hardware concurrency
+     */
+    explicit JobSystem(size_t threads);
+
+    /**
+     * Destructor, runs the remaining jobs and stops the workers
+     */
+    ~JobSystem();
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(JobSystem)
+
+    /**
+     * @return amount of threads that run jobs including caller
+     */
+    size_t getThreadsCount() const;
+
+    /**
+     * Queues a job
+     *
+     * @param function to run
+     * @param counter to increment until job is done, optional
+     */
+    void run(job_function_t function, JobCounter* counter = nullptr);
+
+    /**
+     * Queues a job that will run once the dependency counter has no pending jobs
+     *
+     * @param dependency counter to wait
+     * @param function to run
+     * @param counter to increment until job is done, optional
+     */
+    void runAfter(JobCounter& dependency, job_function_t function, JobCounter* counter = nullptr);
+
+    /**
+     * Waits until counter has no pending jobs, runs queued jobs meanwhile instead of blocking
+     *
+     * @param counter to wait
+     */
+    void wait(JobCounter& counter);
+
+    /**
+     * Runs the function over [0, count) split in chunks in parallel and waits until all are done
+     *
+     * @param count amount of indexes
+     * @param chunk amount of indexes per function call
+     * @param function to call with each [start, end) range
+     */
+    void parallelFor(size_t count, size_t chunk, const job_range_function_t& function);
+
+    /**
+     * Measures the scaling of job system with different amount of threads and logs the results
+     *
+     * @param log to write results
+     */
+    static void benchmark(const log_ptr& log);
+};
+
+#endif //OPENE2140_JOB_SYSTEM_H
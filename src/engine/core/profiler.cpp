@@ -0,0 +1,144 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <chrono>
+#include "engine/core/utils.h"
+#include "engine/io/file.h"
+#include "profiler.h"
+
+std::atomic<bool> Profiler::enabled = false;
+int64_t Profiler::startTime = 0;
+int64_t Profiler::endTime = 0;
+std::mutex Profiler::buffersMutex;
+std::vector<std::unique_ptr<ProfilerBuffer>> Profiler::buffers;
+
+/**
+ * Buffer of current thread
+ */
+static thread_local ProfilerBuffer* threadBuffer = nullptr;
+
+int64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+ProfilerBuffer* Profiler::getThreadBuffer() {
+    if (!threadBuffer) {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        std::unique_ptr<ProfilerBuffer> buffer = std::make_unique<ProfilerBuffer>();
+        buffer->threadId = static_cast<unsigned int>(buffers.size()) + 1;
+        buffer->threadName = "Thread " + std::to_string(buffer->threadId);
+        buffer->events = std::make_unique<ProfilerEvent[]>(PROFILER_BUFFER_EVENTS);
+        threadBuffer = buffer.get();
+        buffers.push_back(std::move(buffer));
+    }
+    return threadBuffer;
+}
+
+void Profiler::start(float seconds) {
+    startTime = now();
+    endTime = startTime + static_cast<int64_t>(seconds * 1e9);
+    enabled.store(true);
+}
+
+void Profiler::update() {
+    if (isEnabled() && endTime <= now()) {
+        stop();
+    }
+}
+
+void Profiler::stop() {
+    if (!enabled.exchange(false)) {
+        return;
+    }
+    dump(Utils::getUserPath() + PROFILER_TRACE_FILE, Log::get(MAIN_LOG));
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    //Avoid allocating buffers for threads when not capturing
+    if (!isEnabled()) {
+        return;
+    }
+    ProfilerBuffer* buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    buffer->threadName = name;
+}
+
+void Profiler::record(const char* name, int64_t start, int64_t end) {
+    //Only the owner thread writes the buffer, lock is only contended when dump swaps it
+    ProfilerBuffer* buffer = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    ProfilerEvent& event = buffer->events[buffer->head % PROFILER_BUFFER_EVENTS];
+    event.name = name;
+    event.start = start - startTime;
+    event.duration = end - start;
+    buffer->head++;
+}
+
+void Profiler::dump(const std::string& path, const log_ptr& log) {
+    //Take the buffers of each thread so workers still running write into fresh ones meanwhile
+    std::vector<std::unique_ptr<ProfilerBuffer>> taken;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        for (std::unique_ptr<ProfilerBuffer>& buffer : buffers) {
+            std::unique_ptr<ProfilerBuffer> copy = std::make_unique<ProfilerBuffer>();
+            copy->threadId = buffer->threadId;
+            copy->threadName = buffer->threadName;
+            copy->events = std::make_unique<ProfilerEvent[]>(PROFILER_BUFFER_EVENTS);
+            {
+                std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+                std::swap(copy->events, buffer->events);
+                std::swap(copy->head, buffer->head);
+            }
+            taken.push_back(std::move(copy));
+        }
+    }
+
+    config_data_t traceEvents = config_data_t::array();
+    size_t eventsCount = 0;
+    for (std::unique_ptr<ProfilerBuffer>& buffer : taken) {
+        //Name the thread
+        traceEvents.push_back({
+            {"name", "thread_name"},
+            {"ph", "M"},
+            {"pid", 1},
+            {"tid", buffer->threadId},
+            {"args", {{"name", buffer->threadName}}},
+        });
+
+        //Add the events still present in ring, zones started before capture are skipped
+        size_t head = buffer->head;
+        size_t first = PROFILER_BUFFER_EVENTS < head ? head - PROFILER_BUFFER_EVENTS : 0;
+        for (size_t i = first; i < head; ++i) {
+            const ProfilerEvent& event = buffer->events[i % PROFILER_BUFFER_EVENTS];
+            if (event.start < 0) continue;
+            traceEvents.push_back({
+                {"name", event.name},
+                {"ph", "X"},
+                {"pid", 1},
+                {"tid", buffer->threadId},
+                {"ts", static_cast<double>(event.start) / 1000.0},
+                {"dur", static_cast<double>(event.duration) / 1000.0},
+            });
+            eventsCount++;
+        }
+    }
+
+    //Write the trace
+    config_data_t trace = {{"traceEvents", std::move(traceEvents)}};
+    std::string content = trace.dump();
+    File file;
+    file.fromPath(path, File::FileMode::Write);
+    std::string error = file.getError();
+    if (error.empty()) {
+        file.write(content.c_str(), content.size());
+        error = file.getError();
+    }
+    file.close();
+    if (!error.empty()) {
+        log->error("Error writing profiler trace to {0}:\n{1}", path, error);
+    } else {
+        log->info("Profiler trace with {0} zones written to {1}", eventsCount, path);
+    }
+}
@@ -0,0 +1,210 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_PROFILER_H
+#define OPENE2140_PROFILER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "engine/core/common.h"
+#include "engine/core/macros.h"
+#include "engine/io/log.h"
+
+/** Amount of events each thread buffer can hold before overwriting the oldest ones */
+#define PROFILER_BUFFER_EVENTS 65536
+/** Seconds to capture when no amount is specified */
+#define PROFILER_DEFAULT_SECONDS 10
+/** Name of file in user path where the trace is written */
+#define PROFILER_TRACE_FILE "profile.json"
+
+/** Creates a zone that is recorded from this line until end of current scope */
+#if GAME_PROFILER
+#define PROFILE_ZONE_CONCAT_INNER(A, B) A##B
+#define PROFILE_ZONE_CONCAT(A, B) PROFILE_ZONE_CONCAT_INNER(A, B)
+#define PROFILE_ZONE(NAME) ProfilerZone PROFILE_ZONE_CONCAT(profilerZone, __LINE__)(NAME)
+#else
+#define PROFILE_ZONE(NAME)
+#endif
+
+/**
+ * Recorded zone
+ */
+struct ProfilerEvent {
+    /**
+     * Name of zone, must be a string literal
+     */
+    const char* name;
+
+    /**
+     * Start time in ns since capture start
+     */
+    int64_t start;
+
+    /**
+     * Duration in ns
+     */
+    int64_t duration;
+};
+
+/**
+ * Ring buffer of events written only by the owning thread, dump takes it by swapping under the lock
+ */
+struct ProfilerBuffer {
+    /**
+     * Thread id used in trace
+     */
+    unsigned int threadId;
+
+    /**
+     * Thread name used in trace
+     */
+    std::string threadName;
+
+    /**
+     * Guards head and events, only contended while dump swaps them
+     */
+    std::mutex mutex;
+
+    /**
+     * Total amount of events written, the position to write is this modulo buffer size
+     */
+    size_t head = 0;
+
+    /**
+     * Event storage
+     */
+    std::unique_ptr<ProfilerEvent[]> events;
+};
+
+/**
+ * Captures zones from all threads and exports them as Chrome trace events JSON
+ */
+class Profiler {
+private:
+    /**
+     * If zones are being recorded
+     */
+    static std::atomic<bool> enabled;
+
+    /**
+     * Capture start time in ns
+     */
+    static int64_t startTime;
+
+    /**
+     * Capture end time in ns
+     */
+    static int64_t endTime;
+
+    /**
+     * Guards the buffers list, only used when a thread records for first time
+     */
+    static std::mutex buffersMutex;
+
+    /**
+     * Buffers of each thread, kept until exit so threads can finish anytime
+     */
+    static std::vector<std::unique_ptr<ProfilerBuffer>> buffers;
+
+    /**
+     * @return the buffer for current thread, creating it if necessary
+     */
+    static ProfilerBuffer* getThreadBuffer();
+
+public:
+    /**
+     * @return current time in ns
+     */
+    static int64_t now();
+
+    /**
+     * @return if zones are being recorded
+     */
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Starts capturing zones
+     *
+     * @param seconds to capture
+     */
+    static void start(float seconds);
+
+    /**
+     * Checks if capture time finished and dumps the trace in that case
+     */
+    static void update();
+
+    /**
+     * Stops capturing and writes the trace to user path if was capturing
+     */
+    static void stop();
+
+    /**
+     * Sets the name that current thread will have in trace, only has effect while capturing
+     *
+     * @param name of thread
+     */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * Stores a zone in current thread buffer
+     *
+     * @param name of zone
+     * @param start time in ns
+     * @param end time in ns
+     */
+    static void record(const char* name, int64_t start, int64_t end);
+
+    /**
+     * Writes the recorded events as Chrome trace, buffers are swapped with empty ones so threads can keep recording
+     * while trace is written
+     *
+     * @param path of file
+     * @param log to report result
+     */
+    static void dump(const std::string& path, const log_ptr& log);
+};
+
+/**
+ * Records the time between construction and destruction when profiler is enabled
+ */
+class ProfilerZone {
+private:
+    /**
+     * Name of zone
+     */
+    const char* name;
+
+    /**
+     * Start time or -1 if profiler was disabled
+     */
+    int64_t start;
+
+public:
+    /**
+     * Constructor
+     */
+    explicit ProfilerZone(const char* name): name(name), start(Profiler::isEnabled() ? Profiler::now() : -1) {
+    }
+
+    /**
+     * Destructor
+     */
+    ~ProfilerZone() {
+        if (0 <= start) {
+            Profiler::record(name, start, Profiler::now());
+        }
+    }
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(ProfilerZone)
+};
+
+#endif //OPENE2140_PROFILER_H
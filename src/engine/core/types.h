@@ -52,6 +52,12 @@ using entity_health_t = uint16_t;
 /** Entity energy */
 using entity_energy_t = int32_t;
 
+/** Type for animation flags */
+using animation_flags_t = uint8_t;
+
+/** Type for entity changes flags */
+using entity_changes_t = uint16_t;
+
 /** Player ID */
 using player_id_t = uint16_t;
 
@@ -67,6 +73,9 @@ using tile_flags_t = uint16_t;
 /** Type for cost of path */
 using path_cost_t = uint32_t;
 
+/** Type for connected region label of tiles, 0 is used for tiles that can't be traversed */
+using reachability_label_t = uint32_t;
+
 /** Type for time intervals in ms, can be positive or negative */
 using duration_t = int64_t;
 
@@ -5,6 +5,7 @@
 #include "engine/assets/asset_manager.h"
 #include "entity_manager.h"
 #include "entity_factory.h"
+#include "entity_pool.h"
 #include "engine/io/config.h"
 #include "engine/core/utils.h"
 
@@ -94,6 +95,14 @@ EntityConfig* IEntityFactory::getConfigCode(const std::string& code) {
     }
 }
 
+std::shared_ptr<Entity> IEntityFactory::instanceEntity(EntityConfig* config) {
+    IEntityPool* pool = getEntityPool(config);
+    if (!pool) {
+        return std::shared_ptr<Entity>();
+    }
+    return pool->make();
+}
+
 log_ptr IEntityFactory::getLog() const {
     return log;
 }
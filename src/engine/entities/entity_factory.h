@@ -10,6 +10,7 @@
 
 class EntityManager;
 class Entity;
+class IEntityPool;
 
 /**
  * Processor for asset manager loading process
@@ -131,12 +132,20 @@ public:
     EntityConfig* getConfigCode(const std::string& code);
 
     /**
-     * Instantiation of entity by the factory implementation
+     * Obtains the pool of concrete entity class that the factory implementation uses for config
+     *
+     * @param config of entity to instantiate
+     * @return pool or null if config can't be instantiated
+     */
+    virtual IEntityPool* getEntityPool(EntityConfig* config) = 0;
+
+    /**
+     * Instantiation of entity using the pool for config
      *
      * @param config of entity to instantiate
      * @return entity
      */
-    virtual std::shared_ptr<Entity> instanceEntity(EntityConfig* config) = 0;
+    virtual std::shared_ptr<Entity> instanceEntity(EntityConfig* config);
 
     /**
      * Obtains log for this factory
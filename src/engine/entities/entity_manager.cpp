@@ -100,6 +100,17 @@ std::shared_ptr<Entity> EntityManager::makeEntity(entity_kind_t kind, const std:
     return entity;
 }
 
+IEntityPool* EntityManager::getEntityPool(const entity_type_t& type) {
+    std::unique_ptr<IEntityFactory>& factory = factories[type.kind];
+    if (factory) {
+        EntityConfig* config = factory->getConfig(type.id);
+        if (config) {
+            return factory->getEntityPool(config);
+        }
+    }
+    return nullptr;
+}
+
 AssetManager* EntityManager::getAssetManager() {
     return engine->getAssetManager();
 }
\ No newline at end of file
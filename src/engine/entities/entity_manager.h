@@ -14,6 +14,7 @@ class IEntityFactory;
 class Engine;
 class Entity;
 class EntityConfig;
+class IEntityPool;
 
 /**
  * Handles the entity config loading, storage and entity instantiation using config
@@ -93,6 +94,14 @@ public:
      */
     std::shared_ptr<Entity> makeEntity(entity_kind_t kind, const std::string& code);
 
+    /**
+     * Obtains the pool where entities of provided type are allocated, several types might share the same pool
+     *
+     * @param type of entity
+     * @return pool or null if type can't be instanced
+     */
+    IEntityPool* getEntityPool(const entity_type_t& type);
+
     /**
      * Obtain the asset manager
      *
@@ -0,0 +1,84 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <new>
+#include <algorithm>
+#include <map>
+#include "entity_pool.h"
+
+EntityPoolStorage::EntityPoolStorage(size_t size):
+        //Slot must hold at least the freelist pointer and keep every slot aligned
+        slotSize(((std::max(size, sizeof(void*)) + ENTITY_POOL_ALIGNMENT - 1) / ENTITY_POOL_ALIGNMENT) * ENTITY_POOL_ALIGNMENT) {
+}
+
+EntityPoolStorage::~EntityPoolStorage() {
+    for (void* chunk : chunks) {
+        ::operator delete(chunk, std::align_val_t(ENTITY_POOL_ALIGNMENT));
+    }
+    chunks.clear();
+    freeSlot = nullptr;
+}
+
+void EntityPoolStorage::allocateChunk() {
+    auto* chunk = static_cast<unsigned char*>(::operator new(slotSize * ENTITY_POOL_CHUNK_SLOTS, std::align_val_t(ENTITY_POOL_ALIGNMENT)));
+    chunks.push_back(chunk);
+
+    //Link slots in reverse so they are handed out in address order
+    for (size_t i = ENTITY_POOL_CHUNK_SLOTS; i > 0; --i) {
+        void* slot = chunk + (i - 1) * slotSize;
+        *static_cast<void**>(slot) = freeSlot;
+        freeSlot = slot;
+    }
+}
+
+void* EntityPoolStorage::allocate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!freeSlot) {
+        allocateChunk();
+    }
+    void* slot = freeSlot;
+    freeSlot = *static_cast<void**>(slot);
+    used++;
+    return slot;
+}
+
+void EntityPoolStorage::deallocate(void* slot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    *static_cast<void**>(slot) = freeSlot;
+    freeSlot = slot;
+    used--;
+}
+
+void EntityPoolStorage::reserve(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (chunks.size() * ENTITY_POOL_CHUNK_SLOTS < count) {
+        allocateChunk();
+    }
+}
+
+size_t EntityPoolStorage::getSlotSize() const {
+    return slotSize;
+}
+
+size_t EntityPoolStorage::getUsed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+size_t EntityPoolStorage::getCapacity() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return chunks.size() * ENTITY_POOL_CHUNK_SLOTS;
+}
+
+void IEntityPool::prewarm(const std::vector<std::pair<IEntityPool*, size_t>>& counts) {
+    //Nothing is allocated until entities are instanced, so reserving each type separately would only keep the biggest
+    std::map<IEntityPool*, size_t> poolCounts;
+    for (const std::pair<IEntityPool*, size_t>& pair : counts) {
+        if (pair.first) {
+            poolCounts[pair.first] += pair.second;
+        }
+    }
+    for (std::pair<IEntityPool* const, size_t>& pair : poolCounts) {
+        pair.first->reserve(pair.first->getUsed() + pair.second);
+    }
+}
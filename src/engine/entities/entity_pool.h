@@ -0,0 +1,259 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_ENTITY_POOL_H
+#define OPENE2140_ENTITY_POOL_H
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <cstddef>
+#include "engine/core/macros.h"
+
+class Entity;
+
+/** Amount of slots allocated together in each pool chunk */
+#define ENTITY_POOL_CHUNK_SLOTS 64
+/** Alignment of every slot in pool */
+#define ENTITY_POOL_ALIGNMENT alignof(std::max_align_t)
+/** Extra bytes reserved in each slot for the shared pointer control block that is stored along the entity */
+#define ENTITY_POOL_CONTROL_BLOCK_SIZE 64
+
+/**
+ * Type erased storage of fixed size slots, allocated in chunks so slot addresses are stable
+ * and freed slots are reused through a freelist
+ */
+class EntityPoolStorage {
+private:
+    /**
+     * Size in bytes of each slot
+     */
+    const size_t slotSize;
+
+    /**
+     * Guards the chunks and freelist since entities might be released from any thread
+     */
+    std::mutex mutex;
+
+    /**
+     * Allocated chunks, each containing ENTITY_POOL_CHUNK_SLOTS slots
+     */
+    std::vector<void*> chunks;
+
+    /**
+     * First free slot, each free slot stores the pointer to next free slot
+     */
+    void* freeSlot = nullptr;
+
+    /**
+     * Amount of slots in use
+     */
+    size_t used = 0;
+
+    /**
+     * Allocates a new chunk and adds the slots to freelist, must be called with mutex held
+     */
+    void allocateChunk();
+
+public:
+    /**
+     * Constructor
+     *
+     * @param size of each slot
+     */
+    explicit EntityPoolStorage(size_t size);
+
+    /**
+     * Destructor
+     */
+    ~EntityPoolStorage();
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(EntityPoolStorage)
+
+    /**
+     * @return a free slot, allocating a new chunk if required
+     */
+    void* allocate();
+
+    /**
+     * Returns the slot into freelist
+     *
+     * @param slot to free
+     */
+    void deallocate(void* slot);
+
+    /**
+     * Allocates chunks until there is enough capacity for count slots
+     *
+     * @param count of slots to have
+     */
+    void reserve(size_t count);
+
+    /**
+     * @return size in bytes of each slot
+     */
+    size_t getSlotSize() const;
+
+    /**
+     * @return amount of slots in use
+     */
+    size_t getUsed();
+
+    /**
+     * @return amount of slots allocated
+     */
+    size_t getCapacity();
+};
+
+/**
+ * Allocator that takes single objects from pool storage, used by std::allocate_shared so the entity and
+ * the control block share one pooled slot, anything that doesn't fit is allocated from heap
+ *
+ * @tparam T type to allocate
+ */
+template<typename T>
+class EntityPoolAllocator {
+    template<typename U> friend class EntityPoolAllocator;
+private:
+    /**
+     * Storage to allocate from, kept alive while any allocated object exists
+     */
+    std::shared_ptr<EntityPoolStorage> storage;
+
+    /**
+     * @return if n objects can be allocated in a pool slot
+     */
+    bool isPooled(size_t n) const {
+        return n == 1 && sizeof(T) <= storage->getSlotSize() && alignof(T) <= ENTITY_POOL_ALIGNMENT;
+    }
+
+public:
+    using value_type = T;
+
+    /**
+     * Constructor
+     */
+    explicit EntityPoolAllocator(std::shared_ptr<EntityPoolStorage> storage): storage(std::move(storage)) {
+    }
+
+    /**
+     * Rebind constructor
+     */
+    template<typename U>
+    EntityPoolAllocator(const EntityPoolAllocator<U>& other): storage(other.storage) { // NOLINT(google-explicit-constructor)
+    }
+
+    T* allocate(size_t n) {
+        if (isPooled(n)) {
+            return static_cast<T*>(storage->allocate());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, size_t n) {
+        if (isPooled(n)) {
+            storage->deallocate(pointer);
+        } else {
+            ::operator delete(pointer);
+        }
+    }
+
+    template<typename U>
+    bool operator==(const EntityPoolAllocator<U>& other) const {
+        return storage == other.storage;
+    }
+
+    template<typename U>
+    bool operator!=(const EntityPoolAllocator<U>& other) const {
+        return storage != other.storage;
+    }
+};
+
+/**
+ * Pool of entities for a concrete entity class
+ */
+class IEntityPool {
+public:
+    /**
+     * Destructor
+     */
+    virtual ~IEntityPool() = default;
+
+    /**
+     * @return new entity instance allocated from pool
+     */
+    virtual std::shared_ptr<Entity> make() = 0;
+
+    /**
+     * Ensures pool has capacity for count entities without allocating more memory
+     *
+     * @param count of entities
+     */
+    virtual void reserve(size_t count) = 0;
+
+    /**
+     * @return amount of entities alive from this pool
+     */
+    virtual size_t getUsed() = 0;
+
+    /**
+     * @return amount of entities that this pool can hold without allocating
+     */
+    virtual size_t getCapacity() = 0;
+
+    /**
+     * Reserves each pool for the entities that are going to be instanced from it,
+     * counts of types sharing the same pool are added together before reserving
+     *
+     * @param counts of entities to instance from each pool, pools can appear several times
+     */
+    static void prewarm(const std::vector<std::pair<IEntityPool*, size_t>>& counts);
+};
+
+/**
+ * Pool of entities for concrete entity class T
+ *
+ * @tparam T entity class
+ */
+template<typename T>
+class EntityPool: public IEntityPool {
+private:
+    /**
+     * Storage with slots to contain entity and the control block
+     */
+    std::shared_ptr<EntityPoolStorage> storage;
+
+public:
+    /**
+     * Constructor
+     */
+    EntityPool(): storage(std::make_shared<EntityPoolStorage>(sizeof(T) + ENTITY_POOL_CONTROL_BLOCK_SIZE)) {
+    }
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(EntityPool)
+
+    std::shared_ptr<Entity> make() override {
+        return std::allocate_shared<T>(EntityPoolAllocator<T>(storage));
+    }
+
+    void reserve(size_t count) override {
+        storage->reserve(count);
+    }
+
+    size_t getUsed() override {
+        return storage->getUsed();
+    }
+
+    size_t getCapacity() override {
+        return storage->getCapacity();
+    }
+};
+
+#endif //OPENE2140_ENTITY_POOL_H
@@ -1,9 +1,20 @@
 //
 // Created by Ion Agorria on 29/04/18
 //
+#include <SDL_video.h>
 #include "engine/core/utils.h"
 #include "palette.h"
 
+/**
+ * Textures of destroyed palettes waiting to be deleted in thread with OpenGL context
+ */
+static std::vector<GLuint> releasedTextures;
+
+/**
+ * Guards the released textures
+ */
+static std::mutex releasedTexturesMutex;
+
 Palette::Palette(unsigned int size, bool extra): extra(extra) {
     dirty = false;
 
@@ -17,42 +28,58 @@ Palette::Palette(unsigned int size, bool extra): extra(extra) {
         colors.push_back(color);
     }
 
-    if (!Utils::isFlag(FLAG_HEADLESS)) {
-        //Create texture
-        glActiveTexture(extra ? TEXTURE_UNIT_PALETTE_EXTRA : TEXTURE_UNIT_PALETTE_COLORS);
-        glGenTextures(1, &texture);
-        error = Utils::checkGLError();
-        if (!error.empty()) {
-            return;
-        }
-        bindTexture();
-
-        //Repeat texture when texcoord overflows
-        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        error = Utils::checkGLError();
-        if (!error.empty()) {
-            return;
-        }
-
-        //Pixel scaling
-        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        error = Utils::checkGLError();
-        if (!error.empty()) {
-            return;
-        }
+    //Create texture now if we can, otherwise will be created when updating texture
+    if (!Utils::isFlag(FLAG_HEADLESS) && SDL_GL_GetCurrentContext()) {
+        createTexture();
     }
 }
 
 Palette::~Palette() {
     if (texture) {
-        glDeleteTextures(1, &texture);
+        if (SDL_GL_GetCurrentContext()) {
+            glDeleteTextures(1, &texture);
+        } else {
+            //Renderer will delete it later
+            std::lock_guard<std::mutex> lock(releasedTexturesMutex);
+            releasedTextures.push_back(texture);
+        }
         //Remove ref
         texture = 0;
     }
 }
 
+bool Palette::createTexture() {
+    glActiveTexture(extra ? TEXTURE_UNIT_PALETTE_EXTRA : TEXTURE_UNIT_PALETTE_COLORS);
+    glGenTextures(1, &texture);
+    error = Utils::checkGLError();
+    if (!error.empty()) {
+        return false;
+    }
+    bindTexture();
+
+    //Repeat texture when texcoord overflows
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    error = Utils::checkGLError();
+    if (!error.empty()) {
+        return false;
+    }
+
+    //Pixel scaling
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    error = Utils::checkGLError();
+    return error.empty();
+}
+
+void Palette::deleteReleasedTextures() {
+    std::lock_guard<std::mutex> lock(releasedTexturesMutex);
+    if (!releasedTextures.empty()) {
+        glDeleteTextures(static_cast<GLsizei>(releasedTextures.size()), releasedTextures.data());
+        releasedTextures.clear();
+    }
+}
+
 unsigned long Palette::length() const {
     return colors.size();
 }
@@ -79,6 +106,7 @@ bool Palette::setColors(const Palette* palette) {
 }
 
 bool Palette::getColor(unsigned int index, ColorRGBA& color) const {
+    std::lock_guard<std::mutex> lock(mutex);
     //Check index
     if (index >= length()) {
         return false;
@@ -88,6 +116,7 @@ bool Palette::getColor(unsigned int index, ColorRGBA& color) const {
 }
 
 bool Palette::setColor(unsigned int index, const ColorRGBA& color) {
+    std::lock_guard<std::mutex> lock(mutex);
     //Check index
     if (index >= length()) {
         error = "Index out of bounds: " + std::to_string(index) + " color " + color.toString();
@@ -99,6 +128,7 @@ bool Palette::setColor(unsigned int index, const ColorRGBA& color) {
 }
 
 bool Palette::setColor(unsigned int index, const ColorRGB& color) {
+    std::lock_guard<std::mutex> lock(mutex);
     //Check index
     if (index >= length()) {
         error = "Index out of bounds: " + std::to_string(index) + " color " + color.toString();
@@ -137,7 +167,13 @@ GLuint Palette::getTexture() const {
 }
 
 bool Palette::updateTexture() {
-    if (dirty) {
+    if (!texture && !Utils::isFlag(FLAG_HEADLESS)) {
+        if (!createTexture()) {
+            return false;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (dirty && texture) {
         dirty = false;
         bindTexture();
         glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA, colors.size(), 0, GL_RGBA, GL_UNSIGNED_BYTE, colors.data());
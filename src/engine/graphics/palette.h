@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <unordered_map>
+#include <mutex>
 #include "engine/core/common.h"
 #include "engine/core/error_possible.h"
 #include "engine/core/to_string.h"
@@ -38,6 +39,18 @@ protected:
      */
     bool dirty;
 
+    /**
+     * Guards colors and dirty state since colors can be changed by simulation while texture is updated by renderer
+     */
+    mutable std::mutex mutex;
+
+    /**
+     * Creates the texture, must be called in thread which has the OpenGL context
+     *
+     * @return true if OK
+     */
+    bool createTexture();
+
 public:
     /**
      * Is palette for extra colors?
@@ -128,12 +141,19 @@ public:
     GLuint bindTexture() const;
 
     /**
-     * Updates the palette content to texture
+     * Updates the palette content to texture, creating the texture if was deferred
+     * Must be called in thread which has the OpenGL context
      *
      * @return true if OK
      */
     bool updateTexture();
 
+    /**
+     * Deletes the textures of palettes that were destroyed in a thread without OpenGL context
+     * Must be called in thread which has the OpenGL context
+     */
+    static void deleteReleasedTextures();
+
     /**
      * @return texture id
      */
@@ -5,6 +5,7 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "engine/core/utils.h"
+#include "engine/core/profiler.h"
 #include "palette.h"
 #include "renderer.h"
 #include "renderer_shaders.h"
@@ -797,8 +798,10 @@ void Renderer::drawRectangle(const Rectangle& rectangle, float width, const Colo
 }
 
 bool Renderer::flush() {
+    PROFILE_ZONE("Renderer::flush");
     if (verticesCount > 0) {
         flushes++;
+        verticesUploaded += verticesCount;
 
         //Load combined matrix before drawing
         glm::mat4 combined = projection * view;
@@ -824,10 +827,21 @@ bool Renderer::flush() {
     return true;
 }
 
+void Renderer::prepareFrame() {
+    //Apply viewport change
+    if (viewportDirty) {
+        viewportDirty = false;
+        glViewport(viewport.x, viewport.y, viewport.w, viewport.h);
+    }
+
+    //Cleanup textures of palettes that got destroyed outside of this thread
+    Palette::deleteReleasedTextures();
+}
+
 void Renderer::changeViewport(int x, int y, int width, int height) {
     flush();
     viewport.set(x, y, width, height);
-    glViewport(x, y, width, height);
+    viewportDirty = true;
     projection = glm::ortho(0.0f, static_cast<float>(width), static_cast<float>(height), 0.0f, 1.0f, 3.0f);
 }
 
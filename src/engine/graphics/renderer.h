@@ -158,6 +158,11 @@ private:
      */
     Rectangle viewport;
 
+    /**
+     * Viewport was changed and must be applied in next frame
+     */
+    bool viewportDirty = false;
+
     /**
      * Prepares the internal states to draw using the specified program
      *
@@ -182,6 +187,11 @@ public:
      */
     size_t flushes = 0;
 
+    /**
+     * Vertices uploaded counter
+     */
+    size_t verticesUploaded = 0;
+
     /**
      * Constructor
      */
@@ -203,7 +213,13 @@ public:
     bool flush();
 
     /**
-     * Updates viewport for renderer
+     * Prepares renderer for a new frame by applying pending changes such as viewport
+     * Must be called in thread which has the OpenGL context
+     */
+    void prepareFrame();
+
+    /**
+     * Updates viewport for renderer, is applied at next frame preparation
      * Causes flush
      *
      * @param x
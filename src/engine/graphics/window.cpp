@@ -197,4 +197,11 @@ void Window::setSampling(bool state) {
 
 bool Window::setVSync(bool state) {
     return 0 == SDL_GL_SetSwapInterval(state ? 1 : 0);
-}
\ No newline at end of file
+}
+
+bool Window::setContextCurrent(bool state) {
+    if (!this->check()) {
+        return false;
+    }
+    return 0 == SDL_GL_MakeCurrent(windowHandle, state ? context : nullptr);
+}
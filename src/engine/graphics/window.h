@@ -124,6 +124,15 @@ public:
      * @return true if state was successfully set
      */
     bool setVSync(bool state);
+
+    /**
+     * Makes the OpenGL context current or releases it for the calling thread
+     * Context can only be current in a single thread at same time
+     *
+     * @param state true to make current, false to release
+     * @return true if succeed
+     */
+    bool setContextCurrent(bool state);
 };
 
 #endif //OPENE2140_WINDOW_H
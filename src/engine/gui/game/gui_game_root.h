@@ -5,6 +5,7 @@
 #define OPENE2140_GUI_GAME_ROOT_H
 
 #include "src/engine/gui/gui_root.h"
+#include "engine/simulation/render_snapshot.h"
 
 class Entity;
 class Player;
@@ -33,7 +34,7 @@ public:
     /**
      * The entities drawn in last frame
      */
-    std::vector<std::shared_ptr<Entity>> visibleEntities;
+    std::vector<RenderSnapshotEntity> visibleEntities;
 
     /**
      * @return camera
@@ -6,6 +6,8 @@
 #include "engine/io/log.h"
 #include "engine/graphics/renderer.h"
 #include "engine/simulation/components/player_component.h"
+#include "engine/simulation/simulation.h"
+#include "engine/simulation/entity_store.h"
 #include "src/engine/gui/gui_root.h"
 #include "gui_game_root.h"
 #include "selection_overlay.h"
@@ -56,13 +58,11 @@ void SelectionOverlay::draw() {
     Rectangle cameraRectangle;
     gameRoot->getCameraRectangle(cameraRectangle);
 
-    for (const auto& pair : selection) {
-        auto& state = pair.second;
-        const Rectangle& bounds = state.entity->getBounds();
-
-        //Check if visible
-        if (cameraRectangle.isOverlap(bounds)) {
-            renderer->drawRectangle(bounds, 1.0f, state.color);
+    //Use the drawn state of entities since simulation might be updating them meanwhile
+    for (const RenderSnapshotEntity& visible : gameRoot->visibleEntities) {
+        auto it = selection.find(visible.id);
+        if (it != selection.end() && cameraRectangle.isOverlap(visible.bounds)) {
+            renderer->drawRectangle(visible.bounds, 1.0f, it->second.color);
         }
     }
 
@@ -139,16 +139,20 @@ bool SelectionOverlay::mouseClick(int x, int y, mouse_button_t button, bool pres
         }
 
         //Since only visible entities could have been selected we only check those
-        for (auto& entity : gameRoot->visibleEntities) {
+        EntityStore* entityStore = root->getSimulation()->getEntitiesStore();
+        for (const RenderSnapshotEntity& visible : gameRoot->visibleEntities) {
             //Handle according to selection rectangle or click mode
             bool select = isRectangle
-                    ? selectionRectangle.isInside(entity->getPosition())
-                    : entity->getBounds().isInside(*selectionStart);
+                    ? selectionRectangle.isInside(visible.position)
+                    : visible.bounds.isInside(*selectionStart);
 
             //Only add if was not previously selected
-            if (select && !isSelected(entity->getID())) {
-                engine->log->debug("Selected {0}", entity->toString());
-                addEntity(entity);
+            if (select && !isSelected(visible.id)) {
+                std::shared_ptr<Entity> entity = entityStore->getEntity(visible.id);
+                if (entity) {
+                    engine->log->debug("Selected {0}", entity->toString());
+                    addEntity(entity);
+                }
             }
         }
 
@@ -0,0 +1,52 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <algorithm>
+#include "engine/core/engine.h"
+#include "engine/graphics/renderer.h"
+#include "engine/io/metrics.h"
+#include "gui_root.h"
+#include "metrics_overlay.h"
+
+void MetricsOverlay::addGraph(const std::string& name, double budget, const ColorRGBA& color) {
+    graphs.push_back({name, budget, color});
+}
+
+void MetricsOverlay::draw() {
+    Metrics* metrics = root ? root->getEngine()->getMetrics() : nullptr;
+    if (metrics && metrics->debugOverlay) {
+        //Draw each graph stacked from the bottom left corner, one pixel column per sample
+        float bottom = static_cast<float>(rectangle.y + rectangle.h - METRICS_OVERLAY_GRAPH_MARGIN);
+        float left = static_cast<float>(rectangle.x + METRICS_OVERLAY_GRAPH_MARGIN);
+        for (const MetricsOverlayGraph& graph : graphs) {
+            metrics->histogram(graph.name)->getSamples(samples);
+            float top = bottom - METRICS_OVERLAY_GRAPH_HEIGHT;
+
+            //Scale so the highest sample or budget fits the graph
+            double scale = graph.budget;
+            for (double sample : samples) {
+                scale = std::max(scale, sample);
+            }
+            if (0 < scale) {
+                float x = left;
+                for (double sample : samples) {
+                    float height = static_cast<float>(sample / scale) * METRICS_OVERLAY_GRAPH_HEIGHT;
+                    bool over = 0 < graph.budget && graph.budget < sample;
+                    renderer->drawLine(x, bottom, x, bottom - height, 1, over ? Color::RED : graph.color);
+                    x += 1;
+                }
+            }
+
+            //Show the budget line and graph bounds
+            if (0 < graph.budget) {
+                float budgetY = bottom - static_cast<float>(graph.budget / scale) * METRICS_OVERLAY_GRAPH_HEIGHT;
+                renderer->drawLine(left, budgetY, left + METRICS_HISTOGRAM_SAMPLES, budgetY, 1, Color::WHITE);
+            }
+            renderer->drawRectangle(left, top, METRICS_HISTOGRAM_SAMPLES, METRICS_OVERLAY_GRAPH_HEIGHT, 1, Color::GREY);
+
+            bottom = top - METRICS_OVERLAY_GRAPH_MARGIN;
+        }
+    }
+
+    GUIView::draw();
+}
@@ -0,0 +1,70 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_METRICS_OVERLAY_H
+#define OPENE2140_METRICS_OVERLAY_H
+
+#include "engine/core/macros.h"
+#include "engine/graphics/color.h"
+#include "gui_view.h"
+
+/** Height in pixels of each graph */
+#define METRICS_OVERLAY_GRAPH_HEIGHT 40
+/** Space in pixels between graphs and screen border */
+#define METRICS_OVERLAY_GRAPH_MARGIN 4
+
+/**
+ * Graph of a histogram metric
+ */
+struct MetricsOverlayGraph {
+    /**
+     * Name of histogram metric
+     */
+    std::string name;
+
+    /**
+     * Value considered the limit, samples above are drawn as over budget, 0 for none
+     */
+    double budget;
+
+    /**
+     * Color for samples within budget
+     */
+    ColorRGBA color;
+};
+
+/**
+ * Debug overlay that graphs the latest samples of histogram metrics
+ */
+class MetricsOverlay: public GUIView {
+protected:
+    /**
+     * Graphs to draw from bottom to top
+     */
+    std::vector<MetricsOverlayGraph> graphs;
+
+    /**
+     * Buffer for samples to draw
+     */
+    std::vector<double> samples;
+
+public:
+    /**
+     * Adds a graph to overlay
+     *
+     * @param name of histogram metric
+     * @param budget value considered the limit, 0 for none
+     * @param color for samples within budget
+     */
+    void addGraph(const std::string& name, double budget, const ColorRGBA& color);
+
+    /*
+     * GUIView overrides
+     */
+
+    TYPE_NAME_OVERRIDE(MetricsOverlay);
+
+    void draw() override;
+};
+
+#endif //OPENE2140_METRICS_OVERLAY_H
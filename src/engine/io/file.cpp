@@ -73,6 +73,9 @@ bool File::fromPath(const std::string& path, const File::FileMode& mode) {
         case FileMode::Write:
             modeChars = "wb";
             break;
+        case FileMode::Append:
+            modeChars = "ab";
+            break;
     }
 
     //Open file path with mode
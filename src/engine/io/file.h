@@ -44,7 +44,8 @@ public:
      */
     enum class FileMode {
         Read,
-        Write
+        Write,
+        Append
     };
 
     /**
@@ -3,12 +3,16 @@
 //
 #include "engine/core/common.h"
 #include "engine/core/utils.h"
+#include "log_async_sink.h"
 #include "log.h"
 
 std::list<spdlog::sink_ptr> Log::sinks;
+std::shared_ptr<LogAsyncSink> Log::asyncSink;
+std::mutex Log::mutex;
 
 log_ptr Log::get(const std::string& name) {
     std::string logName = Utils::padRight(name, 10);
+    std::lock_guard<std::mutex> lock(mutex);
 
     //Check if exists
     log_ptr logger = spdlog::get(logName);
@@ -27,8 +31,13 @@ log_ptr Log::get(const std::string& name) {
         }
     }
 
+    //Create the async sink that writes into sinks without blocking the logging thread
+    if (!asyncSink) {
+        asyncSink = std::make_shared<LogAsyncSink>(sinks);
+    }
+
     //Create logger
-    logger = std::make_shared<spdlog::logger>(logName, begin(Log::sinks), end(Log::sinks));
+    logger = std::make_shared<spdlog::logger>(logName, asyncSink);
     Log::set_default_level(logger);
     logger->flush_on(spdlog::level::info);
     logger->set_pattern("[%H:%M:%S.%e][%L][%n] %v");
@@ -45,6 +54,14 @@ void Log::set_default_level(log_ptr logger) {
 }
 
 void Log::closeAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    //Write pending messages and stop writer, any log still cached will write synchronously
+    if (asyncSink) {
+        asyncSink->close();
+        asyncSink.reset();
+    }
+
     //Drop the logs
     spdlog::drop_all();
 
@@ -5,6 +5,9 @@
 #define OPENE2140_LOG_H
 
 #include <list>
+#include <mutex>
+#include "build_config.h"
+#include "engine/core/build_config_placeholder.h"
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/stdout_sinks.h"
 #include "spdlog/sinks/basic_file_sink.h"
@@ -15,6 +18,36 @@ using log_ptr = std::shared_ptr<spdlog::logger>;
 /** Log levels */
 using log_level = spdlog::level::level_enum;
 
+class LogAsyncSink;
+
+/**
+ * Logs a debug message into provided log, arguments are only evaluated if debug level is enabled
+ * and the whole call is removed from builds without debug logs
+ */
+#if GAME_LOG_DEBUG
+#define LOG_DEBUG_TO(LOG, ...) do { \
+    if ((LOG)->should_log(spdlog::level::debug)) { (LOG)->debug(__VA_ARGS__); } \
+} while (false)
+#else
+#define LOG_DEBUG_TO(LOG, ...) do { } while (false)
+#endif
+
+/** Logs a debug message into main log, the log handle is cached in each call site */
+#if GAME_LOG_DEBUG
+#define LOG_DEBUG(...) do { \
+    static const log_ptr logDebugSite = Log::get(); \
+    LOG_DEBUG_TO(logDebugSite, __VA_ARGS__); \
+} while (false)
+#else
+#define LOG_DEBUG(...) do { } while (false)
+#endif
+
+/** Logs a bug message, the log handle is cached in each call site */
+#define LOG_BUG(...) do { \
+    static const log_ptr logBugSite = Log::get("Bug"); \
+    logBugSite->error(__VA_ARGS__); \
+} while (false)
+
 /**
  * Log class for static methods
  */
@@ -24,6 +57,16 @@ private:
      * Sinks to use when creating logs
      */
     static std::list<spdlog::sink_ptr> sinks;
+
+    /**
+     * Sink used by all logs which passes the messages to sinks from writer thread
+     */
+    static std::shared_ptr<LogAsyncSink> asyncSink;
+
+    /**
+     * Guards the creation of logs and sinks
+     */
+    static std::mutex mutex;
 public:
     /**
      * Creates or return's existing log pointer
@@ -0,0 +1,183 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include "log_async_sink.h"
+
+LogAsyncSink::LogAsyncSink(std::list<spdlog::sink_ptr> sinks): sinks(std::move(sinks)) {
+    entries = std::make_unique<LogAsyncEntry[]>(LOG_ASYNC_QUEUE_SIZE);
+    for (size_t i = 0; i < LOG_ASYNC_QUEUE_SIZE; ++i) {
+        entries[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer = std::thread(&LogAsyncSink::writerLoop, this);
+}
+
+LogAsyncSink::~LogAsyncSink() {
+    close();
+}
+
+void LogAsyncSink::close() {
+    if (!writer.joinable()) {
+        return;
+    }
+    running = false;
+    writer.join();
+
+    //Messages pushed while writer was finishing are still in queue
+    writeQueued();
+}
+
+bool LogAsyncSink::push(const spdlog::details::log_msg& msg) {
+    //Bounded queue where each slot sequence tells if it's free for the position being pushed
+    size_t position = enqueuePosition.load(std::memory_order_relaxed);
+    LogAsyncEntry* entry;
+    while (true) {
+        entry = &entries[position & (LOG_ASYNC_QUEUE_SIZE - 1)];
+        size_t sequence = entry->sequence.load(std::memory_order_acquire);
+        auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+        if (difference == 0) {
+            if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            //Queue is full
+            return false;
+        } else {
+            position = enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    //Copy the message into slot and publish it
+    entry->time = msg.time;
+    entry->threadId = msg.thread_id;
+    entry->level = msg.level;
+    entry->nameLength = std::min(msg.logger_name.size(), static_cast<size_t>(LOG_ASYNC_NAME_SIZE));
+    std::memcpy(entry->name, msg.logger_name.data(), entry->nameLength);
+    //Long payloads are cut marking the end so it's visible that there was more
+    if (msg.payload.size() <= LOG_ASYNC_PAYLOAD_SIZE) {
+        entry->payloadLength = msg.payload.size();
+        std::memcpy(entry->payload, msg.payload.data(), entry->payloadLength);
+    } else {
+        entry->payloadLength = LOG_ASYNC_PAYLOAD_SIZE;
+        std::memcpy(entry->payload, msg.payload.data(), LOG_ASYNC_PAYLOAD_SIZE - 3);
+        std::memcpy(entry->payload + LOG_ASYNC_PAYLOAD_SIZE - 3, "...", 3);
+    }
+    entry->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogAsyncSink::writeQueued() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return writeQueuedLocked();
+}
+
+bool LogAsyncSink::writeQueuedLocked() {
+    bool written = false;
+    while (true) {
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        LogAsyncEntry& entry = entries[position & (LOG_ASYNC_QUEUE_SIZE - 1)];
+        if (entry.sequence.load(std::memory_order_acquire) != position + 1) {
+            break;
+        }
+
+        //Recreate the message and write it
+        spdlog::details::log_msg msg(
+                entry.time, spdlog::source_loc{},
+                spdlog::string_view_t(entry.name, entry.nameLength),
+                entry.level,
+                spdlog::string_view_t(entry.payload, entry.payloadLength)
+        );
+        msg.thread_id = entry.threadId;
+        write(msg);
+        if (spdlog::level::info <= entry.level) {
+            flushRequested = true;
+        }
+
+        //Free the slot for the position that will use it next time
+        entry.sequence.store(position + LOG_ASYNC_QUEUE_SIZE, std::memory_order_release);
+        dequeuePosition.store(position + 1, std::memory_order_release);
+        written = true;
+    }
+
+    //Report any message that couldn't be queued
+    size_t droppedCount = dropped.exchange(0);
+    if (droppedCount) {
+        std::string text = "Dropped " + std::to_string(droppedCount) + " log messages due to full queue";
+        spdlog::details::log_msg msg("Log", spdlog::level::warn, text);
+        write(msg);
+        flushRequested = true;
+    }
+
+    if (flushRequested.exchange(false)) {
+        flushSinks();
+    }
+    return written;
+}
+
+void LogAsyncSink::write(const spdlog::details::log_msg& msg) {
+    for (spdlog::sink_ptr& sink : sinks) {
+        if (sink->should_log(msg.level)) {
+            sink->log(msg);
+        }
+    }
+}
+
+void LogAsyncSink::flushSinks() {
+    for (spdlog::sink_ptr& sink : sinks) {
+        sink->flush();
+    }
+}
+
+void LogAsyncSink::writerLoop() {
+    while (running) {
+        if (!writeQueued()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(LOG_ASYNC_IDLE_MS));
+        }
+    }
+
+    //Write what is left
+    writeQueued();
+}
+
+void LogAsyncSink::log(const spdlog::details::log_msg& msg) {
+    //Logging threads don't wait for writer, errors are flushed by writer as soon as it takes them
+    if (running && msg.level < spdlog::level::critical) {
+        if (push(msg)) {
+            //Writer might have stopped after the check, so write it here instead of leaving it in queue
+            if (!running) {
+                writeQueued();
+            }
+            return;
+        }
+        if (msg.level < spdlog::level::err) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    //Critical messages usually precede a crash and errors are never dropped, so they are written right away after
+    //the queued ones to keep the order
+    std::lock_guard<std::mutex> lock(writeMutex);
+    writeQueuedLocked();
+    write(msg);
+    flushSinks();
+}
+
+void LogAsyncSink::flush() {
+    flushRequested = true;
+}
+
+void LogAsyncSink::set_pattern(const std::string& pattern) {
+    for (spdlog::sink_ptr& sink : sinks) {
+        sink->set_pattern(pattern);
+    }
+}
+
+void LogAsyncSink::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) {
+    for (spdlog::sink_ptr& sink : sinks) {
+        sink->set_formatter(sink_formatter->clone());
+    }
+}
@@ -0,0 +1,199 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_LOG_ASYNC_SINK_H
+#define OPENE2140_LOG_ASYNC_SINK_H
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "spdlog/sinks/sink.h"
+#include "engine/core/macros.h"
+
+/** Amount of messages that queue can hold, must be power of 2 */
+#define LOG_ASYNC_QUEUE_SIZE 4096
+/** Max size of logger name stored in each queued message */
+#define LOG_ASYNC_NAME_SIZE 32
+/** Max size of payload stored in each queued message, longer messages are truncated and marked */
+#define LOG_ASYNC_PAYLOAD_SIZE 480
+/** Milliseconds that writer sleeps when queue is empty */
+#define LOG_ASYNC_IDLE_MS 5
+
+/**
+ * Message stored in queue slot
+ */
+struct LogAsyncEntry {
+    /**
+     * Sequence used by queue to know if slot is free or contains a message
+     */
+    std::atomic<size_t> sequence;
+
+    /**
+     * Time when message was logged
+     */
+    spdlog::log_clock::time_point time;
+
+    /**
+     * Thread that logged the message
+     */
+    size_t threadId;
+
+    /**
+     * Level of message
+     */
+    spdlog::level::level_enum level;
+
+    /**
+     * Length of name
+     */
+    size_t nameLength;
+
+    /**
+     * Length of payload
+     */
+    size_t payloadLength;
+
+    /**
+     * Logger name
+     */
+    char name[LOG_ASYNC_NAME_SIZE];
+
+    /**
+     * Formatted message
+     */
+    char payload[LOG_ASYNC_PAYLOAD_SIZE];
+};
+
+/**
+ * Sink that copies messages into a preallocated lock-free queue so logging threads never allocate nor block,
+ * a writer thread passes them to the actual sinks
+ *
+ * Messages that don't fit in a slot are truncated and if queue is full the message is dropped and counted, critical
+ * messages, errors that find the queue full and messages logged after writer stopped are written synchronously after
+ * the queued ones
+ */
+class LogAsyncSink: public spdlog::sinks::sink {
+private:
+    /**
+     * Sinks that writer passes the messages to
+     */
+    std::list<spdlog::sink_ptr> sinks;
+
+    /**
+     * Queue slots
+     */
+    std::unique_ptr<LogAsyncEntry[]> entries;
+
+    /**
+     * Position where next message is pushed
+     */
+    std::atomic<size_t> enqueuePosition = 0;
+
+    /**
+     * Position where next message is popped, only modified while holding writeMutex
+     */
+    std::atomic<size_t> dequeuePosition = 0;
+
+    /**
+     * Amount of messages dropped due to full queue
+     */
+    std::atomic<size_t> dropped = 0;
+
+    /**
+     * Flag to request sinks flush
+     */
+    std::atomic<bool> flushRequested = false;
+
+    /**
+     * Flag to keep writer running
+     */
+    std::atomic<bool> running = true;
+
+    /**
+     * Guards writing into sinks between writer and writes after writer stopped
+     */
+    std::mutex writeMutex;
+
+    /**
+     * Writer thread
+     */
+    std::thread writer;
+
+    /**
+     * Attempts to push the message into queue
+     *
+     * @param msg to push
+     * @return true if pushed
+     */
+    bool push(const spdlog::details::log_msg& msg);
+
+    /**
+     * Writes the messages in queue into sinks
+     *
+     * @return true if any was written
+     */
+    bool writeQueued();
+
+    /**
+     * Writes the messages in queue into sinks, writeMutex must be held
+     *
+     * @return true if any was written
+     */
+    bool writeQueuedLocked();
+
+    /**
+     * Passes message to all sinks, writeMutex must be held
+     *
+     * @param msg to write
+     */
+    void write(const spdlog::details::log_msg& msg);
+
+    /**
+     * Flushes all sinks, writeMutex must be held
+     */
+    void flushSinks();
+
+    /**
+     * Writer thread loop
+     */
+    void writerLoop();
+
+public:
+    /**
+     * Constructor
+     *
+     * @param sinks to pass messages to
+     */
+    explicit LogAsyncSink(std::list<spdlog::sink_ptr> sinks);
+
+    /**
+     * Destructor, writes any remaining message
+     */
+    ~LogAsyncSink() override;
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(LogAsyncSink)
+
+    /**
+     * Stops writer after writing all queued messages
+     */
+    void close();
+
+    /*
+     * Sink overrides
+     */
+
+    void log(const spdlog::details::log_msg& msg) override;
+
+    void flush() override;
+
+    void set_pattern(const std::string& pattern) override;
+
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+};
+
+#endif //OPENE2140_LOG_ASYNC_SINK_H
@@ -0,0 +1,168 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <algorithm>
+#include <SDL.h>
+#include "engine/core/common.h"
+#include "engine/core/utils.h"
+#include "engine/io/file.h"
+#include "engine/io/timer.h"
+#include "metrics.h"
+
+void MetricHistogram::record(double value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (samples.empty()) {
+        samples.resize(METRICS_HISTOGRAM_SAMPLES);
+    }
+    if (count == 0 || max < value) {
+        max = value;
+    }
+    count++;
+    sum += value;
+    samples[samplesHead % METRICS_HISTOGRAM_SAMPLES] = value;
+    samplesHead++;
+}
+
+void MetricHistogram::snapshot(const std::string& name, config_data_t& data) {
+    std::vector<double> sorted;
+    getSamples(sorted);
+    std::lock_guard<std::mutex> lock(mutex);
+
+    //Percentiles use only the samples since last reset that are still in ring
+    size_t recent = std::min(sorted.size(), static_cast<size_t>(count));
+    sorted.erase(sorted.begin(), sorted.end() - static_cast<long>(recent));
+    std::sort(BEGIN_END(sorted));
+    double p50 = sorted.empty() ? 0 : sorted[sorted.size() / 2];
+    double p95 = sorted.empty() ? 0 : sorted[(sorted.size() * 95) / 100];
+
+    data[name + "_count"] = count;
+    data[name + "_mean"] = count == 0 ? 0 : sum / static_cast<double>(count);
+    data[name + "_p50"] = p50;
+    data[name + "_p95"] = p95;
+    data[name + "_max"] = max;
+
+    //Reset for next snapshot
+    count = 0;
+    sum = 0;
+    max = 0;
+}
+
+void MetricHistogram::getSamples(std::vector<double>& values) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    values.clear();
+    size_t size = std::min(samplesHead, static_cast<size_t>(METRICS_HISTOGRAM_SAMPLES));
+    for (size_t i = samplesHead - size; i < samplesHead; ++i) {
+        values.push_back(samples[i % METRICS_HISTOGRAM_SAMPLES]);
+    }
+}
+
+Metrics::Metrics() {
+    log = Log::get("Metrics");
+    debugOverlay = Utils::isFlag(FLAG_DEBUG_ALL);
+    timer = std::make_unique<Timer>();
+}
+
+Metrics::~Metrics() {
+    if (log) {
+        log.reset();
+    }
+}
+
+MetricCounter* Metrics::counter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<MetricCounter>& metric = counters[name];
+    if (!metric) {
+        metric = std::make_unique<MetricCounter>();
+    }
+    return metric.get();
+}
+
+MetricGauge* Metrics::gauge(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<MetricGauge>& metric = gauges[name];
+    if (!metric) {
+        metric = std::make_unique<MetricGauge>();
+    }
+    return metric.get();
+}
+
+MetricHistogram* Metrics::histogram(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<MetricHistogram>& metric = histograms[name];
+    if (!metric) {
+        metric = std::make_unique<MetricHistogram>();
+    }
+    return metric.get();
+}
+
+void Metrics::setDump(float seconds, const std::string& format) {
+    interval = std::max(0.0f, seconds);
+    csv = format != "json";
+    timer->update();
+    if (0 < interval) {
+        log->debug("Dumping metrics every {0} seconds as {1}", interval, csv ? "csv" : "json");
+    }
+}
+
+void Metrics::update(bool force) {
+    if (0 < interval && (force || interval <= timer->elapsed())) {
+        timer->update();
+        dump();
+    }
+}
+
+void Metrics::snapshot(config_data_t& data) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& pair : counters) {
+        data[pair.first] = pair.second->get();
+    }
+    for (auto& pair : gauges) {
+        data[pair.first] = pair.second->get();
+    }
+    for (auto& pair : histograms) {
+        pair.second->snapshot(pair.first, data);
+    }
+}
+
+void Metrics::dump() {
+    config_data_t data = config_data_t::object();
+    data["time"] = SDL_GetTicks();
+    snapshot(data);
+
+    //Assemble the content to append
+    std::string content;
+    std::string path = Utils::getUserPath();
+    if (csv) {
+        path += METRICS_CSV_FILE;
+        std::vector<std::string> columns;
+        std::vector<std::string> values;
+        for (auto& item : data.items()) {
+            columns.push_back(item.key());
+            values.push_back(item.value().dump());
+        }
+        //Write header when columns change such as on first dump or new metrics being registered
+        if (columns != csvColumns) {
+            csvColumns = columns;
+            Utils::join(content, BEGIN_END(columns), ",");
+            content += "\n";
+        }
+        Utils::join(content, BEGIN_END(values), ",");
+        content += "\n";
+    } else {
+        path += METRICS_JSON_FILE;
+        content = data.dump() + "\n";
+    }
+
+    //Append to file
+    File file;
+    file.fromPath(path, File::FileMode::Append);
+    error = file.getError();
+    if (!hasError()) {
+        file.write(content.c_str(), content.size());
+        error = file.getError();
+    }
+    file.close();
+    if (hasError()) {
+        log->error("Error writing metrics to {0}:\n{1}", path, getError());
+    }
+}
@@ -0,0 +1,274 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_METRICS_H
+#define OPENE2140_METRICS_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "engine/core/macros.h"
+#include "engine/core/types.h"
+#include "engine/core/error_possible.h"
+#include "engine/io/log.h"
+
+class Timer;
+
+/** Amount of latest samples that histograms keep for percentiles and graphs */
+#define METRICS_HISTOGRAM_SAMPLES 256
+/** Name of file in user path where CSV snapshots are appended */
+#define METRICS_CSV_FILE "metrics.csv"
+/** Name of file in user path where JSON snapshots are appended, one per line */
+#define METRICS_JSON_FILE "metrics.jsonl"
+/** Names of engine metrics */
+#define METRIC_ENTITIES          "entities"
+#define METRIC_DRAW_CALLS        "draw_calls"
+#define METRIC_VERTICES_UPLOADED "vertices_uploaded"
+#define METRIC_ASTAR_EXPANSIONS  "astar_expansions"
+#define METRIC_PATH_REQUESTS     "path_requests"
+#define METRIC_TICK_MS           "tick_ms"
+#define METRIC_FRAME_MS          "frame_ms"
+#define METRIC_ASSET_BYTES       "asset_bytes"
+
+/**
+ * Monotonic increasing value
+ */
+class MetricCounter {
+private:
+    /**
+     * Accumulated value
+     */
+    std::atomic<uint64_t> value = 0;
+
+public:
+    /**
+     * Increments the counter
+     *
+     * @param amount to add
+     */
+    void add(uint64_t amount = 1) {
+        value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return current value
+     */
+    uint64_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Value that is set to the current state
+ */
+class MetricGauge {
+private:
+    /**
+     * Current value
+     */
+    std::atomic<double> value = 0;
+
+public:
+    /**
+     * Sets the gauge value
+     *
+     * @param newValue to set
+     */
+    void set(double newValue) {
+        value.store(newValue, std::memory_order_relaxed);
+    }
+
+    /**
+     * @return current value
+     */
+    double get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Distribution of recorded values since last snapshot
+ */
+class MetricHistogram {
+private:
+    /**
+     * Guards the values
+     */
+    mutable std::mutex mutex;
+
+    /**
+     * Amount of values recorded since last reset
+     */
+    uint64_t count = 0;
+
+    /**
+     * Sum of values recorded since last reset
+     */
+    double sum = 0;
+
+    /**
+     * Maximum value recorded since last reset
+     */
+    double max = 0;
+
+    /**
+     * Latest recorded values, used as ring
+     */
+    std::vector<double> samples;
+
+    /**
+     * Total amount of values recorded, position in ring is this modulo samples size
+     */
+    size_t samplesHead = 0;
+
+public:
+    /**
+     * Records a value
+     *
+     * @param value to record
+     */
+    void record(double value);
+
+    /**
+     * Writes the stats since last reset and resets them
+     *
+     * @param name of histogram to use as prefix for the stats
+     * @param data to write stats into
+     */
+    void snapshot(const std::string& name, config_data_t& data);
+
+    /**
+     * Copies the latest samples from oldest to newest
+     *
+     * @param values to copy into
+     */
+    void getSamples(std::vector<double>& values) const;
+};
+
+/**
+ * Central registry of runtime metrics, snapshots are periodically appended to a file in user path
+ */
+class Metrics: public IErrorPossible {
+private:
+    /**
+     * Log for object
+     */
+    log_ptr log;
+
+    /**
+     * Guards the registry maps, metrics themselves are thread safe
+     */
+    mutable std::mutex mutex;
+
+    /**
+     * Registered counters
+     */
+    std::map<std::string, std::unique_ptr<MetricCounter>> counters;
+
+    /**
+     * Registered gauges
+     */
+    std::map<std::string, std::unique_ptr<MetricGauge>> gauges;
+
+    /**
+     * Registered histograms
+     */
+    std::map<std::string, std::unique_ptr<MetricHistogram>> histograms;
+
+    /**
+     * Seconds between each dump, 0 disables dumping
+     */
+    float interval = 0;
+
+    /**
+     * Writes CSV if true, JSON lines otherwise
+     */
+    bool csv = true;
+
+    /**
+     * Timer since last dump
+     */
+    std::unique_ptr<Timer> timer;
+
+    /**
+     * Columns written in CSV header, if changed a new header is written
+     */
+    std::vector<std::string> csvColumns;
+
+public:
+    /**
+     * Flag for showing the metrics debug overlay
+     */
+    bool debugOverlay = false;
+
+    /**
+     * Constructor
+     */
+    Metrics();
+
+    /**
+     * Destructor
+     */
+    ~Metrics() override;
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(Metrics)
+
+    /**
+     * Obtains or registers a counter
+     *
+     * @param name of metric
+     * @return counter
+     */
+    MetricCounter* counter(const std::string& name);
+
+    /**
+     * Obtains or registers a gauge
+     *
+     * @param name of metric
+     * @return gauge
+     */
+    MetricGauge* gauge(const std::string& name);
+
+    /**
+     * Obtains or registers a histogram
+     *
+     * @param name of metric
+     * @return histogram
+     */
+    MetricHistogram* histogram(const std::string& name);
+
+    /**
+     * Sets the dump settings
+     *
+     * @param seconds between each dump, 0 disables dumping
+     * @param format "csv" or "json"
+     */
+    void setDump(float seconds, const std::string& format);
+
+    /**
+     * Dumps snapshot if interval passed
+     *
+     * @param force to dump even if interval didn't pass yet, such as when closing
+     */
+    void update(bool force = false);
+
+    /**
+     * Writes the current value of all metrics, resetting histograms stats
+     *
+     * @param data to write into
+     */
+    void snapshot(config_data_t& data);
+
+    /**
+     * Appends a snapshot into the metrics file in user path
+     */
+    void dump();
+};
+
+#endif //OPENE2140_METRICS_H
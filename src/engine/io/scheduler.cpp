@@ -0,0 +1,57 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <algorithm>
+#include "scheduler.h"
+
+Scheduler::Scheduler(unsigned int ticksPerSecond, unsigned int maxTicks, unsigned int framesPerSecond) :
+        tickDelta(1.0f / std::max(1U, ticksPerSecond)),
+        frameDelta(framesPerSecond == 0 ? 0 : 1.0f / framesPerSecond),
+        maxTicks(std::max(1U, maxTicks)) {
+}
+
+unsigned int Scheduler::advance() {
+    accumulator += timer.elapsed();
+    timer.update();
+
+    //Count the ticks we can consume
+    unsigned int ticks = 0;
+    while (tickDelta <= accumulator) {
+        accumulator -= tickDelta;
+        ticks++;
+    }
+
+    //Drop the ticks over limit, the simulation will run slower than real time but stays responsive
+    if (maxTicks < ticks) {
+        droppedTicks += ticks - maxTicks;
+        ticks = maxTicks;
+    }
+
+    return ticks;
+}
+
+void Scheduler::waitFrame() {
+    //Ticks that become due meanwhile are caught up in next advance
+    float time = frameDelta - frameTimer.elapsed();
+    if (0 < time) {
+        Timer sleepTimer;
+        sleepTimer.wait(time);
+    }
+    frameTimer.update();
+}
+
+void Scheduler::waitTick() {
+    float time = tickDelta - accumulator - timer.elapsed();
+    if (0 < time) {
+        Timer sleepTimer;
+        sleepTimer.wait(time);
+    }
+}
+
+float Scheduler::getTickDelta() const {
+    return tickDelta;
+}
+
+unsigned long Scheduler::getDroppedTicks() const {
+    return droppedTicks;
+}
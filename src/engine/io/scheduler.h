@@ -0,0 +1,98 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_SCHEDULER_H
+#define OPENE2140_SCHEDULER_H
+
+#include "engine/core/macros.h"
+#include "timer.h"
+
+/**
+ * Fixed timestep scheduler for engine loop
+ *
+ * Accumulates real elapsed time and tells how many fixed ticks should be run to catch up
+ * and paces the loop by sleeping until next frame or tick is due instead of busy looping
+ */
+class Scheduler {
+private:
+    /**
+     * Timer to measure real time between advances
+     */
+    Timer timer;
+
+    /**
+     * Timer to measure time since last frame to pace the loop
+     */
+    Timer frameTimer;
+
+    /**
+     * Duration of each tick in seconds
+     */
+    float tickDelta;
+
+    /**
+     * Minimum duration of each frame in seconds, 0 if unlimited
+     */
+    float frameDelta;
+
+    /**
+     * Max amount of ticks that can be run in a single advance
+     */
+    unsigned int maxTicks;
+
+    /**
+     * Accumulated time not consumed by ticks yet in seconds
+     */
+    float accumulator = 0;
+
+    /**
+     * Total amount of ticks dropped because were over the max ticks
+     */
+    unsigned long droppedTicks = 0;
+
+public:
+    /**
+     * Constructor
+     *
+     * @param ticksPerSecond amount of fixed ticks per second
+     * @param maxTicks max amount of catch up ticks per advance
+     * @param framesPerSecond max frames per second, 0 if unlimited
+     */
+    Scheduler(unsigned int ticksPerSecond, unsigned int maxTicks, unsigned int framesPerSecond);
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(Scheduler)
+
+    /**
+     * Adds the real elapsed time since last advance and consumes it as ticks
+     * If more ticks than max are due the excess time is dropped to avoid spiral of death
+     *
+     * @return amount of ticks to run now
+     */
+    unsigned int advance();
+
+    /**
+     * Sleeps until next frame is due according to frame limit
+     * Only uses frame state so it can be called from a different thread than the rest of methods
+     */
+    void waitFrame();
+
+    /**
+     * Sleeps until next tick is due
+     */
+    void waitTick();
+
+    /**
+     * @return duration of each tick in seconds
+     */
+    float getTickDelta() const;
+
+    /**
+     * @return total amount of ticks dropped
+     */
+    unsigned long getDroppedTicks() const;
+};
+
+#endif //OPENE2140_SCHEDULER_H
@@ -18,8 +18,13 @@ float Timer::elapsed() {
 }
 
 void Timer::wait(float time) {
-    time -= elapsed();
-    if (0 < time) {
-        SDL_Delay((Uint32) (time * 1000));
+    //Sleep most of the remaining time, OS sleep granularity can overshoot so we leave a margin
+    float left = time - elapsed();
+    if (TIMER_WAIT_SPIN_MARGIN < left) {
+        SDL_Delay((Uint32) ((left - TIMER_WAIT_SPIN_MARGIN) * 1000));
+    }
+
+    //Spin the rest for precision
+    while (elapsed() < time) {
     }
 }
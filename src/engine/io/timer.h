@@ -6,6 +6,9 @@
 
 #include "SDL_types.h"
 
+/** Time in seconds left to spin instead of sleeping when waiting */
+#define TIMER_WAIT_SPIN_MARGIN 0.002f
+
 /**
  * Implements timer object using SDL2 timers as a backend
  */
@@ -39,8 +42,9 @@ public:
 
     /**
      * Waits specified time from last update
+     * Sleeps the most of time and spins the rest to not overshoot
      *
-     * @param time to wait
+     * @param time to wait in seconds
      */
     void wait(float time);
 };
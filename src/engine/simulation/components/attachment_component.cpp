@@ -28,6 +28,10 @@ void AttachmentComponent::simulationChanged() {
         const EntityConfig* config = base->getConfig();
         config->getVector2("attachments_center_offset", attachmentCenterOffset);
         updateAttachmentOnEntityChange = config->getData<bool>("attachments_update_on_change", true);
+        subscribedChanges = 0;
+        if (updateAttachmentOnEntityChange) {
+            subscribedChanges = ENTITY_CHANGE_POSITION | ENTITY_CHANGE_ATTACHMENT;
+        }
         config_data_t attachments = config->getData("attachments");
         if (attachments.is_object()) {
             entity_kind_t kind = config->getData("attachments_kind", 0);
@@ -59,12 +63,53 @@ void AttachmentComponent::update() {
     }
 }
 
-void AttachmentComponent::entityChanged() {
+void AttachmentComponent::updatePlan() {
+    //Propagate update phase call
+    for (const auto& attachment : attached) {
+        Entity* entity = attachment.entity.get();
+        entity->updatePlan();
+    }
+}
+
+void AttachmentComponent::updateIntegrate() {
+    //Propagate update phase call
+    for (const auto& attachment : attached) {
+        Entity* entity = attachment.entity.get();
+        entity->updateIntegrate();
+    }
+}
+
+void AttachmentComponent::updateAnimate() {
+    //Propagate update phase call
+    for (const auto& attachment : attached) {
+        Entity* entity = attachment.entity.get();
+        entity->updateAnimate();
+    }
+}
+
+bool AttachmentComponent::hasPendingWork() {
+    //Attached entities are updated by this entity so it must stay awake for them
+    for (const auto& attachment : attached) {
+        if (attachment.entity->hasPendingWork()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AttachmentComponent::entityChanged(entity_changes_t changes) {
     if (updateAttachmentOnEntityChange) {
         updateAttachmentPositions();
     }
 }
 
+void AttachmentComponent::saveState(SaveWriter& writer) {
+    //Attached entities are created again from config when entity is added to simulation, their state is saved as entities
+}
+
+void AttachmentComponent::loadState(SaveReader& reader) {
+}
+
 void AttachmentComponent::updateAttachmentPositions(number_t angle) {
     //Update the entities
     for (const auto& attachment : attached) {
@@ -110,7 +155,7 @@ AttachmentPoint& AttachmentComponent::attachEntity(const std::string& code, cons
     if (simulation && !entity->isActive()) {
         simulation->addEntity(entity);
     }
-    base->changesCount++;
+    base->markChanged(ENTITY_CHANGE_ATTACHMENT);
 
     return attachment;
 }
@@ -137,7 +182,7 @@ void AttachmentComponent::detachEntity(const std::shared_ptr<Entity>& entity) {
         simulation->removeEntity(entity);
     }
     entity->setParent(nullptr);
-    base->changesCount++;
+    base->markChanged(ENTITY_CHANGE_ATTACHMENT);
 }
 
 void AttachmentComponent::detachEntities() {
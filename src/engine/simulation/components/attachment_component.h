@@ -40,6 +40,26 @@ public:
      */
     bool updateAttachmentOnEntityChange = true;
 
+    /**
+     * Runs plan phase of attached entities
+     */
+    void updatePlan();
+
+    /**
+     * Runs integrate phase of attached entities
+     */
+    void updateIntegrate();
+
+    /**
+     * Runs animate phase of attached entities
+     */
+    void updateAnimate();
+
+    /**
+     * @return true if any attached entity has pending work
+     */
+    bool hasPendingWork();
+
     /**
      * @return attachment points for entities
      */
@@ -4,8 +4,13 @@
 #ifndef OPENE2140_COMPONENT_H
 #define OPENE2140_COMPONENT_H
 
+#include <type_traits>
 #include "engine/core/to_string.h"
 #include "engine/core/macros.h"
+#include "engine/core/types.h"
+
+class SaveWriter;
+class SaveReader;
 
 /**
  * This macro passes each component methods to provided macro
@@ -13,9 +18,110 @@
 #define COMPONENT_METHODS(MACRO_METHOD) \
     MACRO_METHOD(componentsUpdate, update) \
     MACRO_METHOD(componentsSetup, setup) \
-    MACRO_METHOD(componentsSimulationChanged, simulationChanged) \
+    MACRO_METHOD(componentsSimulationChanged, simulationChanged)
+
+/**
+ * This macro passes each component hook methods to provided macro
+ *
+ * Hooks are optional, components only declare the ones where they do work and the rest are skipped by binder
+ * Each simulation update is split in phases called in this order for all entities:
+ * - updatePlan: read only, can read other entities state but must only store results in own component
+ * - updateIntegrate: applies own entity state such as position or direction
+ * - updateAnimate: advances own entity animations
+ * - update: commit phase, runs sequentially in entity order so can modify shared state
+ * The first three phases are hooks and can run in parallel so they must not modify anything outside own entity
+ */
+#define COMPONENT_HOOK_METHODS(MACRO_METHOD) \
+    MACRO_METHOD(componentsUpdatePlan, updatePlan) \
+    MACRO_METHOD(componentsUpdateIntegrate, updateIntegrate) \
+    MACRO_METHOD(componentsUpdateAnimate, updateAnimate)
+
+/**
+ * This macro passes each component change methods to provided macro
+ *
+ * Changes done to entity are batched and notified once per update in commit phase, only components subscribed to any
+ * of the changes are called and receive the changes they are subscribed to
+ */
+#define COMPONENT_CHANGE_METHODS(MACRO_METHOD) \
     MACRO_METHOD(componentsEntityChanged, entityChanged)
 
+/**
+ * This macro passes each component state methods to provided macro
+ *
+ * State methods write or read the component state that can't be derived from entity config,
+ * each component must read exactly what it writes
+ */
+#define COMPONENT_STATE_METHODS(MACRO_METHOD) \
+    MACRO_METHOD(componentsSaveState, saveState, SaveWriter) \
+    MACRO_METHOD(componentsLoadState, loadState, SaveReader)
+
+/**
+ * This macro passes each component query methods to provided macro
+ *
+ * Query methods are optional like hooks and are true for entity if any of its components declaring them returns true
+ * - hasPendingWork: component needs to be updated in next tick, entities without pending work sleep until woken
+ */
+#define COMPONENT_QUERY_METHODS(MACRO_METHOD) \
+    MACRO_METHOD(componentsHasPendingWork, hasPendingWork)
+
+/**
+ * Template for component state method declaration
+ */
+#define COMPONENT_STATE_METHOD_DECLARATION(BASE_METHOD, COMPONENT_METHOD, T_STREAM) \
+    void COMPONENT_METHOD(T_STREAM& stream);
+
+/**
+ * Template for pure virtual component state method forwarder
+ */
+#define COMPONENT_STATE_METHOD_FORWARD_VIRTUAL(BASE_METHOD, COMPONENT_METHOD, T_STREAM) \
+    virtual void BASE_METHOD(T_STREAM& stream) = 0;
+
+/**
+ * Wrapper for forwarding each components state methods assigned to binder
+ */
+#define COMPONENT_STATE_METHOD_FORWARD(BASE_METHOD, COMPONENT_METHOD, T_STREAM) \
+    void BASE_METHOD(T_STREAM& stream) override { \
+        (Components::COMPONENT_METHOD(stream), ...); \
+    }
+
+/**
+ * Template for component change method declaration
+ */
+#define COMPONENT_CHANGE_METHOD_DECLARATION(BASE_METHOD, COMPONENT_METHOD) \
+    void COMPONENT_METHOD(entity_changes_t changes);
+
+/**
+ * Template for pure virtual component change method forwarder
+ */
+#define COMPONENT_CHANGE_METHOD_FORWARD_VIRTUAL(BASE_METHOD, COMPONENT_METHOD) \
+    virtual void BASE_METHOD(entity_changes_t changes) = 0;
+
+/**
+ * Wrapper for forwarding each components change methods assigned to binder to subscribed components
+ */
+#define COMPONENT_CHANGE_METHOD_FORWARD(BASE_METHOD, COMPONENT_METHOD) \
+    void BASE_METHOD(entity_changes_t changes) override { \
+        ((Components::subscribedChanges & changes \
+            ? Components::COMPONENT_METHOD(changes & Components::subscribedChanges) \
+            : void()), ...); \
+    }
+
+/**
+ * Template for pure virtual component query method forwarder
+ */
+#define COMPONENT_QUERY_METHOD_FORWARD_VIRTUAL(BASE_METHOD, COMPONENT_METHOD) \
+    virtual bool BASE_METHOD() = 0;
+
+/**
+ * Wrapper for forwarding each components query methods assigned to binder, components without it count as false
+ */
+#define COMPONENT_QUERY_METHOD_FORWARD(BASE_METHOD, COMPONENT_METHOD) \
+    bool BASE_METHOD() override { \
+        return (callComponentHook<Components>(false, [](auto& component) -> decltype(component.COMPONENT_METHOD()) { \
+            return component.COMPONENT_METHOD(); \
+        }) || ...); \
+    }
+
 /**
  * Template for component method declaration
  */
@@ -42,6 +148,16 @@
         (Components::COMPONENT_METHOD(), ...); \
     }
 
+/**
+ * Wrapper for forwarding each components hook methods assigned to binder to components declaring it
+ */
+#define COMPONENT_HOOK_METHOD_FORWARD(BASE_METHOD, COMPONENT_METHOD) \
+    void BASE_METHOD() override { \
+        (callComponentHook<Components>(0, [](auto& component) -> decltype(component.COMPONENT_METHOD()) { \
+            component.COMPONENT_METHOD(); \
+        }), ...); \
+    }
+
 /**
  * Assigns provided components to Base and creates a new class
  */
@@ -53,10 +169,31 @@ public:
      */
     ComponentBinder(): Base(), Components(static_cast<Derived*>(this))... {};
 
+    /**
+     * Calls the hook with component if component declares the hooked method
+     *
+     * @tparam Component to pass to hook
+     * @param missing value to return if component doesn't declare the method
+     * @param hook to call
+     * @return hook result or missing value
+     */
+    template<typename Component, typename T, typename Hook>
+    auto callComponentHook(T missing, Hook hook) {
+        if constexpr (std::is_invocable_v<Hook, Component&>) {
+            return hook(static_cast<Component&>(*this));
+        } else {
+            return missing;
+        }
+    }
+
     /*
      * Mass forward methods
      */
     COMPONENT_METHODS(COMPONENT_METHOD_FORWARD)
+    COMPONENT_HOOK_METHODS(COMPONENT_HOOK_METHOD_FORWARD)
+    COMPONENT_CHANGE_METHODS(COMPONENT_CHANGE_METHOD_FORWARD)
+    COMPONENT_STATE_METHODS(COMPONENT_STATE_METHOD_FORWARD)
+    COMPONENT_QUERY_METHODS(COMPONENT_QUERY_METHOD_FORWARD)
 };
 
 /**
@@ -94,7 +231,13 @@ public: \
     /** Destructor */ \
     virtual ~T_COMPONENT(); \
     /** Creates declarations of component methods */ \
-    COMPONENT_METHODS(COMPONENT_METHOD_DECLARATION)
+    COMPONENT_METHODS(COMPONENT_METHOD_DECLARATION) \
+    COMPONENT_CHANGE_METHODS(COMPONENT_CHANGE_METHOD_DECLARATION) \
+    COMPONENT_STATE_METHODS(COMPONENT_STATE_METHOD_DECLARATION) \
+protected: \
+    /** Entity changes which this component is notified about */ \
+    entity_changes_t subscribedChanges = 0; \
+public:
 
 /**
  * Macro for component class body with empty constructor/destructor
@@ -4,12 +4,14 @@
 #include "engine/simulation/player.h"
 #include "engine/simulation/entity.h"
 #include "engine/entities/entity_config.h"
+#include "engine/simulation/save_stream.h"
 #include "player_component.h"
 #include "energy_component.h"
 
 CLASS_COMPONENT_DEFAULT(EnergyComponent)
 
 void EnergyComponent::setup() {
+    subscribedChanges = ENTITY_CHANGE_PLAYER | ENTITY_CHANGE_SELECTION | ENTITY_CHANGE_HEALTH;
 }
 
 void EnergyComponent::simulationChanged() {
@@ -17,34 +19,74 @@ void EnergyComponent::simulationChanged() {
         const EntityConfig* config = base->getConfig();
         energyGeneration = config->getData<entity_energy_t>("energy_generation", 0);
         energyRequirement = config->getData<entity_energy_t>("energy_requirement", 0);
+        energyPriority = config->getData<int>("energy_priority", 0);
+    } else {
+        //Leave the player ledger
+        updateEnergyLedger();
     }
 }
 
 void EnergyComponent::update() {
-    bool satisfied = false;
-
-    //Get player
-    PlayerComponent* playerComponent = GET_COMPONENT_DYNAMIC(base, PlayerComponent);
-    Player* player = playerComponent ? playerComponent->getPlayer() : nullptr;
-    if (player) {
-        //Add to player energy pool
-        if (0 < energyGeneration) {
-            player->energyGeneration += energyGeneration;
-        }
+}
+
+void EnergyComponent::entityChanged(entity_changes_t changes) {
+    updateEnergyLedger();
+}
+
+void EnergyComponent::saveState(SaveWriter& writer) {
+    writer.write<bool>(energySatisfied);
+}
 
-        //Use energy from player energy pool
-        satisfied = player->energyPool >= energyRequirement;
-        if (0 < energyRequirement && satisfied) {
-            player->energyPool -= energyRequirement;
+void EnergyComponent::loadState(SaveReader& reader) {
+    energySatisfied = reader.read<bool>();
+}
+
+void EnergyComponent::updateEnergyLedger() {
+    Player* player = nullptr;
+    if (base->isActive()) {
+        PlayerComponent* playerComponent = GET_COMPONENT_DYNAMIC(base, PlayerComponent);
+        player = playerComponent ? playerComponent->getPlayer() : nullptr;
+    }
+
+    //Move to the new player ledger, both ledgers are recomputed in their next update
+    if (energyPlayer != player) {
+        if (energyPlayer) {
+            energyPlayer->removeEnergyEntity(base->getID());
+        }
+        energyPlayer = player;
+        if (energyPlayer) {
+            energyPlayer->addEnergyEntity(base->getID(), this);
+        } else {
+            setEnergySatisfied(false);
         }
+    } else if (energyPlayer) {
+        energyPlayer->energyChanged();
     }
+}
+
+bool EnergyComponent::isEnergyActive() {
+    return !base->isDisable() && (!base->hasHealth() || 0 < base->getCurrentHealth());
+}
+
+entity_energy_t EnergyComponent::getEnergyGenerated() {
+    return isEnergyActive() ? energyGeneration : 0;
+}
+
+entity_energy_t EnergyComponent::getEnergyRequired() const {
+    return energyRequirement;
+}
+
+int EnergyComponent::getEnergyPriority() const {
+    return energyPriority;
+}
 
-    //Set state
+bool EnergyComponent::isEnergySatisfied() const {
+    return energySatisfied;
+}
+
+void EnergyComponent::setEnergySatisfied(bool satisfied) {
     if (energySatisfied != satisfied) {
-        base->changesCount++;
         energySatisfied = satisfied;
+        base->markChanged(ENTITY_CHANGE_ENERGY);
     }
 }
-
-void EnergyComponent::entityChanged() {
-}
\ No newline at end of file
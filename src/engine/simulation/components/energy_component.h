@@ -7,9 +7,12 @@
 #include "component.h"
 
 class Entity;
+class Player;
 
 /**
  * Component that provides power usage and generation across entities
+ *
+ * Entities are registered in their player energy ledger which decides if they are satisfied only when something changes
  */
 class EnergyComponent {
 CLASS_COMPONENT(Entity, EnergyComponent)
@@ -20,9 +23,51 @@ protected:
     /** The power requirement for this entity */
     entity_energy_t energyRequirement = 0;
 
+    /** Priority of this entity when player energy is not enough for all, higher ones are satisfied first */
+    int energyPriority = 0;
+
     /** True if the player has enough energy to satisfy this entity power requirements */
     bool energySatisfied = false;
+
+    /** Player which energy ledger has this entity registered */
+    Player* energyPlayer = nullptr;
+
+    /**
+     * Registers this entity in current player energy ledger or notifies the ledger about changes
+     */
+    void updateEnergyLedger();
 public:
+    /**
+     * @return true if entity can generate or use energy, disabled or dead entities can't
+     */
+    bool isEnergyActive();
+
+    /**
+     * @return energy currently generated by this entity
+     */
+    entity_energy_t getEnergyGenerated();
+
+    /**
+     * @return energy required by this entity to be satisfied
+     */
+    entity_energy_t getEnergyRequired() const;
+
+    /**
+     * @return priority of this entity when distributing player energy
+     */
+    int getEnergyPriority() const;
+
+    /**
+     * @return true if the player has enough energy to satisfy this entity power requirements
+     */
+    bool isEnergySatisfied() const;
+
+    /**
+     * Sets if energy requirements are satisfied, called by player energy ledger
+     *
+     * @param satisfied state to set
+     */
+    void setEnergySatisfied(bool satisfied);
 };
 
 
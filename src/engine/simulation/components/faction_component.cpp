@@ -4,6 +4,8 @@
 #include "src/engine/entities/entity_config.h"
 #include "engine/simulation/simulation.h"
 #include "engine/simulation/player.h"
+#include "engine/simulation/faction.h"
+#include "engine/simulation/save_stream.h"
 #include "player_component.h"
 #include "faction_component.h"
 
@@ -31,7 +33,16 @@ void FactionComponent::simulationChanged() {
 void FactionComponent::update() {
 }
 
-void FactionComponent::entityChanged() {
+void FactionComponent::entityChanged(entity_changes_t changes) {
+}
+
+void FactionComponent::saveState(SaveWriter& writer) {
+    writer.write<faction_id_t>(faction ? faction->id : 0);
+}
+
+void FactionComponent::loadState(SaveReader& reader) {
+    faction_id_t factionId = reader.read<faction_id_t>();
+    setFaction(factionId ? base->getSimulation()->getFaction(factionId) : nullptr);
 }
 
 Faction* FactionComponent::getFaction() {
@@ -2,7 +2,7 @@
 // Created by Ion Agorria on 08/08/19
 //
 #include "src/engine/entities/entity_config.h"
-#include "engine/graphics/animation.h"
+#include "engine/simulation/render_snapshot.h"
 #include "image_component.h"
 
 CLASS_COMPONENT_DEFAULT(ImageComponent)
@@ -14,56 +14,123 @@ void ImageComponent::simulationChanged() {
 }
 
 void ImageComponent::update() {
-    if (animationPlay && animation) {
-        if (animation->update(GAME_DELTA)) {
-            image = animation->getCurrentFrame();
-            if (image) {
-                image->getRectangle().getSize(imageSize);
-            }
-        }
-    }
 }
 
-void ImageComponent::entityChanged() {
+void ImageComponent::entityChanged(entity_changes_t changes) {
+}
+
+void ImageComponent::saveState(SaveWriter& writer) {
 }
 
-void ImageComponent::draw(Renderer* renderer) {
-    if (image) {
-        Vector2 position = base->getPosition();
-        position += imageOffset;
-        Vector2 size = imageSize;
-        if (imageFlipX) size.x *= -1;
-        if (imageFlipY) size.y *= -1;
-        if (imageCentered) {
-            renderer->drawImageCenter(position, size, imageDirection, *image, extraPalette.get());
+void ImageComponent::loadState(SaveReader& reader) {
+}
+
+void ImageComponent::snapshot(RenderSnapshot& snapshot) const {
+    Image* current = getImage();
+    if (current) {
+        RenderSnapshotSprite& sprite = snapshot.addSprite();
+        sprite.image = current;
+        sprite.palette = extraPalette;
+        sprite.offset.set(imageOffset);
+        if (current == image) {
+            sprite.size.set(imageSize);
         } else {
-            renderer->drawImage(position, size, *image, extraPalette.get());
+            current->getRectangle().getSize(sprite.size);
         }
-
-        /*
-        Rectangle rect(position, size);
-        if (imageCentered) rect.setCenter(position, size);
-        renderer->drawRectangle(rect, 1, Color::GREEN);
-        //*/
+        if (imageFlipX) sprite.size.x *= -1;
+        if (imageFlipY) sprite.size.y *= -1;
+        sprite.angle = imageDirection;
+        sprite.centered = imageCentered;
     }
 }
 
 Image* ImageComponent::getImage() const {
+    //Pick the animation frame of this tick
+    if (animation && !animation->images.empty()) {
+        bool backwards;
+        return animation->images[getAnimationIndex(backwards)];
+    }
     return image;
 }
 
 Palette* ImageComponent::getImagePalette() const {
-    return image ? image->getPalette().get() : nullptr;
+    Image* current = getImage();
+    return current ? current->getPalette().get() : nullptr;
 }
 
-Animation* ImageComponent::getAnimation() const {
-    return animation.get();
+const SpriteGroup* ImageComponent::getAnimation() const {
+    return animation;
+}
+
+uint64_t ImageComponent::getCurrentTick() const {
+    Simulation* simulation = base->getSimulation();
+    return simulation ? simulation->getTick() : 0;
+}
+
+size_t ImageComponent::getAnimationIndex(bool& backwards) const {
+    backwards = hasAnimationFlag(ANIMATION_FLAG_REVERSE);
+    size_t size = animation ? animation->images.size() : 0;
+    if (size <= 1) {
+        return 0;
+    }
+
+    //Amount of frames passed since start
+    uint64_t ticks = isAnimationPlay() ? getCurrentTick() - animationTick : animationTick;
+    uint64_t step = 0;
+    if (0 < animation->duration) {
+        step = ticks * GAME_DELTA / static_cast<uint64_t>(animation->duration);
+    }
+    if (hasAnimationFlag(ANIMATION_FLAG_PINGPONG)) {
+        //Go to end and come back without repeating the ends
+        step %= (size - 1) * 2;
+        if (size - 1 <= step) {
+            step -= size - 1;
+            backwards = !backwards;
+        }
+    } else if (animation->loop) {
+        step %= size;
+    } else if (size - 1 < step) {
+        step = size - 1;
+    }
+    return backwards ? size - 1 - static_cast<size_t>(step) : static_cast<size_t>(step);
+}
+
+bool ImageComponent::isAnimationPlay() const {
+    return hasAnimationFlag(ANIMATION_FLAG_PLAY);
+}
+
+void ImageComponent::setAnimationPlay(bool play) {
+    if (isAnimationPlay() == play) {
+        return;
+    }
+    //Convert between start tick and played ticks so paused animation resumes where it was
+    animationTick = getCurrentTick() - animationTick;
+    if (play) {
+        BIT_ON(animationFlags, ANIMATION_FLAG_PLAY);
+    } else {
+        BIT_OFF(animationFlags, ANIMATION_FLAG_PLAY);
+    }
+}
+
+bool ImageComponent::hasAnimationFlag(animation_flags_t flag) const {
+    return BIT_STATE(animationFlags, flag);
+}
+
+void ImageComponent::setAnimationFlag(animation_flags_t flag, bool state) {
+    if (flag == ANIMATION_FLAG_PLAY) {
+        setAnimationPlay(state);
+    } else if (state) {
+        BIT_ON(animationFlags, flag);
+    } else {
+        BIT_OFF(animationFlags, flag);
+    }
 }
 
 void ImageComponent::setImageFromSprite(const std::string& code) {
     const EntityConfig* config = base->getConfig();
     SpriteGroup* group = config ? config->getSprite(code) : nullptr;
     if (group && !group->images.empty()) {
+        animation = nullptr;
         image = group->images.at(0);
         if (image) {
             image->getRectangle().getSize(imageSize);
@@ -75,12 +142,10 @@ void ImageComponent::setAnimationFromSprite(const std::string& code, bool restar
     const EntityConfig* config = base->getConfig();
     SpriteGroup* group = config ? config->getSprite(code) : nullptr;
     if (group) {
-        animation = std::make_unique<Animation>();
-        animation->duration = group->duration;
-        animation->loop = group->loop;
-        animation->setFrames(group->images);
-        if (restart) {
-            animation->setCurrentIndex(0);
+        //Frames are referenced from sprite group, only the start is stored
+        if (restart || !animation) {
+            animationTick = isAnimationPlay() ? getCurrentTick() : 0;
         }
+        animation = group;
     }
-}
\ No newline at end of file
+}
@@ -5,29 +5,47 @@
 #define OPENE2140_IMAGE_COMPONENT_H
 
 #include "engine/graphics/renderer.h"
-#include "engine/graphics/animation.h"
 #include "engine/graphics/palette.h"
 #include "engine/simulation/simulation.h"
 #include "image_component.h"
 
 class Entity;
 class Image;
+class RenderSnapshot;
+struct SpriteGroup;
 
 /**
  * Contains animation and extra palette drawing
+ *
+ * Animations don't advance per entity, the frame is computed from simulation tick when captured for drawing
  */
 class ImageComponent {
 CLASS_COMPONENT(Entity, ImageComponent)
 protected:
     /**
-     * Image to draw from animation
+     * Image to draw when there is no animation
      */
     Image* image = nullptr;
 
     /**
-     * Animation to draw in component
+     * Sprite group which frames are animated, shared by all entities using the same sprite
      */
-    std::unique_ptr<Animation> animation;
+    const SpriteGroup* animation = nullptr;
+
+    /**
+     * Simulation tick when animation started playing, or ticks already played while paused
+     */
+    uint64_t animationTick = 0;
+
+    /**
+     * Animation state flags
+     */
+    animation_flags_t animationFlags = ANIMATION_FLAG_PLAY;
+
+    /**
+     * @return current simulation tick or 0 if not in simulation
+     */
+    uint64_t getCurrentTick() const;
 
 public:
     /**
@@ -41,7 +59,7 @@ public:
     Vector2 imageOffset;
 
     /**
-     * Image size
+     * Image size when there is no animation, animation frames use their own size
      */
     Vector2 imageSize;
 
@@ -66,19 +84,14 @@ public:
     std::shared_ptr<Palette> extraPalette;
 
     /**
-     * Animation play state
-     */
-    bool animationPlay = true;
-
-    /**
-     * Draws this component
+     * Captures the current image of this component into snapshot
      *
-     * @param renderer
+     * @param snapshot to add the sprite
      */
-    void draw(Renderer* renderer);
+    void snapshot(RenderSnapshot& snapshot) const;
 
     /**
-     * @return current image in component if any
+     * @return current image in component if any, which is the frame at current tick if animated
      */
     Image* getImage() const;
 
@@ -88,9 +101,42 @@ public:
     Palette* getImagePalette() const;
 
     /**
-     * @return animation in component
+     * @return sprite group of animation in component if any
+     */
+    const SpriteGroup* getAnimation() const;
+
+    /**
+     * Calculates the animation frame index at current tick
+     *
+     * @param backwards set to true if frames are currently played backwards
+     * @return index of frame in animation
+     */
+    size_t getAnimationIndex(bool& backwards) const;
+
+    /**
+     * @return true if animation is playing
+     */
+    bool isAnimationPlay() const;
+
+    /**
+     * Sets if animation is playing, paused animations keep their current frame
+     *
+     * @param play state to set
+     */
+    void setAnimationPlay(bool play);
+
+    /**
+     * @return true if animation has the flag set
+     */
+    bool hasAnimationFlag(animation_flags_t flag) const;
+
+    /**
+     * Sets or clears animation flag that changes how frames are played
+     *
+     * @param flag to change
+     * @param state to set
      */
-    Animation* getAnimation() const;
+    void setAnimationFlag(animation_flags_t flag, bool state);
 
     /**
      * Sets the image from sprite
@@ -103,7 +149,7 @@ public:
      * Sets the animation from sprite
      *
      * @param code sprite to set
-     * @param restart resets the animation to 0
+     * @param restart starts animation again from first frame
      */
     void setAnimationFromSprite(const std::string& code, bool restart = true);
 };
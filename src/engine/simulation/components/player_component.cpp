@@ -1,6 +1,10 @@
 //
 // Created by Ion Agorria on 13/06/19
 //
+#include "engine/simulation/simulation.h"
+#include "engine/simulation/entity.h"
+#include "engine/simulation/player.h"
+#include "engine/simulation/save_stream.h"
 #include "player_component.h"
 
 CLASS_COMPONENT_DEFAULT(PlayerComponent)
@@ -14,7 +18,16 @@ void PlayerComponent::simulationChanged() {
 void PlayerComponent::update() {
 }
 
-void PlayerComponent::entityChanged() {
+void PlayerComponent::entityChanged(entity_changes_t changes) {
+}
+
+void PlayerComponent::saveState(SaveWriter& writer) {
+    writer.write<player_id_t>(player ? player->id : 0);
+}
+
+void PlayerComponent::loadState(SaveReader& reader) {
+    player_id_t playerId = reader.read<player_id_t>();
+    setPlayer(playerId ? base->getSimulation()->getPlayer(playerId) : nullptr);
 }
 
 Player* PlayerComponent::getPlayer() {
@@ -22,5 +35,8 @@ Player* PlayerComponent::getPlayer() {
 }
 
 void PlayerComponent::setPlayer(Player* newPlayer) {
-    this->player = newPlayer;
+    if (this->player != newPlayer) {
+        this->player = newPlayer;
+        base->markChanged(ENTITY_CHANGE_PLAYER);
+    }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "engine/simulation/entity.h"
 #include "src/engine/entities/entity_config.h"
+#include "engine/simulation/save_stream.h"
 #include "rotation_component.h"
 
 CLASS_COMPONENT_DEFAULT(RotationComponent)
@@ -17,12 +18,27 @@ void RotationComponent::simulationChanged() {
 }
 
 void RotationComponent::update() {
+}
+
+void RotationComponent::updateIntegrate() {
     if (rotationSpeed != 0 && !isTargetDirection()) {
         base->setDirection(getDeltaDirection());
     }
 }
 
-void RotationComponent::entityChanged() {
+bool RotationComponent::hasPendingWork() {
+    return rotationSpeed != 0 && !isTargetDirection();
+}
+
+void RotationComponent::entityChanged(entity_changes_t changes) {
+}
+
+void RotationComponent::saveState(SaveWriter& writer) {
+    writer.write<number_t>(targetDirection);
+}
+
+void RotationComponent::loadState(SaveReader& reader) {
+    targetDirection = reader.read<number_t>();
 }
 
 /**
@@ -42,7 +58,7 @@ number_t RotationComponent::getDeltaDirection() {
 
 void RotationComponent::setTargetDirection(number_t newDirection) {
     targetDirection = number_wrap_angle(newDirection);
-    base->changesCount++;
+    base->markChanged(ENTITY_CHANGE_ROTATION);
 }
 
 number_t RotationComponent::getTargetDirection() {
@@ -55,7 +71,7 @@ bool RotationComponent::isTargetDirection() {
 
 void RotationComponent::setRotationSpeed(number_t newRotationSpeed) {
     rotationSpeed = newRotationSpeed;
-    base->changesCount++;
+    base->markChanged(ENTITY_CHANGE_ROTATION);
 }
 
 number_t RotationComponent::getRotationSpeed() {
@@ -31,6 +31,16 @@ public:
      */
     number_t getDeltaDirection();
 
+    /**
+     * Turns entity towards target direction
+     */
+    void updateIntegrate();
+
+    /**
+     * @return true if entity is still turning
+     */
+    bool hasPendingWork();
+
     /**
      * Set entity target direction
      *
@@ -5,6 +5,8 @@
 #include "engine/entities/entity_config.h"
 #include "engine/simulation/world/tile.h"
 #include "engine/simulation/entity_store.h"
+#include "engine/simulation/save_stream.h"
+#include "engine/simulation/world/world.h"
 #include "entity.h"
 
 Entity::Entity() = default;
@@ -41,9 +43,17 @@ const Vector2& Entity::getPosition() const {
 }
 
 void Entity::setPosition(const Vector2& newPosition) {
+    uint64_t oldBits = getPositionBits();
     position.set(newPosition);
+    if (simulation) {
+        simulation->getStateHash().update(StateHashField::EntityPosition, id, oldBits, getPositionBits());
+    }
     bounds.setCenter(newPosition);
-    changesCount++;
+    markChanged(ENTITY_CHANGE_POSITION);
+}
+
+const Vector2& Entity::getLastPosition() const {
+    return lastPosition;
 }
 
 entity_direction_t Entity::getDirection() const {
@@ -51,8 +61,15 @@ entity_direction_t Entity::getDirection() const {
 }
 
 void Entity::setDirection(entity_direction_t newDirection) {
+    entity_direction_t oldDirection = direction;
     direction = number_wrap_angle(newDirection);
-    changesCount++;
+    if (simulation) {
+        simulation->getStateHash().update(
+                StateHashField::EntityDirection, id,
+                StateHash::toBits(oldDirection), StateHash::toBits(direction)
+        );
+    }
+    markChanged(ENTITY_CHANGE_DIRECTION);
 }
 
 const Rectangle& Entity::getBounds() const {
@@ -61,13 +78,13 @@ const Rectangle& Entity::getBounds() const {
 
 void Entity::setBounds(const Vector2& newBounds) {
     bounds.setCenter(position, newBounds);
-    changesCount++;
+    markChanged(ENTITY_CHANGE_POSITION);
 }
 
 void Entity::setMaxHealth(entity_health_t newHealth) {
-    if (newHealth < currentHealth) currentHealth = newHealth;
+    if (newHealth < currentHealth) setCurrentHealth(newHealth);
     maxHealth = newHealth;
-    changesCount++;
+    markChanged(ENTITY_CHANGE_HEALTH);
 }
 
 entity_health_t Entity::getMaxHealth() {
@@ -76,8 +93,14 @@ entity_health_t Entity::getMaxHealth() {
 
 void Entity::setCurrentHealth(entity_health_t newHealth) {
     if (maxHealth < newHealth) newHealth = maxHealth;
+    if (simulation) {
+        simulation->getStateHash().update(
+                StateHashField::EntityHealth, id,
+                StateHash::toBits(currentHealth), StateHash::toBits(newHealth)
+        );
+    }
     currentHealth = newHealth;
-    changesCount++;
+    markChanged(ENTITY_CHANGE_HEALTH);
 }
 
 entity_health_t Entity::getCurrentHealth() {
@@ -118,7 +141,7 @@ Simulation* Entity::getSimulation() const {
 
 void Entity::setParent(Entity* entity) {
     parent = entity;
-    changesCount++;
+    markChanged(ENTITY_CHANGE_ATTACHMENT);
 }
 
 Entity* Entity::getParent() const {
@@ -128,40 +151,151 @@ Entity* Entity::getParent() const {
 void Entity::addedToSimulation(entity_id_t entityID, Simulation* sim) {
     id = entityID;
     simulation = sim;
-    renderer = simulation->getRenderer();
     active = true;
     bounds.set(config->bounds);
+    lastPosition.set(position);
+    toggleStateHash();
     simulationChanged();
+    //Notify everything on first update so components start from current state
+    markChanged(ENTITY_CHANGE_ALL);
 }
 
 void Entity::removedFromSimulation() {
     active = false;
     simulationChanged();
     clearTiles();
-    renderer = nullptr;
+    toggleStateHash();
     simulation = nullptr;
+    sleeping = true;
+    pendingChanges = 0;
     id = 0;
 }
 
+void Entity::toggleStateHash() {
+    if (!simulation) {
+        return;
+    }
+    StateHash& stateHash = simulation->getStateHash();
+    stateHash.toggle(StateHashField::EntityPosition, id, getPositionBits());
+    stateHash.toggle(StateHashField::EntityDirection, id, StateHash::toBits(direction));
+    stateHash.toggle(StateHashField::EntityHealth, id, StateHash::toBits(currentHealth));
+}
+
+uint64_t Entity::getPositionBits() const {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(position.x)) << 32) | static_cast<uint32_t>(position.y);
+}
+
+void Entity::saveState(SaveWriter& writer) {
+    writer.write<int32_t>(position.x);
+    writer.write<int32_t>(position.y);
+    writer.write<entity_direction_t>(direction);
+    writer.write<entity_health_t>(maxHealth);
+    writer.write<entity_health_t>(currentHealth);
+    writer.write<bool>(disable);
+    writer.write<bool>(selectable);
+    writer.write<uint32_t>(static_cast<uint32_t>(tiles.size()));
+    for (Tile* tile : tiles) {
+        writer.write<tile_index_t>(tile->index);
+    }
+
+    //Components are written in a block so a mismatch doesn't corrupt the rest of save
+    writer.beginBlock();
+    componentsSaveState(writer);
+    writer.endBlock();
+}
+
+void Entity::loadState(SaveReader& reader) {
+    Vector2 newPosition;
+    newPosition.x = reader.read<int32_t>();
+    newPosition.y = reader.read<int32_t>();
+    setPosition(newPosition);
+    lastPosition.set(position);
+    setDirection(reader.read<entity_direction_t>());
+    setMaxHealth(reader.read<entity_health_t>());
+    setCurrentHealth(reader.read<entity_health_t>());
+    setDisable(reader.read<bool>());
+    setSelectable(reader.read<bool>());
+
+    //Place entity in tiles
+    clearTiles();
+    std::shared_ptr<Entity> entityPtr = getEntityPtr();
+    World* world = simulation->getWorld();
+    uint32_t tilesCount = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < tilesCount && !reader.hasError(); ++i) {
+        Tile* tile = world->getTile(reader.read<tile_index_t>());
+        if (tile) {
+            tile->addEntity(entityPtr, false);
+        }
+    }
+
+    reader.beginBlock();
+    componentsLoadState(reader);
+    reader.endBlock();
+}
+
 void Entity::simulationChanged() {
     componentsSimulationChanged();
 }
 
+void Entity::updatePlan() {
+    lastPosition.set(position);
+    componentsUpdatePlan();
+}
+
+void Entity::updateIntegrate() {
+    componentsUpdateIntegrate();
+}
+
+void Entity::updateAnimate() {
+    componentsUpdateAnimate();
+}
+
 void Entity::update() {
     componentsUpdate();
 
-    //Check if anything changed to update sprite
-    if (lastChangesCount != changesCount) {
-        lastChangesCount = changesCount;
-        entityChanged();
+    //Notify changes batched since last update, changes done while notifying are handled in next update
+    if (pendingChanges) {
+        entity_changes_t changes = pendingChanges;
+        pendingChanges = 0;
+        entityChanged(changes);
+    }
+}
+
+void Entity::entityChanged(entity_changes_t changes) {
+    componentsEntityChanged(changes);
+}
+
+void Entity::markChanged(entity_changes_t changes) {
+    pendingChanges |= changes;
+    wake();
+}
+
+bool Entity::hasPendingWork() {
+    //Position before update must catch up or drawing would keep interpolating between them
+    return pendingChanges != 0 || lastPosition != position || componentsHasPendingWork();
+}
+
+bool Entity::isSleeping() const {
+    return sleeping;
+}
+
+void Entity::wake() {
+    if (parent) {
+        parent->wake();
+        return;
+    }
+    //Entities being updated are awake already, so only the commit phase or outside updates reach the simulation
+    if (sleeping && simulation) {
+        sleeping = false;
+        simulation->wakeEntity(this);
     }
 }
 
-void Entity::entityChanged() {
-    componentsEntityChanged();
+void Entity::sleep() {
+    sleeping = true;
 }
 
-void Entity::draw() {
+void Entity::snapshot(RenderSnapshot& snapshot) {
 }
 
 bool Entity::isActive() const {
@@ -174,7 +308,7 @@ bool Entity::isDisable() const {
 
 void Entity::setDisable(bool newDisable) {
     disable = newDisable;
-    changesCount++;
+    markChanged(ENTITY_CHANGE_SELECTION);
 }
 
 bool Entity::isSelectable() const {
@@ -183,7 +317,7 @@ bool Entity::isSelectable() const {
 
 void Entity::setSelectable(bool newSelectable) {
     selectable = newSelectable;
-    changesCount++;
+    markChanged(ENTITY_CHANGE_SELECTION);
 }
 
 Tile* Entity::getTile() {
@@ -199,10 +333,12 @@ std::vector<Tile*>& Entity::getTiles() {
 }
 
 void Entity::clearTiles() {
-    for (Tile* tile : tiles) {
+    //Tiles remove themselves from our tiles when removing entity, so iterate over the old list
+    std::vector<Tile*> oldTiles;
+    oldTiles.swap(tiles);
+    for (Tile* tile : oldTiles) {
         tile->removeEntity(id);
     }
-    tiles.clear();
 }
 
 std::string Entity::toStringContent() const {
@@ -15,9 +15,9 @@ class Simulation;
 class Renderer;
 class EntityConfig;
 class Entity;
+class RenderSnapshot;
 
 using entity_ptr = std::shared_ptr<Entity>;
-using entity_changes_count_t = uint16_t;
 
 /**
  * Base entity in game, this is the common interface between world and entities
@@ -40,14 +40,14 @@ protected:
     Simulation* simulation = nullptr;
 
     /**
-     * Renderer to use when drawing this entity
+     * Entity center position
      */
-    Renderer* renderer = nullptr;
+    Vector2 position;
 
     /**
-     * Entity center position
+     * Entity center position before last update, used to interpolate drawing between updates
      */
-    Vector2 position;
+    Vector2 lastPosition;
 
     /**
      * Entity direction which is facing
@@ -89,27 +89,40 @@ protected:
      */
     bool selectable = false;
 
+    /**
+     * Flag for sleeping state, sleeping entities are not updated until something wakes them
+     */
+    bool sleeping = true;
+
     /**
      * Parent of this entity which is attached to if any
      */
     Entity* parent = nullptr;
 
     /**
-     * Last changes count since last update
-     * This way we can know when to update
+     * Changes done since last update, notified to subscribed components once in next update
      */
-    entity_changes_count_t lastChangesCount = 0;
+    entity_changes_t pendingChanges = 0;
 
     /**
-     * Add components method forwarding so extended entities can override them
+     * Adds or removes the hashed state of this entity from simulation state hash
      */
-    COMPONENT_METHODS(COMPONENT_METHOD_FORWARD_VIRTUAL)
-public:
+    void toggleStateHash();
+
     /**
-     * Every time a change occurs in entity this count is incremented
+     * @return position packed for state hashing
      */
-    entity_changes_count_t changesCount = 0;
+    uint64_t getPositionBits() const;
 
+    /**
+     * Add components method forwarding so extended entities can override them
+     */
+    COMPONENT_METHODS(COMPONENT_METHOD_FORWARD_VIRTUAL)
+    COMPONENT_HOOK_METHODS(COMPONENT_METHOD_FORWARD_VIRTUAL)
+    COMPONENT_CHANGE_METHODS(COMPONENT_CHANGE_METHOD_FORWARD_VIRTUAL)
+    COMPONENT_STATE_METHODS(COMPONENT_STATE_METHOD_FORWARD_VIRTUAL)
+    COMPONENT_QUERY_METHODS(COMPONENT_QUERY_METHOD_FORWARD_VIRTUAL)
+public:
     /**
      * Required flags for tiles to be possible to move in
      */
@@ -121,6 +134,11 @@ public:
      */
     tile_flags_t entityFlagsMask = 0;
 
+    /**
+     * Size in tiles of the square occupied by this entity, its tile is the top left corner of square
+     */
+    unsigned int footprint = 1;
+
     /**
      * Entity constructor
      */
@@ -164,6 +182,11 @@ public:
      */
     void setPosition(const Vector2& newPosition);
 
+    /**
+     * @return entity position before last update
+     */
+    const Vector2& getLastPosition() const;
+
     /**
      * @return entity direction
      */
@@ -270,19 +293,79 @@ public:
     virtual void simulationChanged();
 
     /**
-     * Updates the entity state
+     * Writes the entity state and its components state
+     *
+     * @param writer to write into
+     */
+    virtual void saveState(SaveWriter& writer);
+
+    /**
+     * Reads the entity state and its components state, entity must be already in simulation
+     *
+     * @param reader to read from
+     */
+    virtual void loadState(SaveReader& reader);
+
+    /**
+     * Plan phase of entity update, can run in parallel with other entities
+     */
+    virtual void updatePlan();
+
+    /**
+     * Integrate phase of entity update, can run in parallel with other entities
+     */
+    virtual void updateIntegrate();
+
+    /**
+     * Animate phase of entity update, can run in parallel with other entities
+     */
+    virtual void updateAnimate();
+
+    /**
+     * Commit phase of entity update which updates the entity state, runs sequentially in entity order
      */
     virtual void update();
 
     /**
-     * Called when entity is changed according to it's hangesCount
+     * Called once per update with the changes done to entity since last update
+     *
+     * @param changes flags of ENTITY_CHANGE_*
+     */
+    virtual void entityChanged(entity_changes_t changes);
+
+    /**
+     * Adds the changes to be notified and wakes entity so they are handled in next update
+     *
+     * @param changes flags of ENTITY_CHANGE_*
+     */
+    void markChanged(entity_changes_t changes);
+
+    /**
+     * @return true if entity must be updated in next tick
+     */
+    bool hasPendingWork();
+
+    /**
+     * @return true if entity is sleeping and not being updated
      */
-    virtual void entityChanged();
+    bool isSleeping() const;
 
     /**
-     * Called when this entity is requested to draw
+     * Wakes entity so it's updated from next tick, attached entities wake their parent which updates them
+     */
+    void wake();
+
+    /**
+     * Stops updating entity until is woken
+     */
+    void sleep();
+
+    /**
+     * Called when this entity is requested to capture the sprites to draw into snapshot
+     *
+     * @param snapshot to add sprites
      */
-    virtual void draw();
+    virtual void snapshot(RenderSnapshot& snapshot);
 
     /**
      * @return true if entity is considered active (has ID and is inside simulation)
@@ -56,6 +56,14 @@ const std::vector<std::shared_ptr<Entity>>& EntityStore::getEntities() const {
     return entities;
 }
 
+entity_id_t EntityStore::getLastEntityID() const {
+    return lastEntityID;
+}
+
+void EntityStore::setLastEntityID(entity_id_t id) {
+    lastEntityID = id;
+}
+
 entity_id_t EntityStore::add(const std::shared_ptr<Entity>& entity) {
     lastEntityID++;
     entities.emplace_back(entity);
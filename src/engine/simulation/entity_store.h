@@ -85,6 +85,18 @@ public:
      */
     const std::vector<std::shared_ptr<Entity>>* getEntitiesByType(const entity_type_t& type) const;
 
+    /**
+     * @return last used entity id
+     */
+    entity_id_t getLastEntityID() const;
+
+    /**
+     * Sets the last used entity id, next added entity will use the following id
+     *
+     * @param id to set
+     */
+    void setLastEntityID(entity_id_t id);
+
     /**
      * Does insertion to entity store
      *
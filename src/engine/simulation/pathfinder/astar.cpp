@@ -1,20 +1,51 @@
 //
 // Created by Ion Agorria on 13/06/19
 //
+#include "engine/core/profiler.h"
 #include "engine/simulation/world/world.h"
 #include "astar.h"
 #include "path_request.h"
 
-AStar::AStar(PathRequest* request, tile_flags_t tileFlagsRequired):
+/**
+ * @return log for pathfinders, obtained once so visits don't lookup it
+ */
+static const log_ptr& getAStarLog() {
+    static const log_ptr log = Log::get("AStar");
+    return log;
+}
+
+AStar::AStar(PathRequest* request, entity_id_t entity, tile_flags_t tileFlagsRequired, unsigned int footprint):
 request(request),
-tileFlagsRequired(tileFlagsRequired) {
+entity(entity),
+tileFlagsRequired(tileFlagsRequired),
+footprint(footprint) {
     queue.getComparator().astar = this;
+    heuristic = request->getArenas().costs.acquire();
+    vertexes = request->getArenas().vertexes.acquire();
+}
+
+AStar::~AStar() {
+    request->getArenas().costs.release(std::move(heuristic));
+    request->getArenas().vertexes.release(std::move(vertexes));
 }
 
 void AStar::initialize() {
     queue.clear();
-    heuristic.clear();
-    heuristic.resize(request->getVertexes().size(), PATHFINDER_INFINITY);
+    closest = nullptr;
+    heuristic->reset(request->getVertexesCount(), PATHFINDER_INFINITY);
+    vertexes->reset(request->getVertexesCount(), PathVertex());
+}
+
+PathVertex& AStar::getVertex(tile_index_t index) {
+    PathVertex& vertex = (*vertexes)[index];
+    vertex.index = index;
+    return vertex;
+}
+
+PathVertex AStar::getVertex(tile_index_t index) const {
+    PathVertex vertex = vertexes->get(index);
+    vertex.index = index;
+    return vertex;
 }
 
 void AStar::plan(Tile* newStart, Tile* newGoal, tile_flags_t newEntityFlagsMask, tile_index_t newEntityTileIndex) {
@@ -31,41 +62,45 @@ void AStar::plan(Tile* newStart, Tile* newGoal, tile_flags_t newEntityFlagsMask,
     goal = newGoal;
     entityFlagsMask = newEntityFlagsMask;
     entityTileIndex = newEntityTileIndex;
+    layer = &request->getWorld()->getPassability()->getLayer(tileFlagsRequired, entityFlagsMask);
     status = PathFinderStatus::Computing;
 
-    //Check if by chance goal was already found previously and is not stale
-    PathVertex* vertex = &request->getVertexes().at(goal->index);
-    if (staleVertex(*vertex, goal)) {
-        //Check if start node is occupied, since it's not checked later
-        if (isOccupied(start)) {
-            return;
-        }
-        //Add start vertex to start path finding
-        vertex = &request->getVertexes().at(start->index);
-        calculateHeuristic(start);
-        vertex->l = start->entityFlags;
-        vertex->g = 0;
-        vertex->back = vertex->index;
+    //Check if start node is occupied, since it's not checked later
+    if (isOccupied(start)) {
+        return;
     }
+
+    //Add start vertex to start path finding, vertexes are reset on each plan so search starts from entity
+    PathVertex* vertex = &getVertex(start->index);
+    calculateHeuristic(start);
+    vertex->l = start->entityFlags;
+    vertex->g = 0;
+    vertex->back = vertex->index;
     queue.push(vertex);
 }
 
-void AStar::compute() {
+void AStar::fail() {
+    queue.clear();
+    closest = nullptr;
+    status = PathFinderStatus::Fail;
+}
+
+size_t AStar::compute(size_t maxSteps) {
+    PROFILE_ZONE("AStar::compute");
     if (status != PathFinderStatus::Computing) {
-        return;
+        return 0;
     }
     World* world = request->getWorld();
-    std::vector<PathVertex>& vertexes = request->getVertexes();
-    if (!world || vertexes.empty()) {
-        return;
+    if (!world || request->getVertexesCount() == 0) {
+        return 0;
     }
 
     //Get the top vertex to scan next and visit it until enough steps are done
     size_t steps = 0;
-    while (!queue.empty() && steps < ASTAR_MAX_STEPS) {
+    while (!queue.empty() && steps < maxSteps) {
         PathVertex vertex = *queue.top();
         queue.pop();
-        visitTile(world, vertexes, vertex);
+        visitTile(world, vertex);
         steps++;
     }
 
@@ -77,26 +112,14 @@ void AStar::compute() {
             status = PathFinderStatus::Fail;
         }
     }
-}
-
 
-void AStar::visitTile(const World* world, std::vector<PathVertex>& vertexes, PathVertex& vertex) {
-    tile_index_t vertexIndex = vertex.index;
-    tile_index_t goalIndex = goal->index;
-    Tile* tile = world->getTile(vertexIndex);
-    log_ptr log = Log::get("A* "+std::to_string(start->index)+" "+std::to_string(goalIndex));
-    log->debug("VISIT " + tile->toString());
+    return steps;
+}
 
-    //Add as closest if it's the case
-    if (!closest || heuristic[closest->index] > heuristic[vertexIndex]) {
-        closest = tile;
-    }
 
-    //Check if it's the goal
-    if (vertexIndex == goalIndex) {
-        status = PathFinderStatus::Success;
-        queue.clear();
-        log->debug("FOUND " + tile->toString());
+void AStar::visitTile(const World* world, PathVertex& vertex) {
+    Tile* tile = world->getTile(vertex.index);
+    if (reachTile(tile)) {
         return;
     }
 
@@ -109,33 +132,60 @@ void AStar::visitTile(const World* world, std::vector<PathVertex>& vertexes, Pat
         }
 
         //Check if tile should be skipped, we want goal to be visited even if occupied
-        if (adjacentIndex != goalIndex && isOccupied(adjacentTile)) {
+        if (adjacentIndex != goal->index && isOccupied(adjacentTile)) {
             continue;
         }
 
-        //Calculate G cost + accumulated previous cost
-        path_cost_t g = vertex.g;
-        g += adjacentTile->position.distanceSquared(tile->position);
-
-        //Check if adjacent vertex should be updated if lower G than currently has
-        //(because a shorter route has been found) or vertex is stale
-        PathVertex& adjacentVertex = vertexes[adjacentIndex];
-        if (g < adjacentVertex.g || staleVertex(adjacentVertex, adjacentTile)) {
-            adjacentVertex.g = g;
-            adjacentVertex.l = adjacentTile->entityFlags;
-            adjacentVertex.back = vertexIndex;
-        }
+        addSuccessor(vertex, adjacentTile, adjacentTile->position.distanceSquared(tile->position));
+    }
+}
 
-        //Check if we should add vertex to visit queue
-        if (heuristic[adjacentIndex] == PATHFINDER_INFINITY) {
-            calculateHeuristic(adjacentTile);
-            queue.push(&adjacentVertex);
-        }
+bool AStar::reachTile(Tile* tile) {
+    tile_index_t goalIndex = goal->index;
+    LOG_DEBUG_TO(getAStarLog(), "{0}->{1} VISIT {2}", start->index, goalIndex, tile->toString());
+
+    //Add as closest if it's the case
+    if (!closest || (*heuristic)[closest->index] > (*heuristic)[tile->index]) {
+        closest = tile;
+    }
+
+    //Check if it's the goal
+    if (tile->index == goalIndex) {
+        status = PathFinderStatus::Success;
+        queue.clear();
+        LOG_DEBUG_TO(getAStarLog(), "{0}->{1} FOUND {2}", start->index, goalIndex, tile->toString());
+        return true;
+    }
+    return false;
+}
+
+void AStar::addSuccessor(const PathVertex& vertex, Tile* successor, path_cost_t cost) {
+    //Calculate G cost + accumulated previous cost, tiles reserved by others cost more so short detours are taken
+    tile_index_t successorIndex = successor->index;
+    path_cost_t g = vertex.g + cost + request->getReservationCost(successor, entity);
+
+    //Check if successor vertex should be updated if lower G than currently has
+    //(because a shorter route has been found) or vertex is stale
+    PathVertex& successorVertex = getVertex(successorIndex);
+    if (g < successorVertex.g || staleVertex(successorVertex, successor)) {
+        successorVertex.g = g;
+        successorVertex.l = successor->entityFlags;
+        successorVertex.back = vertex.index;
+    }
+
+    //Check if we should add vertex to visit queue
+    if ((*heuristic)[successorIndex] == PATHFINDER_INFINITY) {
+        calculateHeuristic(successor);
+        queue.push(&successorVertex);
     }
 }
 
 void AStar::calculateHeuristic(Tile* tile) {
-    heuristic[tile->index] = tile->position.distanceSquared(goal->position);
+    (*heuristic)[tile->index] = tile->position.distanceSquared(goal->position);
+}
+
+bool AStar::isComputing() const {
+    return status == PathFinderStatus::Computing;
 }
 
 PathFinderStatus AStar::getStatus() {
@@ -146,6 +196,27 @@ Tile* AStar::getClosest() {
     return closest;
 }
 
+bool AStar::getPath(std::vector<const Tile*>& path) const {
+    if (!closest) {
+        LOG_BUG("AStar path requested but closest is null");
+        return false;
+    }
+
+    //Construct path by getting each tile in the chain
+    World* world = request->getWorld();
+    PathVertex vertex = getVertex(closest->index);
+    while (true) {
+        Tile* tile = world->getTile(vertex.index);
+        path.push_back(tile);
+        if (vertex.index == vertex.back) {
+            //Reached end
+            break;
+        }
+        vertex = getVertex(vertex.back);
+    }
+    return true;
+}
+
 bool AStar::staleVertex(PathVertex& vertex, Tile* tile) {
     return vertex.g == PATHFINDER_INFINITY //Never visited
         || vertex.l != tile->entityFlags //Flags changed since last visit
@@ -153,13 +224,13 @@ bool AStar::staleVertex(PathVertex& vertex, Tile* tile) {
 }
 
 bool AStar::isOccupied(Tile* tile) {
-    bool tileInvalid = (tile->tileFlags & tileFlagsRequired) != tileFlagsRequired;
-    if (tileInvalid) {
-        return true;
+    if (1 < footprint) {
+        Clearance* clearance = request->getWorld()->getClearance();
+        return !clearance->isClear(tileFlagsRequired, entityFlagsMask, tile, footprint, entityTileIndex);
     }
-    bool entityOccupied = false;
-    if (tile->index != entityTileIndex) {
-        entityOccupied = tile->entityFlags & entityFlagsMask;
+    //Entity tile is occupied by itself so only tile flags matter
+    if (tile->index == entityTileIndex) {
+        return (tile->tileFlags & tileFlagsRequired) != tileFlagsRequired;
     }
-    return entityOccupied;
+    return !layer->isPassable(tile->position.x, tile->position.y);
 }
@@ -4,31 +4,36 @@
 #ifndef OPENE2140_ASTAR_H
 #define OPENE2140_ASTAR_H
 
-#define ASTAR_MAX_STEPS 1000
-
 #include <unordered_map>
 #include <memory>
 
 #include "engine/core/macros.h"
 #include "engine/core/priority_queue.h"
-#include "path_state.h"
+#include "path_finder.h"
 #include "path_vertex.h"
+#include "path_arena.h"
 #include "astar_comparator.h"
 
 class World;
 class PathRequest;
 class Tile;
+struct PassabilityLayer;
 
 /**
  * A* based pathfinder implementation
  */
-class AStar {
+class AStar: public PathFinder {
 protected:
     /**
      * The path request which spawned this pathfinder
      */
     PathRequest* request;
 
+    /**
+     * Entity which this search is for, its own reservations don't add cost
+     */
+    entity_id_t entity;
+
     /**
      * Current pathfinder state
      */
@@ -64,19 +69,67 @@ protected:
      */
     tile_flags_t entityFlagsMask = 0;
 
+    /**
+     * Passable tiles of movement class being searched
+     */
+    const PassabilityLayer* layer = nullptr;
+
     /**
      * Index of tile where entity is located, this allows not considering a tile as occupied by itself
      */
     tile_index_t entityTileIndex;
 
+    /**
+     * Size in tiles of square occupied by entity, tiles are the top left corner of square
+     */
+    unsigned int footprint = 1;
+
+    /**
+     * Vertexes of this search, taken from request arena pool so searches from different entities of same request
+     * don't overwrite each other chains
+     */
+    std::unique_ptr<PathArena<PathVertex>> vertexes;
+
+    /**
+     * Obtains the vertex of this search for the index
+     *
+     * @param index of vertex
+     * @return vertex
+     */
+    PathVertex& getVertex(tile_index_t index);
+
+    /**
+     * Obtains the vertex of this search for the index
+     *
+     * @param index of vertex
+     * @return vertex
+     */
+    PathVertex getVertex(tile_index_t index) const;
+
     /**
      * Tells the pathfinder to visit the vertex
      *
      * @param world pointer of world containing tiles
-     * @param vertexes the vertexes containing vector
      * @param vertex to visit
      */
-    void visitTile(const World* world, std::vector<PathVertex>& vertexes, PathVertex& vertex);
+    virtual void visitTile(const World* world, PathVertex& vertex);
+
+    /**
+     * Handles a tile being visited, updating closest and checking if it's the goal
+     *
+     * @param tile visited
+     * @return true if goal was found
+     */
+    bool reachTile(Tile* tile);
+
+    /**
+     * Updates the successor vertex if reaching it from vertex is cheaper and queues it if was not queued
+     *
+     * @param vertex being visited
+     * @param successor tile
+     * @param cost from vertex to successor, reservation cost of successor is added to it
+     */
+    void addSuccessor(const PathVertex& vertex, Tile* successor, path_cost_t cost);
 
     /**
      * Updates the heuristic value of vertex
@@ -87,44 +140,43 @@ protected:
 
 public:
     /**
-     * Calculated heuristic cost of each tile
+     * Calculated heuristic cost of each tile, taken from request arena pool
      */
-    std::vector<path_cost_t> heuristic;
+    std::unique_ptr<PathArena<path_cost_t>> heuristic;
 
     /**
      * Constructor
      */
-    AStar(PathRequest* request, tile_flags_t tileFlagsRequired);
+    AStar(PathRequest* request, entity_id_t entity, tile_flags_t tileFlagsRequired, unsigned int footprint);
 
     /**
      * Destructor
      */
-    ~AStar() = default;
+    ~AStar() override;
 
-    /**
-     * (re)initializes the internal states to clear state
+    /*
+     * PathFinder
      */
-    void initialize();
 
-    /**
-     * Notifies the pathfinder about the current desired plan
-     *
-     * @param newStarts
-     * @param newGoal
-     * @param newTileFlags
-     * @param entityTileIndex
-     */
-    void plan(Tile* newStart, Tile* newGoal, tile_flags_t newTileFlags, tile_index_t newEntityTileIndex);
+    void initialize() override;
 
-    /**
-     * Does the main computation of algorithm
-     */
-    void compute();
+    void plan(Tile* newStart, Tile* newGoal, tile_flags_t newTileFlags, tile_index_t newEntityTileIndex) override;
+
+    void fail() override;
+
+    size_t compute(size_t maxSteps) override;
+
+    bool isComputing() const override;
+
+    PathFinderStatus getStatus() override;
 
     /**
-     * @return current path finder status
+     * Obtains the chain from closest tile to search start, the order entity needs when search starts from its tile
+     *
+     * @param path vector to write path
+     * @return true if path was written
      */
-    PathFinderStatus getStatus();
+    bool getPath(std::vector<const Tile*>& path) const override;
 
     /**
      * @return closest found tile
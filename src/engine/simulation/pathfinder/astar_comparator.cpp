@@ -7,7 +7,7 @@
 #include "astar_comparator.h"
 
 bool AStarComparator::operator()(PathVertex* v1, PathVertex* v2) {
-    path_cost_t f1 = v1->g + astar->heuristic[v1->index];
-    path_cost_t f2 = v2->g + astar->heuristic[v2->index];
+    path_cost_t f1 = v1->g + astar->heuristic->get(v1->index);
+    path_cost_t f2 = v2->g + astar->heuristic->get(v2->index);
     return f1 > f2;
 }
\ No newline at end of file
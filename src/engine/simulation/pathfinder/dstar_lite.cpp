@@ -0,0 +1,295 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <algorithm>
+#include <cstdlib>
+#include "engine/core/profiler.h"
+#include "engine/simulation/world/world.h"
+#include "dstar_lite.h"
+#include "path_request.h"
+
+/**
+ * Adds costs keeping infinity as is
+ */
+static path_cost_t addCost(path_cost_t a, path_cost_t b) {
+    if (a == PATHFINDER_INFINITY || b == PATHFINDER_INFINITY) {
+        return PATHFINDER_INFINITY;
+    }
+    return a + b;
+}
+
+DStarLite::DStarLite(PathRequest* request, entity_id_t entity, tile_flags_t tileFlagsRequired, unsigned int footprint):
+request(request),
+entity(entity),
+tileFlagsRequired(tileFlagsRequired),
+footprint(footprint) {
+    PathArenaPool<path_cost_t>& costs = request->getArenas().costs;
+    g = costs.acquire();
+    rhs = costs.acquire();
+}
+
+DStarLite::~DStarLite() {
+    PathArenaPool<path_cost_t>& costs = request->getArenas().costs;
+    costs.release(std::move(g));
+    costs.release(std::move(rhs));
+}
+
+path_cost_t DStarLite::heuristic(const Tile* from, const Tile* to) {
+    //Straight moves cost 1 and diagonals 2, so the amount of moves never overestimates
+    int dx = std::abs(from->position.x - to->position.x);
+    int dy = std::abs(from->position.y - to->position.y);
+    return static_cast<path_cost_t>(std::max(dx, dy));
+}
+
+path_cost_t DStarLite::cost(Tile* from, Tile* to) const {
+    if (isOccupied(from) || isOccupied(to)) {
+        return PATHFINDER_INFINITY;
+    }
+    return to->position.distanceSquared(from->position) + request->getReservationCost(to, entity);
+}
+
+DStarLiteEntry DStarLite::calculateKey(const Tile* tile) const {
+    path_cost_t cost = std::min(g->get(tile->index), rhs->get(tile->index));
+    return {
+        addCost(addCost(cost, heuristic(current, tile)), keyModifier),
+        cost,
+        tile->index
+    };
+}
+
+void DStarLite::updateVertex(Tile* tile) {
+    tile_index_t index = tile->index;
+    if (tile != root) {
+        //Occupied tile can't be left nor entered so there is no need to check adjacents
+        path_cost_t best = PATHFINDER_INFINITY;
+        if (!isOccupied(tile)) {
+            for (Tile* adjacent : tile->adjacents) {
+                if (!isOccupied(adjacent)) {
+                    best = std::min(best, addCost(cost(tile, adjacent), g->get(adjacent->index)));
+                }
+            }
+        }
+        (*rhs)[index] = best;
+    }
+    if (g->get(index) != rhs->get(index)) {
+        queue.push(calculateKey(tile));
+    }
+}
+
+void DStarLite::tileChanged(Tile* tile) {
+    //Tiles that search never reached nor touched can't affect the current tree
+    bool reached = g->get(tile->index) != PATHFINDER_INFINITY || rhs->get(tile->index) != PATHFINDER_INFINITY;
+    for (Tile* adjacent : tile->adjacents) {
+        if (reached) break;
+        reached = g->get(adjacent->index) != PATHFINDER_INFINITY;
+    }
+    if (!reached) {
+        return;
+    }
+    repairPending = true;
+    updateVertex(tile);
+    for (Tile* adjacent : tile->adjacents) {
+        updateVertex(adjacent);
+    }
+}
+
+void DStarLite::squareChanged(Tile* tile, int before, int after) {
+    if (before == 0 && after == 0) {
+        tileChanged(tile);
+        return;
+    }
+    World* world = request->getWorld();
+    const Rectangle& rectangle = world->getRealRectangle();
+    const Vector2& position = tile->position;
+    for (int y = position.y - before; y <= position.y + after; ++y) {
+        for (int x = position.x - before; x <= position.x + after; ++x) {
+            if (rectangle.isInside(x, y)) {
+                tileChanged(world->getTile(static_cast<unsigned int>(x), static_cast<unsigned int>(y)));
+            }
+        }
+    }
+}
+
+bool DStarLite::isOccupied(Tile* tile) const {
+    if (tile == current) {
+        return false;
+    }
+    if (1 < footprint) {
+        Clearance* clearance = request->getWorld()->getClearance();
+        return !clearance->isClear(tileFlagsRequired, entityFlagsMask, tile, footprint, current->index);
+    }
+    return !layer->isPassable(tile->position.x, tile->position.y);
+}
+
+void DStarLite::initialize() {
+    size_t size = 0;
+    World* world = request->getWorld();
+    if (world) {
+        size = world->getTiles().size();
+    }
+    queue.clear();
+    g->reset(size, PATHFINDER_INFINITY);
+    rhs->reset(size, PATHFINDER_INFINITY);
+    keyModifier = 0;
+    repairPending = false;
+    root = nullptr;
+    status = PathFinderStatus::None;
+}
+
+void DStarLite::plan(Tile* newStart, Tile* newGoal, tile_flags_t newEntityFlagsMask, tile_index_t newEntityTileIndex) {
+    //Search tree is built from root so only a different root or movement class requires starting again
+    if (status == PathFinderStatus::None || root != newStart || entityFlagsMask != newEntityFlagsMask) {
+        initialize();
+        if (g->size() == 0) {
+            return;
+        }
+        root = newStart;
+        current = newGoal;
+        last = newGoal;
+        entityFlagsMask = newEntityFlagsMask;
+        layer = &request->getWorld()->getPassability()->getLayer(tileFlagsRequired, entityFlagsMask);
+        status = PathFinderStatus::Computing;
+        (*rhs)[root->index] = 0;
+        queue.push(calculateKey(root));
+        return;
+    }
+
+    //Entity moved, keys already queued become lower bounds which are corrected when popped
+    if (current != newGoal) {
+        keyModifier += heuristic(last, newGoal);
+        last = newGoal;
+        Tile* previous = current;
+        current = newGoal;
+        //Entity square is never occupied so squares overlapping both might have changed their passable state
+        int size = static_cast<int>(footprint) - 1;
+        squareChanged(previous, size, size);
+        squareChanged(current, size, size);
+    }
+}
+
+size_t DStarLite::compute(size_t maxSteps) {
+    PROFILE_ZONE("DStarLite::compute");
+    if (status != PathFinderStatus::Computing && status != PathFinderStatus::Success) {
+        return 0;
+    }
+
+    //Expand inconsistent vertexes until entity tile is consistent and nothing queued can improve it
+    size_t steps = 0;
+    bool done = true;
+    while (!queue.empty()) {
+        if (maxSteps <= steps) {
+            done = false;
+            break;
+        }
+        DStarLiteEntry entry = queue.top();
+        if (!(calculateKey(current) > entry) && rhs->get(current->index) <= g->get(current->index)) {
+            break;
+        }
+        queue.pop();
+
+        //Skip outdated entries, consistent vertexes are not queued and lowered keys are queued again
+        tile_index_t index = entry.index;
+        if (g->get(index) == rhs->get(index)) {
+            continue;
+        }
+        Tile* tile = request->getWorld()->getTile(index);
+        DStarLiteEntry key = calculateKey(tile);
+        if (entry > key) {
+            continue;
+        }
+        if (key > entry) {
+            queue.push(key);
+            continue;
+        }
+
+        steps++;
+        if (g->get(index) > rhs->get(index)) {
+            (*g)[index] = rhs->get(index);
+        } else {
+            (*g)[index] = PATHFINDER_INFINITY;
+            updateVertex(tile);
+        }
+        for (Tile* adjacent : tile->adjacents) {
+            updateVertex(adjacent);
+        }
+    }
+
+    if (!done) {
+        status = PathFinderStatus::Computing;
+        return steps;
+    }
+    repairPending = false;
+    PathFinderStatus newStatus = rhs->get(current->index) == PATHFINDER_INFINITY
+            ? PathFinderStatus::Fail
+            : PathFinderStatus::Success;
+    if (0 < steps || status != newStatus) {
+        revision++;
+    }
+    status = newStatus;
+    return steps;
+}
+
+void DStarLite::fail() {
+    queue.clear();
+    status = PathFinderStatus::Fail;
+    revision++;
+}
+
+bool DStarLite::isComputing() const {
+    return status == PathFinderStatus::Computing || (status == PathFinderStatus::Success && repairPending);
+}
+
+PathFinderStatus DStarLite::getStatus() {
+    return status;
+}
+
+bool DStarLite::getPath(std::vector<const Tile*>& path) const {
+    if (status != PathFinderStatus::Success) {
+        return false;
+    }
+
+    //Follow the cheapest adjacent from entity tile until root is reached
+    size_t start = path.size();
+    Tile* tile = current;
+    path.push_back(tile);
+    while (tile != root) {
+        Tile* next = nullptr;
+        path_cost_t best = PATHFINDER_INFINITY;
+        for (Tile* adjacent : tile->adjacents) {
+            path_cost_t total = addCost(cost(tile, adjacent), g->get(adjacent->index));
+            if (total < best) {
+                next = adjacent;
+                best = total;
+            }
+        }
+        if (!next || g->size() < path.size() - start) {
+            path.resize(start);
+            return false;
+        }
+        path.push_back(next);
+        tile = next;
+    }
+
+    //Entity tile must be at back
+    std::reverse(path.begin() + static_cast<long>(start), path.end());
+    return true;
+}
+
+void DStarLite::tilesChanged(const std::vector<Tile*>& tiles) {
+    if (status != PathFinderStatus::Computing && status != PathFinderStatus::Success) {
+        return;
+    }
+    //Squares which top left corner is above and left of tile contain it
+    int size = static_cast<int>(footprint) - 1;
+    for (Tile* tile : tiles) {
+        squareChanged(tile, size, 0);
+    }
+}
+
+bool DStarLite::isIncremental() const {
+    return true;
+}
+
+uint32_t DStarLite::getRevision() const {
+    return revision;
+}
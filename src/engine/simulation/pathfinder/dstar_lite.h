@@ -0,0 +1,221 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_DSTAR_LITE_H
+#define OPENE2140_DSTAR_LITE_H
+
+#include <vector>
+#include "engine/core/macros.h"
+#include "engine/core/common.h"
+#include "engine/core/priority_queue.h"
+#include "path_finder.h"
+#include "path_arena.h"
+
+class World;
+class PathRequest;
+class Tile;
+struct PassabilityLayer;
+
+/**
+ * Queued vertex of D* Lite with the key it had when queued
+ */
+struct DStarLiteEntry {
+    /** Primary key, estimated total cost */
+    path_cost_t k1;
+    /** Secondary key, cost to root */
+    path_cost_t k2;
+    /** Tile index of vertex */
+    tile_index_t index;
+
+    bool operator>(const DStarLiteEntry& other) const {
+        return k1 != other.k1 ? k1 > other.k1 : k2 > other.k2;
+    }
+};
+
+/**
+ * D* Lite based incremental pathfinder implementation
+ *
+ * Search is done from root (destination) towards the entity tile, so the search tree stays valid while entity moves
+ * and only the vertices affected by changed tiles are repaired afterwards
+ */
+class DStarLite: public PathFinder {
+protected:
+    /**
+     * The path request which spawned this pathfinder
+     */
+    PathRequest* request;
+
+    /**
+     * Entity which this search is for, its own reservations don't add cost
+     */
+    entity_id_t entity;
+
+    /**
+     * Current pathfinder state
+     */
+    PathFinderStatus status = PathFinderStatus::None;
+
+    /**
+     * Flag for changes that need to be repaired after search succeeded
+     */
+    bool repairPending = false;
+
+    /**
+     * Counter increased each time search finishes after being repaired
+     */
+    uint32_t revision = 0;
+
+    /**
+     * The tile where search starts, the destination
+     */
+    Tile* root = nullptr;
+
+    /**
+     * The tile where entity is sitting, changes as entity moves
+     */
+    Tile* current = nullptr;
+
+    /**
+     * Entity tile used when keys were last calculated
+     */
+    Tile* last = nullptr;
+
+    /**
+     * Accumulated heuristic of entity movements, avoids reordering queue when entity moves
+     */
+    path_cost_t keyModifier = 0;
+
+    /**
+     * Cost to root of each tile, taken from request arena pool
+     */
+    std::unique_ptr<PathArena<path_cost_t>> g;
+
+    /**
+     * One step lookahead cost to root of each tile, taken from request arena pool
+     */
+    std::unique_ptr<PathArena<path_cost_t>> rhs;
+
+    /**
+     * Priority queue of inconsistent vertexes, outdated entries are discarded when popped
+     */
+    PriorityQueue<DStarLiteEntry> queue;
+
+    /**
+     * Flags of tiles that should be present to be passable
+     */
+    tile_flags_t tileFlagsRequired = 0;
+
+    /**
+     * Entity flags in tiles that shouldn't be set
+     */
+    tile_flags_t entityFlagsMask = 0;
+
+    /**
+     * Size in tiles of square occupied by entity, tiles are the top left corner of square
+     */
+    unsigned int footprint = 1;
+
+    /**
+     * Passable tiles of movement class being searched
+     */
+    const PassabilityLayer* layer = nullptr;
+
+    /**
+     * Cost to move between adjacent tiles, entering a tile reserved by other entity costs more
+     *
+     * @param from tile
+     * @param to tile
+     * @return cost or infinity if any is not passable
+     */
+    path_cost_t cost(Tile* from, Tile* to) const;
+
+    /**
+     * Calculates the queue key of vertex
+     *
+     * @param tile of vertex
+     * @return entry with key
+     */
+    DStarLiteEntry calculateKey(const Tile* tile) const;
+
+    /**
+     * Recalculates the lookahead cost of vertex and queues it if is inconsistent
+     *
+     * @param tile of vertex
+     */
+    void updateVertex(Tile* tile);
+
+    /**
+     * Updates the vertex of tile and adjacents if they are part of search
+     *
+     * @param tile which passable state might have changed
+     */
+    void tileChanged(Tile* tile);
+
+    /**
+     * Handles the change of tiles whose square might contain the changed tile
+     *
+     * @param tile which passable state might have changed
+     * @param before amount of tiles above and left which squares might be affected
+     * @param after amount of tiles below and right which squares might be affected
+     */
+    void squareChanged(Tile* tile, int before, int after);
+
+public:
+    /**
+     * Constructor
+     */
+    DStarLite(PathRequest* request, entity_id_t entity, tile_flags_t tileFlagsRequired, unsigned int footprint);
+
+    /**
+     * Destructor
+     */
+    ~DStarLite() override;
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(DStarLite)
+
+    /**
+     * Estimated cost between tiles
+     *
+     * @param from tile
+     * @param to tile
+     * @return cost
+     */
+    static path_cost_t heuristic(const Tile* from, const Tile* to);
+
+    /**
+     * Checks if tile can't be crossed, entity tile is never occupied
+     *
+     * @param tile to check
+     * @return true if occupied
+     */
+    bool isOccupied(Tile* tile) const;
+
+    /*
+     * PathFinder
+     */
+
+    void initialize() override;
+
+    void plan(Tile* newStart, Tile* newGoal, tile_flags_t newEntityFlagsMask, tile_index_t newEntityTileIndex) override;
+
+    size_t compute(size_t maxSteps) override;
+
+    bool isComputing() const override;
+
+    void fail() override;
+
+    PathFinderStatus getStatus() override;
+
+    bool getPath(std::vector<const Tile*>& path) const override;
+
+    void tilesChanged(const std::vector<Tile*>& tiles) override;
+
+    bool isIncremental() const override;
+
+    uint32_t getRevision() const override;
+};
+
+#endif //OPENE2140_DSTAR_LITE_H
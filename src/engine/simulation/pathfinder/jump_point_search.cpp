@@ -0,0 +1,267 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <cstdlib>
+#include <algorithm>
+#include "engine/core/profiler.h"
+#include "engine/simulation/world/world.h"
+#include "engine/simulation/world/passability.h"
+#include "jump_point_search.h"
+#include "path_request.h"
+
+/**
+ * @return -1, 0 or 1 depending on value sign
+ */
+static int sign(int value) {
+    return (0 < value) - (value < 0);
+}
+
+JumpPointSearch::JumpPointSearch(PathRequest* request, entity_id_t entity, tile_flags_t tileFlagsRequired):
+AStar(request, entity, tileFlagsRequired, 1) {
+}
+
+size_t JumpPointSearch::compute(size_t maxSteps) {
+    PROFILE_ZONE("JumpPointSearch::compute");
+    World* world = request->getWorld();
+    if (status != PathFinderStatus::Computing || !world) {
+        return 0;
+    }
+    //Jumps of terrain changed rows and columns are recalculated before using them
+    jumpLayer = &world->getPassability()->getJumpLayer(tileFlagsRequired, 0);
+    return AStar::compute(maxSteps);
+}
+
+bool JumpPointSearch::isEntityNear(int x, int y, bool horizontal) const {
+    if (horizontal) {
+        for (int row = y - 1; row <= y + 1; ++row) {
+            if (jumpLayer->isPassable(x, row) != layer->isPassable(x, row)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return jumpLayer->getRowBits(x - 1, y, 3) != layer->getRowBits(x - 1, y, 3);
+}
+
+int JumpPointSearch::findEntityStep(int x, int y, int dx, int dy, int count) const {
+    for (int step = 1; step <= count; ++step) {
+        //Rows are compared by words so chunks without entities are skipped at once
+        if (dy == 0 && (step - 1) % 64 == 0) {
+            int length = std::min(64, count - step + 1);
+            int start = 0 < dx ? x + step : x - step - length + 1;
+            bool entities = false;
+            for (int row = y - 1; row <= y + 1 && !entities; ++row) {
+                entities = jumpLayer->getRowBits(start, row, length) != layer->getRowBits(start, row, length);
+            }
+            if (!entities) {
+                step += length - 1;
+                continue;
+            }
+        }
+        if (isEntityNear(x + dx * step, y + dy * step, dy == 0)) {
+            return step;
+        }
+    }
+    return 0;
+}
+
+int JumpPointSearch::getStraightJump(int x, int y, int dx, int dy) const {
+    JumpDirection direction;
+    if (dx != 0) {
+        direction = 0 < dx ? JumpDirection::East : JumpDirection::West;
+    } else {
+        direction = 0 < dy ? JumpDirection::South : JumpDirection::North;
+    }
+    int jump = jumpLayer->getJump(direction, x, y);
+    if (layer == jumpLayer) {
+        return jump;
+    }
+
+    //Terrain jump is valid until the run gets near an entity, from there continue like regular jump point search
+    int run = std::abs(jump);
+    int step = findEntityStep(x, y, dx, dy, run);
+    if (step == 0) {
+        return jump;
+    }
+    int sideX = dy;
+    int sideY = dx;
+    for (; step <= run; ++step) {
+        int stepX = x + dx * step;
+        int stepY = y + dy * step;
+        if (!layer->isPassable(stepX, stepY)) {
+            return 1 - step;
+        }
+        for (int side = -1; side <= 1; side += 2) {
+            if (!layer->isPassable(stepX + sideX * side, stepY + sideY * side)
+                && layer->isPassable(stepX + sideX * side + dx, stepY + sideY * side + dy)) {
+                return step;
+            }
+        }
+    }
+    return jump;
+}
+
+Tile* JumpPointSearch::jumpStraight(const World* world, int x, int y, int dx, int dy) const {
+    int jump = getStraightJump(x, y, dx, dy);
+    int free = std::abs(jump);
+
+    //Goal may be occupied so it's not present in jumps, check if lies in the run or next to it
+    const Vector2& goalPosition = goal->position;
+    int goalDistance = dx != 0 ? (goalPosition.x - x) * dx : (goalPosition.y - y) * dy;
+    int goalSide = dx != 0 ? std::abs(goalPosition.y - y) : std::abs(goalPosition.x - x);
+    int distance = jump;
+    if (0 < goalDistance && goalSide <= 1) {
+        bool blockedAfter = jump <= 0 && goalDistance == free + 1;
+        if (goalDistance <= free || blockedAfter) {
+            if (goalSide == 0) {
+                return goal;
+            }
+            //Stop at the tile of run next to goal so goal is added from there
+            distance = blockedAfter ? free : goalDistance;
+        }
+    }
+
+    if (distance <= 0) {
+        return nullptr;
+    }
+    return world->getTile(static_cast<unsigned int>(x + dx * distance), static_cast<unsigned int>(y + dy * distance));
+}
+
+Tile* JumpPointSearch::jumpDiagonal(const World* world, int x, int y, int dx, int dy) const {
+    const Vector2& goalPosition = goal->position;
+    while (true) {
+        x += dx;
+        y += dy;
+        if (x == goalPosition.x && y == goalPosition.y) {
+            return goal;
+        }
+        if (!layer->isPassable(x, y)) {
+            return nullptr;
+        }
+
+        //Stop at forced neighbours, when straight runs may pass next to goal or when they find a jump point
+        bool forced = (!layer->isPassable(x - dx, y) && layer->isPassable(x - dx, y + dy))
+                   || (!layer->isPassable(x, y - dy) && layer->isPassable(x + dx, y - dy));
+        if (forced
+            || std::abs(x - goalPosition.x) <= 1 || std::abs(y - goalPosition.y) <= 1
+            || 0 < getStraightJump(x, y, dx, 0)
+            || 0 < getStraightJump(x, y, 0, dy)) {
+            return world->getTile(static_cast<unsigned int>(x), static_cast<unsigned int>(y));
+        }
+    }
+}
+
+void JumpPointSearch::visitTile(const World* world, PathVertex& vertex) {
+    Tile* tile = world->getTile(vertex.index);
+    if (reachTile(tile)) {
+        return;
+    }
+
+    //Collect the directions to jump, start expands all of them and rest only natural and forced ones
+    int x = tile->position.x;
+    int y = tile->position.y;
+    int directions[8][2];
+    size_t count = 0;
+    if (vertex.back == vertex.index) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                if (dx != 0 || dy != 0) {
+                    directions[count][0] = dx;
+                    directions[count][1] = dy;
+                    count++;
+                }
+            }
+        }
+    } else {
+        const Vector2& backPosition = world->getTile(vertex.back)->position;
+        int dx = sign(x - backPosition.x);
+        int dy = sign(y - backPosition.y);
+        directions[count][0] = dx;
+        directions[count][1] = dy;
+        count++;
+        if (dx != 0 && dy != 0) {
+            directions[count][0] = dx;
+            directions[count][1] = 0;
+            count++;
+            directions[count][0] = 0;
+            directions[count][1] = dy;
+            count++;
+            if (!layer->isPassable(x - dx, y)) {
+                directions[count][0] = -dx;
+                directions[count][1] = dy;
+                count++;
+            }
+            if (!layer->isPassable(x, y - dy)) {
+                directions[count][0] = dx;
+                directions[count][1] = -dy;
+                count++;
+            }
+        } else if (dx != 0) {
+            for (int side = -1; side <= 1; side += 2) {
+                if (!layer->isPassable(x, y + side)) {
+                    directions[count][0] = dx;
+                    directions[count][1] = side;
+                    count++;
+                }
+            }
+        } else {
+            for (int side = -1; side <= 1; side += 2) {
+                if (!layer->isPassable(x + side, y)) {
+                    directions[count][0] = side;
+                    directions[count][1] = dy;
+                    count++;
+                }
+            }
+        }
+    }
+
+    //Goal is added directly when adjacent since jumps don't consider it if occupied
+    const Vector2& goalPosition = goal->position;
+    if (std::abs(goalPosition.x - x) <= 1 && std::abs(goalPosition.y - y) <= 1) {
+        addSuccessor(vertex, goal, goalPosition.distanceSquared(tile->position));
+    }
+
+    //Add the jump points found in each direction, diagonal steps cost as much as two straight steps
+    for (size_t i = 0; i < count; ++i) {
+        int dx = directions[i][0];
+        int dy = directions[i][1];
+        bool diagonal = dx != 0 && dy != 0;
+        Tile* successor = diagonal ? jumpDiagonal(world, x, y, dx, dy) : jumpStraight(world, x, y, dx, dy);
+        if (!successor || successor->index == vertex.back) {
+            continue;
+        }
+        int distance = std::max(std::abs(successor->position.x - x), std::abs(successor->position.y - y));
+        addSuccessor(vertex, successor, static_cast<path_cost_t>(diagonal ? distance * 2 : distance));
+    }
+}
+
+bool JumpPointSearch::getPath(std::vector<const Tile*>& path) const {
+    if (!closest) {
+        LOG_BUG("JumpPointSearch path requested but closest is null");
+        return false;
+    }
+
+    //Construct path by getting each jump point in the chain and the tiles between them
+    World* world = request->getWorld();
+    PathVertex vertex = getVertex(closest->index);
+    while (true) {
+        Tile* tile = world->getTile(vertex.index);
+        path.push_back(tile);
+        if (vertex.index == vertex.back) {
+            //Reached end
+            break;
+        }
+        const Vector2& backPosition = world->getTile(vertex.back)->position;
+        int dx = sign(backPosition.x - tile->position.x);
+        int dy = sign(backPosition.y - tile->position.y);
+        int x = tile->position.x + dx;
+        int y = tile->position.y + dy;
+        while (x != backPosition.x || y != backPosition.y) {
+            path.push_back(world->getTile(static_cast<unsigned int>(x), static_cast<unsigned int>(y)));
+            x += dx;
+            y += dy;
+        }
+        vertex = getVertex(vertex.back);
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_JUMP_POINT_SEARCH_H
+#define OPENE2140_JUMP_POINT_SEARCH_H
+
+#include "astar.h"
+
+/**
+ * A* variant which only expands jump points, straight runs are skipped using the precomputed jump distances of
+ * world passability layer and diagonal runs are scanned on the packed passable bits
+ *
+ * Jumps are taken from terrain only layer so moving entities don't make rows and columns to be recalculated,
+ * straight runs are checked against entities on the way and scanned step by step from the first one
+ *
+ * Passability layer is per tile so only entities with footprint of a single tile can use it
+ */
+class JumpPointSearch: public AStar {
+protected:
+    /**
+     * Passable tiles and jumps of movement class without considering entities
+     */
+    const PassabilityLayer* jumpLayer = nullptr;
+
+    /**
+     * Checks if entities change the passable state of tile or the tiles at its sides
+     *
+     * @param x of tile
+     * @param y of tile
+     * @param horizontal true if sides are above and below, otherwise left and right
+     * @return true if any entity is present
+     */
+    bool isEntityNear(int x, int y, bool horizontal) const;
+
+    /**
+     * Finds the first step of straight run where entities are present in tile or its sides
+     *
+     * @param x of position
+     * @param y of position
+     * @param dx direction in x
+     * @param dy direction in y
+     * @param count of steps to check
+     * @return step or 0 if none
+     */
+    int findEntityStep(int x, int y, int dx, int dy, int count) const;
+
+    /**
+     * Obtains the jump distance from position in straight direction considering entities
+     *
+     * @param x of position
+     * @param y of position
+     * @param dx direction in x
+     * @param dy direction in y
+     * @return jump distance with same meaning as passability layer jumps
+     */
+    int getStraightJump(int x, int y, int dx, int dy) const;
+
+    /**
+     * Jumps from position in straight direction
+     *
+     * @param world pointer of world containing tiles
+     * @param x of position
+     * @param y of position
+     * @param dx direction in x
+     * @param dy direction in y
+     * @return jump point or goal found, null if none
+     */
+    Tile* jumpStraight(const World* world, int x, int y, int dx, int dy) const;
+
+    /**
+     * Jumps from position in diagonal direction
+     *
+     * @param world pointer of world containing tiles
+     * @param x of position
+     * @param y of position
+     * @param dx direction in x
+     * @param dy direction in y
+     * @return jump point or goal found, null if none
+     */
+    Tile* jumpDiagonal(const World* world, int x, int y, int dx, int dy) const;
+
+    void visitTile(const World* world, PathVertex& vertex) override;
+
+public:
+    /**
+     * Constructor
+     */
+    JumpPointSearch(PathRequest* request, entity_id_t entity, tile_flags_t tileFlagsRequired);
+
+    /*
+     * PathFinder
+     */
+
+    size_t compute(size_t maxSteps) override;
+
+    /**
+     * Obtains the chain from closest tile to search start including the tiles skipped between jump points
+     *
+     * @param path vector to write path
+     * @return true if path was written
+     */
+    bool getPath(std::vector<const Tile*>& path) const override;
+};
+
+#endif //OPENE2140_JUMP_POINT_SEARCH_H
@@ -0,0 +1,152 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_PATH_ARENA_H
+#define OPENE2140_PATH_ARENA_H
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "engine/core/macros.h"
+#include "engine/core/types.h"
+#include "path_vertex.h"
+
+/**
+ * Per tile search state that is reset in constant time
+ *
+ * Each value is stamped with the generation that wrote it, values with older stamps are considered to have the
+ * initial value so resetting only requires increasing the generation
+ */
+template<typename T>
+class PathArena {
+protected:
+    /**
+     * Stored values, only valid if stamp matches current generation
+     */
+    std::vector<T> values;
+
+    /**
+     * Generation that wrote each value
+     */
+    std::vector<uint32_t> stamps;
+
+    /**
+     * Current generation
+     */
+    uint32_t generation = 0;
+
+    /**
+     * Value returned for values not written in current generation
+     */
+    T initial {};
+
+public:
+    /**
+     * Constructor
+     */
+    PathArena() = default;
+
+    /**
+     * Destructor
+     */
+    ~PathArena() = default;
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(PathArena)
+
+    /**
+     * Starts a new generation where every value has the initial value
+     *
+     * @param size amount of values
+     * @param initialValue value that all values have after reset
+     */
+    void reset(size_t size, const T& initialValue) {
+        initial = initialValue;
+        if (values.size() != size) {
+            values.resize(size);
+            stamps.assign(size, 0);
+            generation = 0;
+        }
+        generation++;
+        //Stamps from old generations would become valid again after wrapping around
+        if (generation == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
+        }
+    }
+
+    /**
+     * @return amount of values
+     */
+    size_t size() const {
+        return values.size();
+    }
+
+    /**
+     * @return value at index without stamping it
+     */
+    const T& get(size_t index) const {
+        return stamps[index] == generation ? values[index] : initial;
+    }
+
+    /**
+     * @return writable value at index, set to initial value if not written in current generation
+     */
+    T& operator[](size_t index) {
+        if (stamps[index] != generation) {
+            stamps[index] = generation;
+            values[index] = initial;
+        }
+        return values[index];
+    }
+};
+
+/**
+ * Keeps arenas from finished searches so new searches reuse their memory
+ */
+template<typename T>
+class PathArenaPool {
+protected:
+    /**
+     * Arenas not being used
+     */
+    std::vector<std::unique_ptr<PathArena<T>>> arenas;
+
+public:
+    /**
+     * @return unused arena or new one if none is available
+     */
+    std::unique_ptr<PathArena<T>> acquire() {
+        if (arenas.empty()) {
+            return std::make_unique<PathArena<T>>();
+        }
+        std::unique_ptr<PathArena<T>> arena = std::move(arenas.back());
+        arenas.pop_back();
+        return arena;
+    }
+
+    /**
+     * Returns arena to pool once is no longer used
+     *
+     * @param arena to return
+     */
+    void release(std::unique_ptr<PathArena<T>> arena) {
+        if (arena) {
+            arenas.push_back(std::move(arena));
+        }
+    }
+};
+
+/**
+ * Arena pools shared by requests and pathfinders of a path handler
+ */
+struct PathArenas {
+    /** Vertexes of pathfinders */
+    PathArenaPool<PathVertex> vertexes;
+    /** Costs of pathfinders */
+    PathArenaPool<path_cost_t> costs;
+};
+
+#endif //OPENE2140_PATH_ARENA_H
@@ -0,0 +1,92 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_PATH_FINDER_H
+#define OPENE2140_PATH_FINDER_H
+
+#include <vector>
+#include "engine/core/types.h"
+#include "path_state.h"
+
+class Tile;
+
+/**
+ * Common interface of pathfinder algorithms used by path requests
+ */
+class PathFinder {
+public:
+    /**
+     * Destructor
+     */
+    virtual ~PathFinder() = default;
+
+    /**
+     * (re)initializes the internal states to clear state
+     */
+    virtual void initialize() = 0;
+
+    /**
+     * Notifies the pathfinder about the current desired plan
+     *
+     * @param newStart tile where search starts
+     * @param newGoal tile where search ends
+     * @param newEntityFlagsMask entity flags in tiles that shouldn't be set
+     * @param newEntityTileIndex tile where entity is located
+     */
+    virtual void plan(Tile* newStart, Tile* newGoal, tile_flags_t newEntityFlagsMask, tile_index_t newEntityTileIndex) = 0;
+
+    /**
+     * Does the main computation of algorithm
+     *
+     * @param maxSteps amount of vertices that can be expanded
+     * @return amount of vertices expanded
+     */
+    virtual size_t compute(size_t maxSteps) = 0;
+
+    /**
+     * @return true if pathfinder has work pending to be computed
+     */
+    virtual bool isComputing() const = 0;
+
+    /**
+     * Marks the plan as failed without computing, used when goal is known to be unreachable
+     */
+    virtual void fail() = 0;
+
+    /**
+     * @return current path finder status
+     */
+    virtual PathFinderStatus getStatus() = 0;
+
+    /**
+     * Obtains the path found, the next tile entity has to visit is at back
+     *
+     * @param path vector to write path
+     * @return true if path was written
+     */
+    virtual bool getPath(std::vector<const Tile*>& path) const = 0;
+
+    /**
+     * Notifies the pathfinder about tiles which flags changed since last update
+     *
+     * @param tiles that changed, might contain duplicates
+     */
+    virtual void tilesChanged(const std::vector<Tile*>& tiles) {
+    }
+
+    /**
+     * @return true if pathfinder keeps updating its result after success
+     */
+    virtual bool isIncremental() const {
+        return false;
+    }
+
+    /**
+     * @return counter that increases each time the result changes after being computed
+     */
+    virtual uint32_t getRevision() const {
+        return 0;
+    }
+};
+
+#endif //OPENE2140_PATH_FINDER_H
@@ -1,11 +1,16 @@
 //
 // Created by Ion Agorria on 13/06/19
 //
+#include <algorithm>
+#include <unordered_set>
+#include "engine/core/profiler.h"
 #include "path_handler.h"
 #include "engine/simulation/entity.h"
 #include "engine/simulation/player.h"
+#include "engine/simulation/simulation.h"
+#include "engine/simulation/world/world.h"
 
-PathHandler::PathHandler(Player* player): player(player) {
+PathHandler::PathHandler(Player* player): player(player), arenas(std::make_shared<PathArenas>()) {
 }
 
 Player* PathHandler::getPlayer() {
@@ -26,6 +31,18 @@ PathHandler::requestDestination(std::shared_ptr<Entity>& entity, Tile* tile, boo
     std::shared_ptr<PathRequest> activeRequest;
     removeRequests(entity->getID());
 
+    //Retarget unreachable destinations to closest reachable tile, avoids flooding the region to find out
+    Tile* entityTile = entity->getTile();
+    World* world = player->simulation ? player->simulation->getWorld() : nullptr;
+    if (tile && entityTile && world) {
+        Tile* reachable = world->getReachability()->getNearestReachable(entity->tileFlagsRequired, entityTile, tile);
+        if (reachable != tile) {
+            tile = reachable;
+            //Retargeted tile is reachable so a normal request suffices which can be shared with others
+            partial = false;
+        }
+    }
+
     if (tile) {
         PathRequestMode mode = partial ? PathRequestMode::ACTIVE_PARTIAL
                                        : PathRequestMode::ACTIVE_TILE;
@@ -42,7 +59,7 @@ PathHandler::requestDestination(std::shared_ptr<Entity>& entity, Tile* tile, boo
 
         //None found, create new request
         if (!activeRequest) {
-            activeRequest = std::make_shared<PathRequest>();
+            activeRequest = std::make_shared<PathRequest>(arenas);
             activeRequest->mode = mode;
             activeRequest->handler = this;
             activeRequest->simulation = player->simulation;
@@ -57,6 +74,116 @@ PathHandler::requestDestination(std::shared_ptr<Entity>& entity, Tile* tile, boo
     return activeRequest;
 }
 
+std::vector<std::shared_ptr<PathRequest>>
+PathHandler::requestGroup(std::vector<std::shared_ptr<Entity>>& entities, Tile* tile) {
+    std::vector<std::shared_ptr<PathRequest>> result(entities.size());
+    World* world = player->simulation ? player->simulation->getWorld() : nullptr;
+    if (tile && world) {
+        //Leader is the entity closest to destination so the rest are behind it
+        std::vector<size_t> members;
+        for (size_t i = 0; i < entities.size(); ++i) {
+            if (entities[i]->getTile() && entities[i]->footprint <= 1) {
+                members.push_back(i);
+            }
+        }
+        std::sort(members.begin(), members.end(), [&](size_t a, size_t b) {
+            unsigned int distanceA = entities[a]->getTile()->position.distanceSquared(tile->position);
+            unsigned int distanceB = entities[b]->getTile()->position.distanceSquared(tile->position);
+            if (distanceA != distanceB) {
+                return distanceA < distanceB;
+            }
+            return entities[a]->getID() < entities[b]->getID();
+        });
+
+        //Followers must be able to walk the leader path
+        std::vector<size_t> followers;
+        Tile* destination = tile;
+        if (!members.empty()) {
+            std::shared_ptr<Entity>& leader = entities[members.front()];
+            Reachability* reachability = world->getReachability();
+            destination = reachability->getNearestReachable(leader->tileFlagsRequired, leader->getTile(), tile);
+            for (size_t i = 1; i < members.size(); ++i) {
+                const std::shared_ptr<Entity>& entity = entities[members[i]];
+                if (entity->tileFlagsRequired == leader->tileFlagsRequired
+                    && entity->entityFlagsMask == leader->entityFlagsMask
+                    && reachability->isReachable(entity->tileFlagsRequired, entity->getTile(), destination)) {
+                    followers.push_back(members[i]);
+                }
+            }
+        }
+
+        if (!followers.empty()) {
+            std::shared_ptr<Entity>& leader = entities[members.front()];
+            removeRequests(leader->getID());
+            for (size_t index : followers) {
+                removeRequests(entities[index]->getID());
+            }
+
+            //Group has its own request since followers slots are only valid for it
+            std::shared_ptr<PathRequest> request = std::make_shared<PathRequest>(arenas);
+            request->mode = PathRequestMode::ACTIVE_TILE;
+            request->handler = this;
+            request->simulation = player->simulation;
+            request->setDestination(destination);
+            requests.push_back(request);
+            request->setLeader(leader);
+            result[members.front()] = request;
+
+            //Followers arriving first take the farthest slots so they don't stand in the way of the rest
+            std::vector<std::vector<const Tile*>> slots;
+            findSlots(world, leader.get(), destination, followers.size(), slots);
+            for (size_t i = 0; i < followers.size(); ++i) {
+                std::vector<const Tile*> slot;
+                if (i < slots.size()) {
+                    slot = std::move(slots[slots.size() - 1 - i]);
+                }
+                request->addFollower(entities[followers[i]], std::move(slot));
+                result[followers[i]] = request;
+            }
+        }
+    }
+
+    //The rest go on their own
+    for (size_t i = 0; i < entities.size(); ++i) {
+        if (!result[i]) {
+            result[i] = requestDestination(entities[i], tile);
+        }
+    }
+    return result;
+}
+
+void PathHandler::findSlots(World* world, const Entity* leader, Tile* destination, size_t count,
+                            std::vector<std::vector<const Tile*>>& slots) {
+    //Flood from destination through free tiles, each reached tile is a slot and flood parents lead to it
+    const PassabilityLayer& layer = world->getPassability()->getLayer(leader->tileFlagsRequired, leader->entityFlagsMask);
+    std::vector<const Tile*> visited;
+    std::vector<size_t> parents;
+    std::unordered_set<tile_index_t> seen;
+    visited.push_back(destination);
+    parents.push_back(0);
+    seen.insert(destination->index);
+    for (size_t i = 0; i < visited.size() && visited.size() <= count; ++i) {
+        for (const Tile* adjacent : visited[i]->adjacents) {
+            if (count < visited.size()) {
+                break;
+            }
+            if (seen.count(adjacent->index) || !layer.isPassable(adjacent->position.x, adjacent->position.y)) {
+                continue;
+            }
+            seen.insert(adjacent->index);
+            visited.push_back(adjacent);
+            parents.push_back(i);
+        }
+    }
+    for (size_t i = 1; i < visited.size(); ++i) {
+        std::vector<const Tile*>& slot = slots.emplace_back();
+        for (size_t j = i; j != 0; j = parents[j]) {
+            slot.push_back(visited[j]);
+        }
+        std::reverse(slot.begin(), slot.end());
+    }
+}
+
 std::shared_ptr<PathRequest>
 PathHandler::requestTarget(std::shared_ptr<Entity>& entity, const std::shared_ptr<Entity>& target) {
     std::shared_ptr<PathRequest> activeRequest;
@@ -73,7 +200,7 @@ PathHandler::requestTarget(std::shared_ptr<Entity>& entity, const std::shared_pt
 
         //None found, create new request
         if (!activeRequest) {
-            activeRequest = std::make_shared<PathRequest>();
+            activeRequest = std::make_shared<PathRequest>(arenas);
             activeRequest->mode = PathRequestMode::ACTIVE_ENTITY;
             activeRequest->handler = this;
             activeRequest->simulation = player->simulation;
@@ -88,7 +215,11 @@ PathHandler::requestTarget(std::shared_ptr<Entity>& entity, const std::shared_pt
     return activeRequest;
 }
 
-void PathHandler::update() {
+void PathHandler::update(uint64_t tick) {
+    PROFILE_ZONE("PathHandler::update");
+    lastExpansions = 0;
+    pending.clear();
+    std::vector<std::pair<uint64_t, PathRequest*>> priorities;
     for (auto it = requests.begin(); it != requests.end(); ) {
         PathRequest* request = (*it).get();
 
@@ -103,7 +234,53 @@ void PathHandler::update() {
             continue;
         }
 
+        //Store for computing if it has work to do
+        if (request->isComputing()) {
+            priorities.emplace_back(request->getPriority(tick), request);
+        }
+
         //Move to next
         ++it;
     }
+
+    //Stable sort keeps creation order for same priority so result is deterministic
+    std::stable_sort(priorities.begin(), priorities.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    for (auto& pair : priorities) {
+        pending.push_back(pair.second);
+    }
+}
+
+size_t PathHandler::compute(size_t budget, uint64_t tick) {
+    PROFILE_ZONE("PathHandler::compute");
+    size_t expansions = 0;
+    size_t done = 0;
+    for (PathRequest* request : pending) {
+        if (budget <= expansions) {
+            break;
+        }
+        expansions += request->compute(budget - expansions, tick);
+        if (request->isComputing()) {
+            break;
+        }
+        done++;
+    }
+
+    //Remove the finished requests, the rest keep their order for next round
+    pending.erase(pending.begin(), pending.begin() + static_cast<long>(done));
+    lastExpansions += expansions;
+    return expansions;
+}
+
+bool PathHandler::hasPending() const {
+    return !pending.empty();
+}
+
+size_t PathHandler::getLastExpansions() const {
+    return lastExpansions;
+}
+
+size_t PathHandler::getRequestsCount() const {
+    return requests.size();
 }
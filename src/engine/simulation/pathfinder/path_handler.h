@@ -10,6 +10,7 @@
 
 class Tile;
 class Player;
+class World;
 
 /**
  * Handles per player pathfinder requests and coordinates the ongoing requests by the agents
@@ -48,6 +49,33 @@ protected:
      */
     std::vector<std::shared_ptr<PathRequest>> requests;
 
+    /**
+     * Search state arenas reused between requests, shared as requests might outlive handler
+     */
+    std::shared_ptr<PathArenas> arenas;
+
+    /**
+     * Requests with pending computation sorted by priority
+     */
+    std::vector<PathRequest*> pending;
+
+    /**
+     * Vertices expanded by pathfinders in last update
+     */
+    size_t lastExpansions = 0;
+
+    /**
+     * Finds the formation slots around destination, closest slots first
+     *
+     * @param world where slots are searched
+     * @param leader entity which movement class is used
+     * @param destination where group goes
+     * @param count of slots to find
+     * @param slots to fill with tiles from destination to each slot
+     */
+    void findSlots(World* world, const Entity* leader, Tile* destination, size_t count,
+                   std::vector<std::vector<const Tile*>>& slots);
+
 public:
     /**
      * Constructs a new path handler for player
@@ -76,11 +104,23 @@ public:
      * Returns a request for entity with the provided destination
      *
      * @param entity the entity originating the request
-     * @param tile destination tile to find the path
+     * @param tile destination tile to find the path, unreachable tiles are replaced by closest reachable tile
      * @param partial is request for a partial type?
      */
     std::shared_ptr<PathRequest> requestDestination(std::shared_ptr<Entity>& entity, Tile* tile, bool partial = false);
 
+    /**
+     * Returns the requests for a group of entities going to destination, one path is searched for the leader and the
+     * rest follow it to formation slots near destination
+     *
+     * Entities which can't share the leader path due to different movement class, size or region get their own request
+     *
+     * @param entities the entities originating the request
+     * @param tile destination tile of group, unreachable tiles are replaced by closest reachable tile
+     * @return request for each entity in same order
+     */
+    std::vector<std::shared_ptr<PathRequest>> requestGroup(std::vector<std::shared_ptr<Entity>>& entities, Tile* tile);
+
     /**
      * Returns a request for entity with the provided target
      *
@@ -90,9 +130,35 @@ public:
     std::shared_ptr<PathRequest> requestTarget(std::shared_ptr<Entity>& entity, const std::shared_ptr<Entity>& target);
 
     /**
-     * Updates the ongoing requests
+     * Updates the ongoing requests and sorts the ones that need computation by priority
+     *
+     * @param tick current simulation tick
+     */
+    void update(uint64_t tick);
+
+    /**
+     * Computes the pending requests in priority order until budget is used
+     *
+     * @param budget amount of vertices that can be expanded
+     * @param tick current simulation tick
+     * @return amount of vertices expanded
+     */
+    size_t compute(size_t budget, uint64_t tick);
+
+    /**
+     * @return true if there are requests with pending computation
+     */
+    bool hasPending() const;
+
+    /**
+     * @return vertices expanded by pathfinders in last update
+     */
+    size_t getLastExpansions() const;
+
+    /**
+     * @return amount of active requests
      */
-    void update();
+    size_t getRequestsCount() const;
 };
 
 #endif //OPENE2140_PATH_HANDLER_H
@@ -1,15 +1,24 @@
 //
 // Created by Ion Agorria on 14/06/19
 //
+#include <algorithm>
+#include <limits>
 #include "engine/simulation/simulation.h"
 #include "src/engine/simulation/entity.h"
 #include "src/engine/simulation/entity_store.h"
 #include "engine/simulation/world/world.h"
 #include "engine/simulation/world/tile.h"
+#include "engine/simulation/world/passability.h"
+#include "reservation_table.h"
 #include "path_vertex.h"
 #include "path_request.h"
 
-PathRequest::PathRequest() {
+PathRequest::PathRequest(std::shared_ptr<PathArenas> arenas): arenas(std::move(arenas)) {
+}
+
+PathRequest::~PathRequest() {
+    //Pathfinders return their arenas to pool so they must go first
+    pathfinders.clear();
 }
 
 World* PathRequest::getWorld() const {
@@ -17,58 +26,270 @@ World* PathRequest::getWorld() const {
 }
 
 void PathRequest::initialize() {
-    //Reset each vertex
+    //Pathfinders reset their vertexes for this amount of tiles
     World* world = this->getWorld();
-    if (world) {
-        auto& tiles = world->getTiles();
-        vertexes.resize(tiles.size());
-        for (std::unique_ptr<Tile>& tile : tiles) {
-            PathVertex& vertex = vertexes[tile->index];
-            vertex.index = tile->index;
-            vertex.back = 0;
-            vertex.g = PATHFINDER_INFINITY;
-            vertex.l = 0;
-        }
-    } else {
-        vertexes.clear();
-    }
+    vertexesCount = world ? world->getTiles().size() : 0;
     //Init each pathfinders
     for (auto& pair : pathfinders) {
         pair.second->initialize();
     }
 }
 
-const std::vector<PathVertex>& PathRequest::getVertexes() const {
-    return vertexes;
+PathArenas& PathRequest::getArenas() {
+    return *arenas;
 }
 
-std::vector<PathVertex>& PathRequest::getVertexes() {
-    return vertexes;
+path_cost_t PathRequest::getReservationCost(const Tile* tile, entity_id_t entity) const {
+    ReservationTable* reservations = simulation ? simulation->getReservations() : nullptr;
+    return reservations && reservations->isReservedByOther(tile->index, entity) ? RESERVATION_COST : 0;
+}
+
+size_t PathRequest::getVertexesCount() const {
+    return vertexesCount;
 }
 
 bool PathRequest::addEntity(std::shared_ptr<Entity>& entity) {
-    std::unique_ptr<AStar>& pathfinder = pathfinders[entity->getID()];
+    std::unique_ptr<PathFinder>& pathfinder = pathfinders[entity->getID()];
     if (pathfinder) {
         //Already exists in request
         return false;
     }
 
-    pathfinder = std::make_unique<AStar>(this, entity->tileFlagsRequired);
-    pathfinders[entity->getID()] = std::move(pathfinder);
+    //Joining entities make request as new for scheduling
+    if (simulation) {
+        createdTick = simulation->getTick();
+        scheduledTick = createdTick;
+    }
+
+    //Partial searches visit every reachable tile so closest one is found, first search of single tile entities
+    //skips runs of tiles with jump points and is replaced by D* Lite only when path needs repair, the rest can
+    //reuse their search as entity moves
+    if (mode == PathRequestMode::ACTIVE_PARTIAL) {
+        pathfinder = std::make_unique<AStar>(this, entity->getID(), entity->tileFlagsRequired, entity->footprint);
+    } else if (entity->footprint <= 1) {
+        pathfinder = std::make_unique<JumpPointSearch>(this, entity->getID(), entity->tileFlagsRequired);
+    } else {
+        pathfinder = std::make_unique<DStarLite>(this, entity->getID(), entity->tileFlagsRequired, entity->footprint);
+    }
+    return true;
+}
+
+bool PathRequest::setLeader(std::shared_ptr<Entity>& entity) {
+    if (leader != 0 || !addEntity(entity)) {
+        return false;
+    }
+    leader = entity->getID();
+    return true;
+}
+
+bool PathRequest::addFollower(std::shared_ptr<Entity>& entity, std::vector<const Tile*> slot) {
+    entity_id_t entityId = entity->getID();
+    if (leader == 0 || pathfinders.count(entityId) || followers.count(entityId)) {
+        return false;
+    }
+    PathFollower& follower = followers[entityId];
+    follower.tileFlagsRequired = entity->tileFlagsRequired;
+    follower.entityFlagsMask = entity->entityFlagsMask;
+    follower.slot = std::move(slot);
     return true;
 }
 
 bool PathRequest::removeEntity(entity_id_t entity_id) {
+    if (followers.erase(entity_id) != 0) {
+        return true;
+    }
+    if (entity_id == leader && pathfinders.count(entity_id)) {
+        leaderRemoved();
+    }
     return pathfinders.erase(entity_id) != 0;
 }
 
+void PathRequest::updateLeaderPath() {
+    const auto pathfinder = pathfinders.find(leader);
+    if (pathfinder == pathfinders.end() || pathfinder->second->getStatus() != PathFinderStatus::Success) {
+        return;
+    }
+    uint32_t revision = pathfinder->second->getRevision();
+    if (!leaderPath.empty() && revision == leaderRevision) {
+        return;
+    }
+    std::vector<const Tile*> path;
+    if (!pathfinder->second->getPath(path)) {
+        return;
+    }
+
+    //Append the tiles behind leader from previous path, followers might be still walking them
+    auto walked = std::find(leaderPath.begin(), leaderPath.end(), path.back());
+    if (walked != leaderPath.end()) {
+        path.insert(path.end(), walked + 1, leaderPath.end());
+    }
+    leaderPath.swap(path);
+    leaderRevision = revision;
+}
+
+bool PathRequest::isPathBlocked(const PathFinder& pathfinder, const Entity& entity, const Tile* tile,
+                                const std::vector<Tile*>& changedTiles) {
+    //Most changes don't block this movement class so avoid taking the path for them
+    const PassabilityLayer& layer = getWorld()->getPassability()->getLayer(
+            entity.tileFlagsRequired, entity.entityFlagsMask
+    );
+    bool anyBlocked = false;
+    for (const Tile* changed : changedTiles) {
+        if (changed != tile && !layer.isPassable(changed->position.x, changed->position.y)) {
+            anyBlocked = true;
+            break;
+        }
+    }
+    if (!anyBlocked) {
+        return false;
+    }
+
+    //Path has destination at front and start at back, only tiles in front of entity matter
+    std::vector<const Tile*> path;
+    pathfinder.getPath(path);
+    auto end = std::find(path.begin(), path.end(), tile);
+    for (auto pathTile = path.begin(); pathTile != end; ++pathTile) {
+        const Vector2& position = (*pathTile)->position;
+        if (!layer.isPassable(position.x, position.y)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PathRequest::leaderRemoved() {
+    //Take the last path so followers don't need to search again
+    if (!followers.empty()) {
+        updateLeaderPath();
+    }
+    leader = 0;
+    if (followers.empty() || !leaderPath.empty()) {
+        return;
+    }
+
+    //Leader left before having a path, first active follower takes its place
+    EntityStore* entityStore = simulation ? simulation->getEntitiesStore() : nullptr;
+    while (entityStore && !followers.empty()) {
+        std::shared_ptr<Entity> entity = entityStore->getEntity(followers.begin()->first);
+        followers.erase(followers.begin());
+        if (entity && entity->isActive() && setLeader(entity)) {
+            break;
+        }
+    }
+    if (leader == 0) {
+        followers.clear();
+    }
+}
+
+bool PathRequest::steerFollower(const Tile* start, const Tile* target, const PathFollower& follower,
+                                const Tile* avoid, std::vector<const Tile*>& route) const {
+    //Steps must be free of blocking entities, target is on leader path where group members wait for each other
+    const PassabilityLayer& layer = getWorld()->getPassability()->getLayer(
+            follower.tileFlagsRequired, follower.entityFlagsMask
+    );
+    const Tile* tile = start;
+    while (tile != target) {
+        const Tile* next = nullptr;
+        unsigned int best = tile->position.distanceSquared(target->position);
+        for (const Tile* adjacent : tile->adjacents) {
+            if (adjacent == avoid) {
+                continue;
+            }
+            if (adjacent == target
+                ? (adjacent->tileFlags & follower.tileFlagsRequired) != follower.tileFlagsRequired
+                : !layer.isPassable(adjacent->position.x, adjacent->position.y)) {
+                continue;
+            }
+            unsigned int distance = adjacent->position.distanceSquared(target->position);
+            if (distance < best) {
+                next = adjacent;
+                best = distance;
+            }
+        }
+        if (!next) {
+            return false;
+        }
+        route.push_back(next);
+        tile = next;
+    }
+    return true;
+}
+
+bool PathRequest::getFollowerPath(const Tile* start, const PathFollower& follower, std::vector<const Tile*>& path) const {
+    //Join leader path at closest tile, on ties the one closer to destination
+    size_t join = 0;
+    unsigned int best = std::numeric_limits<unsigned int>::max();
+    for (size_t i = 0; i < leaderPath.size(); ++i) {
+        unsigned int distance = leaderPath[i]->position.distanceSquared(start->position);
+        if (distance < best) {
+            join = i;
+            best = distance;
+        }
+    }
+
+    //Followers without slot stop at destination like leader
+    std::vector<const Tile*> route;
+    route.push_back(start);
+    if (follower.slot.empty()) {
+        if (!steerFollower(start, leaderPath[join], follower, nullptr, route)) {
+            return false;
+        }
+        for (size_t i = join; 0 < i; --i) {
+            route.push_back(leaderPath[i - 1]);
+        }
+        path.insert(path.end(), route.rbegin(), route.rend());
+        return true;
+    }
+
+    //Destination is taken by leader so slot is entered from the leader tile before it, joining there directly
+    //if follower is already next to destination
+    const Tile* destination = leaderPath.front();
+    size_t last = 1 < leaderPath.size() ? std::max<size_t>(1, join) : 0;
+    if (0 < last && !steerFollower(start, leaderPath[last], follower, destination, route)) {
+        return false;
+    }
+
+    //Follow leader path and branch into the deepest slot tile next to it, or steer from last tile before
+    //destination into slot entrance
+    const std::vector<const Tile*>& slot = follower.slot;
+    for (size_t i = last; 0 < i; --i) {
+        const Tile* tile = leaderPath[i];
+        if (i != last) {
+            route.push_back(tile);
+        }
+        for (size_t j = slot.size(); 0 < j; --j) {
+            const Vector2& position = slot[j - 1]->position;
+            if (slot[j - 1] == tile) {
+                route.insert(route.end(), slot.begin() + static_cast<ptrdiff_t>(j), slot.end());
+                path.insert(path.end(), route.rbegin(), route.rend());
+                return true;
+            }
+            if (std::abs(position.x - tile->position.x) <= 1 && std::abs(position.y - tile->position.y) <= 1) {
+                route.insert(route.end(), slot.begin() + static_cast<ptrdiff_t>(j - 1), slot.end());
+                path.insert(path.end(), route.rbegin(), route.rend());
+                return true;
+            }
+        }
+    }
+    if (!steerFollower(route.back(), slot.front(), follower, destination, route)) {
+        return false;
+    }
+    route.insert(route.end(), slot.begin() + 1, slot.end());
+
+    //Entity tile must be at back
+    path.insert(path.end(), route.rbegin(), route.rend());
+    return true;
+}
+
 PathFinderStatus PathRequest::getResult(entity_id_t entity, std::vector<const Tile*>& path) const {
     //Check if mode and pathfinder is available
     if (mode == PathRequestMode::INACTIVE) {
         return PathFinderStatus::None;
     }
     const auto pathfinder = pathfinders.find(entity);
-    if (pathfinder == pathfinders.end()) return PathFinderStatus::None;
+    if (pathfinder == pathfinders.end()) {
+        return getFollowerResult(entity, path);
+    }
 
     //Get stuff
     PathFinderStatus status = pathfinder->second->getStatus();
@@ -83,27 +304,7 @@ PathFinderStatus PathRequest::getResult(entity_id_t entity, std::vector<const Ti
     //Handle success or partial status
     if (status == PathFinderStatus::Partial
      || status == PathFinderStatus::Success) {
-        Tile* closest = pathfinder->second->getClosest();
-        if (closest) {
-            World* world = getWorld();
-            //Attempt to construct path by getting each tile in the chain
-            const PathVertex* vertex = &vertexes[closest->index];
-            while (true) {
-                Tile* tile = world->getTile(vertex->index);
-                path.push_back(tile);
-                if (vertex->index == vertex->back) {
-                    //Reached end
-                    break;
-                }
-                vertex = &vertexes[vertex->back];
-            }
-            //Since partial is done from entity as start we need to reverse it
-            if (!isPartialRequest) {
-                std::reverse(path.begin(), path.end());
-            }
-        } else {
-            LOG_BUG("PathRequest status is positive but closest is null");
-        }
+        pathfinder->second->getPath(path);
 
         //If there is no path then mark as failed
         if (path.empty()) {
@@ -114,6 +315,38 @@ PathFinderStatus PathRequest::getResult(entity_id_t entity, std::vector<const Ti
     return status;
 }
 
+PathFinderStatus PathRequest::getFollowerResult(entity_id_t entity, std::vector<const Tile*>& path) const {
+    const auto follower = followers.find(entity);
+    if (follower == followers.end()) return PathFinderStatus::None;
+
+    //Followers wait until leader path is taken, if leader fails the whole group fails
+    if (leaderPath.empty()) {
+        const auto pathfinder = pathfinders.find(leader);
+        if (pathfinder == pathfinders.end()) return PathFinderStatus::Fail;
+        PathFinderStatus status = pathfinder->second->getStatus();
+        if (status == PathFinderStatus::Partial || status == PathFinderStatus::Fail) {
+            return PathFinderStatus::Fail;
+        }
+        return PathFinderStatus::Computing;
+    }
+
+    //Path is created from current tile as follower might not be where it was when leader path was taken
+    std::shared_ptr<Entity> entityPtr = simulation ? simulation->getEntitiesStore()->getEntity(entity) : nullptr;
+    Tile* tile = entityPtr ? entityPtr->getTile() : nullptr;
+    if (!tile || !getFollowerPath(tile, follower->second, path)) {
+        return PathFinderStatus::Fail;
+    }
+    return PathFinderStatus::Success;
+}
+
+uint32_t PathRequest::getRevision(entity_id_t entity) const {
+    const auto pathfinder = pathfinders.find(entity);
+    if (pathfinder == pathfinders.end()) {
+        return followers.count(entity) ? leaderRevision : 0;
+    }
+    return pathfinder->second->getRevision();
+}
+
 Tile* PathRequest::getDestination() const {
     return destination;
 }
@@ -141,11 +374,12 @@ void PathRequest::setTarget(std::shared_ptr<Entity> entity) {
 }
 
 bool PathRequest::empty() {
-    return pathfinders.empty();
+    return pathfinders.empty() && followers.empty();
 }
 
 void PathRequest::update() {
     //Skip if mode is inactive
+    estimate = PATHFINDER_INFINITY;
     if (mode == PathRequestMode::INACTIVE) {
         return;
     }
@@ -174,6 +408,8 @@ void PathRequest::update() {
     //If there is no destination remove all pathfinders
     if (!destination) {
         pathfinders.clear();
+        followers.clear();
+        leader = 0;
     }
 
     //Check if there is anything left
@@ -184,28 +420,75 @@ void PathRequest::update() {
 
     //Update each pathfinders
     auto entityStore = simulation->getEntitiesStore();
+    World* world = getWorld();
+    Reachability* reachability = world->getReachability();
+    const std::vector<Tile*>& changedTiles = world->getChangedTiles();
+
+    //Incremental searches repair the costs of tiles which reservations changed
+    std::vector<Tile*> reservedTiles;
+    for (tile_index_t index : simulation->getReservations()->getChangedTiles()) {
+        reservedTiles.push_back(world->getTile(index));
+    }
+    for (auto it = followers.begin(); it != followers.end(); ) {
+        std::shared_ptr<Entity> entity = entityStore->getEntity(it->first);
+        if (!entity || !entity->isActive() || !entity->getTile()) {
+            it = followers.erase(it);
+        } else {
+            ++it;
+        }
+    }
     for (auto it = pathfinders.begin(); it != pathfinders.end(); ) {
         //Remove if entity is no longer active
         std::shared_ptr<Entity> entity = entityStore->getEntity(it->first);
-        Tile* tile = entity->getTile();
+        Tile* tile = entity ? entity->getTile() : nullptr;
         if (!entity || !entity->isActive() || !tile) {
+            if (it->first == leader) {
+                leaderRemoved();
+            }
             it = pathfinders.erase(it);
             continue;
         }
 
-        //Ignore if not computing
+        //Let pathfinder repair its search with the tiles that changed since last update, found paths of searches
+        //that can't repair are handed to D* Lite once a changed tile blocks them
         auto& pathfinder = it->second;
+        if (!changedTiles.empty()) {
+            pathfinder->tilesChanged(changedTiles);
+            if (this->mode != PathRequestMode::ACTIVE_PARTIAL && !pathfinder->isIncremental()
+                && pathfinder->getStatus() == PathFinderStatus::Success
+                && isPathBlocked(*pathfinder, *entity, tile, changedTiles)) {
+                pathfinder = std::make_unique<DStarLite>(
+                        this, entity->getID(), entity->tileFlagsRequired, entity->footprint
+                );
+            }
+        }
+        if (!reservedTiles.empty() && pathfinder->isIncremental()) {
+            pathfinder->tilesChanged(reservedTiles);
+        }
+
+        //Ignore if not computing, incremental pathfinders keep following entity after success
         auto status = pathfinder->getStatus();
-        if (status == PathFinderStatus::None || status == PathFinderStatus::Computing) {
-            //Update state according to partial mode
-            if (this->mode == PathRequestMode::ACTIVE_PARTIAL) {
+        if (status == PathFinderStatus::None || status == PathFinderStatus::Computing
+            || (status == PathFinderStatus::Success && pathfinder->isIncremental())) {
+            //Destination in another region can't be reached no matter how entities move, so fail without searching
+            if (this->mode != PathRequestMode::ACTIVE_PARTIAL
+                && !reachability->isReachable(entity->tileFlagsRequired, tile, destination)) {
+                pathfinder->fail();
+                ++it;
+                continue;
+            }
+
+            //Incremental searches start from destination so they can be reused as entity moves
+            if (!pathfinder->isIncremental()) {
                 pathfinder->plan(tile, destination, entity->entityFlagsMask, tile->index);
             } else {
                 pathfinder->plan(destination, tile, entity->entityFlagsMask, tile->index);
             }
 
-            //Update computation
-            pathfinder->compute();
+            //Keep the closest entity that needs computation for scheduling
+            if (pathfinder->isComputing()) {
+                estimate = std::min(estimate, DStarLite::heuristic(tile, destination));
+            }
         }
 
         //Move to next
@@ -213,6 +496,56 @@ void PathRequest::update() {
     }
 }
 
+size_t PathRequest::compute(size_t budget, uint64_t tick) {
+    scheduledTick = tick;
+    size_t pending = 0;
+    for (auto& pair : pathfinders) {
+        if (pair.second->isComputing()) {
+            pending++;
+        }
+    }
+
+    //Each pathfinder gets an equal part of what is left so first ones don't starve the rest
+    size_t expansions = 0;
+    for (auto& pair : pathfinders) {
+        if (budget <= expansions || pending == 0) {
+            break;
+        }
+        auto& pathfinder = pair.second;
+        if (!pathfinder->isComputing()) {
+            continue;
+        }
+        size_t share = std::max<size_t>(1, (budget - expansions) / pending);
+        expansions += pathfinder->compute(share);
+        pending--;
+    }
+
+    //Give followers the leader path in same tick it was found
+    if (leader != 0) {
+        updateLeaderPath();
+    }
+    return expansions;
+}
+
+bool PathRequest::isComputing() const {
+    if (mode == PathRequestMode::INACTIVE) {
+        return false;
+    }
+    for (const auto& pair : pathfinders) {
+        if (pair.second->isComputing()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t PathRequest::getPriority(uint64_t tick) const {
+    if (PATHFINDER_STARVATION_TICKS <= tick - scheduledTick) {
+        return 0;
+    }
+    return 1 + estimate + (tick - createdTick);
+}
+
 std::shared_ptr<PathRequest> PathRequest::requestPartial(std::shared_ptr<Entity> entity) {
     std::shared_ptr<PathRequest> request;
     if (handler && destination && (mode == PathRequestMode::ACTIVE_ENTITY || mode == PathRequestMode::ACTIVE_TILE)) {
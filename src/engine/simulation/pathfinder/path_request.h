@@ -9,6 +9,9 @@
 #include "engine/core/macros.h"
 #include "engine/math/vector2.h"
 #include "astar.h"
+#include "dstar_lite.h"
+#include "jump_point_search.h"
+#include "path_arena.h"
 
 class PathHandler;
 class World;
@@ -16,6 +19,9 @@ class Tile;
 class Entity;
 class Simulation;
 
+/** Ticks a computing request can wait without budget before being scheduled first */
+#define PATHFINDER_STARVATION_TICKS 30
+
 enum class PathRequestMode {
     ACTIVE_TILE, //Request to a specific tile
     ACTIVE_ENTITY, //Request to go into entity tile, can become ACTIVE_TILE if entity is lost/destroyed
@@ -23,16 +29,29 @@ enum class PathRequestMode {
     INACTIVE, //Request is no longer active and should be removed
 };
 
+/**
+ * Member of a group request which tracks the leader path instead of searching its own
+ */
+struct PathFollower {
+    /** Flags of tiles that follower can pass when steering into leader path */
+    tile_flags_t tileFlagsRequired = 0;
+    /** Flags of entities that block follower when steering into leader path */
+    tile_flags_t entityFlagsMask = 0;
+    /** Tiles from destination to formation slot of follower, empty if follower stops at destination */
+    std::vector<const Tile*> slot;
+};
+
 /**
  * Contains the request for pathfinder, can contain one or several agents that want go to a single fixed destination or
- * follow another moving agent. Stores the common reusable vertex data if the goal is the same.
+ * follow another moving agent. Each pathfinder keeps its own vertexes taken from the shared arena pools.
  */
 class PathRequest {
 protected:
     /**
-     * Pathfinder assigned to each agent
+     * Pathfinder assigned to each agent, partial requests use A*, single tile entities use jump point search until
+     * path needs repair and the rest use incremental D* Lite
      */
-    std::map<entity_id_t, std::unique_ptr<AStar>> pathfinders;
+    std::map<entity_id_t, std::unique_ptr<PathFinder>> pathfinders;
 
     /**
      * Destination for this request
@@ -45,9 +64,105 @@ protected:
     std::shared_ptr<Entity> target;
 
     /**
-     * Stores vertexes for state keeping, also manages the ownership of vertex memory
+     * Arena pools where vertexes and pathfinder costs are taken from
+     */
+    std::shared_ptr<PathArenas> arenas;
+
+    /**
+     * Amount of vertexes that pathfinders of this request use, one for each world tile
+     */
+    size_t vertexesCount = 0;
+
+    /**
+     * Simulation tick when last entity was added
+     */
+    uint64_t createdTick = 0;
+
+    /**
+     * Simulation tick when request was last given budget to compute
+     */
+    uint64_t scheduledTick = 0;
+
+    /**
+     * Estimated cost to destination of closest entity still computing
+     */
+    path_cost_t estimate = PATHFINDER_INFINITY;
+
+    /**
+     * Entity which path is shared with followers, 0 if request has no group
+     */
+    entity_id_t leader = 0;
+
+    /**
+     * Followers of leader with their formation slots
      */
-    std::vector<PathVertex> vertexes;
+    std::map<entity_id_t, PathFollower> followers;
+
+    /**
+     * Last path of leader including the tiles that leader walked already, destination is at front
+     */
+    std::vector<const Tile*> leaderPath;
+
+    /**
+     * Revision of leader pathfinder when leader path was taken
+     */
+    uint32_t leaderRevision = 0;
+
+    /**
+     * Takes the leader path if was repaired, keeping the walked tiles so followers behind can still join it
+     */
+    void updateLeaderPath();
+
+    /**
+     * Checks if any of the changed tiles blocks the part of path that entity still has to walk
+     *
+     * @param pathfinder which found the path
+     * @param entity that follows the path
+     * @param tile where entity is
+     * @param changedTiles tiles changed since last update
+     * @return true if path is blocked
+     */
+    bool isPathBlocked(const PathFinder& pathfinder, const Entity& entity, const Tile* tile,
+                       const std::vector<Tile*>& changedTiles);
+
+    /**
+     * Called when leader is removed, followers keep using last leader path or another leader is picked if there
+     * was no path yet
+     */
+    void leaderRemoved();
+
+    /**
+     * Steers greedily from tile into target, each step must get closer so it can't loop
+     *
+     * @param start tile to steer from, not added to route
+     * @param target tile to reach, only needs to match tile flags as it may be occupied by group members
+     * @param follower which steers
+     * @param avoid tile that steps must not enter, null if none
+     * @param route vector to append steps
+     * @return false if a step closer to target can't be taken
+     */
+    bool steerFollower(const Tile* start, const Tile* target, const PathFollower& follower, const Tile* avoid,
+                       std::vector<const Tile*>& route) const;
+
+    /**
+     * Creates the path of follower by steering into closest tile of leader path and then branching into its slot
+     * before reaching destination
+     *
+     * @param start tile of follower
+     * @param follower to create path
+     * @param path vector to write path
+     * @return false if follower can't reach leader path
+     */
+    bool getFollowerPath(const Tile* start, const PathFollower& follower, std::vector<const Tile*>& path) const;
+
+    /**
+     * Returns the current status of leader path for the provided follower
+     *
+     * @param entity which follows leader
+     * @param path vector to write path if available
+     * @return path status
+     */
+    PathFinderStatus getFollowerResult(entity_id_t entity, std::vector<const Tile*>& path) const;
 
 public:
     /**
@@ -67,13 +182,20 @@ public:
 
     /**
      * Constructor
+     *
+     * @param arenas pools to take search state from
      */
-    PathRequest();
+    explicit PathRequest(std::shared_ptr<PathArenas> arenas);
 
     /**
      * Destructor
      */
-    ~PathRequest() = default;
+    ~PathRequest();
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(PathRequest)
 
     /**
      * (re)initializes the internal states to clear state
@@ -86,14 +208,23 @@ public:
     World* getWorld() const;
 
     /**
-     * @return the common vertexes for this request
+     * @return arena pools of this request
+     */
+    PathArenas& getArenas();
+
+    /**
+     * @return amount of vertexes for pathfinders of this request
      */
-    const std::vector<PathVertex>& getVertexes() const;
+    size_t getVertexesCount() const;
 
     /**
-     * @return the common vertexes for this request
+     * Obtains the extra cost for entity of entering tile reserved by other entities
+     *
+     * @param tile to enter
+     * @param entity which enters
+     * @return cost to add
      */
-    std::vector<PathVertex>& getVertexes();
+    path_cost_t getReservationCost(const Tile* tile, entity_id_t entity) const;
 
     /**
      * Adds a new entity to this request
@@ -103,6 +234,23 @@ public:
      */
     bool addEntity(std::shared_ptr<Entity>& entity);
 
+    /**
+     * Adds entity as leader of group, its path will be shared with followers
+     *
+     * @param entity
+     * @return if was added
+     */
+    bool setLeader(std::shared_ptr<Entity>& entity);
+
+    /**
+     * Adds entity as follower of leader path which goes to its formation slot at the end
+     *
+     * @param entity
+     * @param slot tiles from destination to formation slot
+     * @return if was added
+     */
+    bool addFollower(std::shared_ptr<Entity>& entity, std::vector<const Tile*> slot);
+
     /**
      * Removes a entity from this request if any
      *
@@ -121,6 +269,14 @@ public:
      */
     PathFinderStatus getResult(entity_id_t entity, std::vector<const Tile*>& path) const;
 
+    /**
+     * Returns the counter that increases each time the path of provided entity is repaired
+     *
+     * @param entity which requested the path
+     * @return revision of path
+     */
+    uint32_t getRevision(entity_id_t entity) const;
+
     /**
      * @return current destination
      */
@@ -151,10 +307,32 @@ public:
     bool empty();
 
     /**
-     * Updates the entities and pathfinder stuff
+     * Updates the entities and pathfinder plans, computation is done separately as budget allows
      */
     void update();
 
+    /**
+     * Computes the pathfinders that have pending work sharing the budget between them
+     *
+     * @param budget amount of vertices that can be expanded
+     * @param tick current simulation tick
+     * @return amount of vertices expanded by pathfinders
+     */
+    size_t compute(size_t budget, uint64_t tick);
+
+    /**
+     * @return true if any pathfinder has work pending to be computed
+     */
+    bool isComputing() const;
+
+    /**
+     * Calculates the scheduling priority, newer and shorter requests go first unless some request waited too long
+     *
+     * @param tick current simulation tick
+     * @return priority, lower goes first
+     */
+    uint64_t getPriority(uint64_t tick) const;
+
     /**
      * Create a partial path request from this request and provided entity
      *
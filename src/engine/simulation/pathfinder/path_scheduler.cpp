@@ -0,0 +1,60 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <algorithm>
+#include "engine/core/profiler.h"
+#include "engine/simulation/player.h"
+#include "path_handler.h"
+#include "path_scheduler.h"
+
+PathScheduler::PathScheduler(size_t budget): budget(budget) {
+}
+
+size_t PathScheduler::update(const std::vector<std::unique_ptr<Player>>& players, uint64_t tick) {
+    PROFILE_ZONE("PathScheduler::update");
+    handlers.clear();
+    for (const std::unique_ptr<Player>& player : players) {
+        if (player) {
+            PathHandler* handler = player->pathHandler.get();
+            handler->update(tick);
+            if (handler->hasPending()) {
+                handlers.push_back(handler);
+            }
+        }
+    }
+
+    //Start from a different player each update so remainders of split are not always given to the same
+    if (!handlers.empty()) {
+        std::rotate(handlers.begin(), handlers.begin() + static_cast<long>(tick % handlers.size()), handlers.end());
+    }
+
+    //Give each handler an equal share of remaining budget until it's used or nothing is pending
+    size_t remaining = budget;
+    while (0 < remaining && !handlers.empty()) {
+        size_t share = std::max<size_t>(1, remaining / handlers.size());
+        size_t used = 0;
+        for (PathHandler* handler : handlers) {
+            if (remaining <= used) {
+                break;
+            }
+            used += handler->compute(std::min(share, remaining - used), tick);
+        }
+        remaining -= std::min(used, remaining);
+
+        //Stop if no progress was made to avoid looping forever
+        size_t count = handlers.size();
+        handlers.erase(std::remove_if(handlers.begin(), handlers.end(), [](PathHandler* handler) {
+            return !handler->hasPending();
+        }), handlers.end());
+        if (used == 0 && count == handlers.size()) {
+            break;
+        }
+    }
+    handlers.clear();
+
+    return budget - remaining;
+}
+
+size_t PathScheduler::getBudget() const {
+    return budget;
+}
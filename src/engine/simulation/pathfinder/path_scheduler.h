@@ -0,0 +1,65 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_PATH_SCHEDULER_H
+#define OPENE2140_PATH_SCHEDULER_H
+
+#include <memory>
+#include <vector>
+#include "engine/core/macros.h"
+
+class Player;
+class PathHandler;
+
+/**
+ * Distributes a global per update budget of vertex expansions between the path handlers of all players
+ *
+ * Budget is split equally between players with pending requests, whatever a player doesn't use is split again
+ * between the ones that still have pending requests. Each player spends its share on its requests in priority order.
+ */
+class PathScheduler {
+protected:
+    /**
+     * Vertices that can be expanded in each update
+     */
+    size_t budget;
+
+    /**
+     * Handlers with pending requests in current update
+     */
+    std::vector<PathHandler*> handlers;
+
+public:
+    /**
+     * Constructor
+     *
+     * @param budget vertices that can be expanded in each update
+     */
+    explicit PathScheduler(size_t budget);
+
+    /**
+     * Destructor
+     */
+    ~PathScheduler() = default;
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(PathScheduler)
+
+    /**
+     * Updates the path handlers of players and computes their requests within budget
+     *
+     * @param players to update
+     * @param tick current simulation tick
+     * @return amount of vertices expanded
+     */
+    size_t update(const std::vector<std::unique_ptr<Player>>& players, uint64_t tick);
+
+    /**
+     * @return vertices that can be expanded in each update
+     */
+    size_t getBudget() const;
+};
+
+#endif //OPENE2140_PATH_SCHEDULER_H
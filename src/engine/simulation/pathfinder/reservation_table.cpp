@@ -0,0 +1,117 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <algorithm>
+#include "reservation_table.h"
+
+ReservationTable::ReservationTable(size_t tilesCount) {
+    tiles.resize(tilesCount);
+}
+
+void ReservationTable::update(uint64_t newTick) {
+    tick = newTick;
+}
+
+bool ReservationTable::reserve(entity_id_t entity, tile_index_t index, uint64_t from, uint64_t until) {
+    if (tiles.size() <= index || until <= from) {
+        return false;
+    }
+
+    //Remove expired reservations of tile while checking for overlaps
+    std::vector<TileReservation>& reservations = tiles[index];
+    uint64_t currentTick = tick;
+    auto expired = [currentTick](const TileReservation& reservation) {
+        return reservation.until <= currentTick;
+    };
+    auto last = std::remove_if(reservations.begin(), reservations.end(), expired);
+    if (last != reservations.end()) {
+        reservations.erase(last, reservations.end());
+        changedTiles.push_back(index);
+    }
+    for (const TileReservation& reservation : reservations) {
+        if (reservation.entity != entity && reservation.from < until && from < reservation.until) {
+            return false;
+        }
+    }
+
+    //Extend the reservation of entity if touches the new one
+    for (TileReservation& reservation : reservations) {
+        if (reservation.entity == entity && reservation.from <= until && from <= reservation.until) {
+            reservation.from = std::min(reservation.from, from);
+            reservation.until = std::max(reservation.until, until);
+            return true;
+        }
+    }
+    reservations.push_back({entity, index, from, until});
+    entities[entity].push_back(index);
+    changedTiles.push_back(index);
+    return true;
+}
+
+void ReservationTable::release(entity_id_t entity) {
+    auto it = entities.find(entity);
+    if (it == entities.end()) {
+        return;
+    }
+    for (tile_index_t index : it->second) {
+        std::vector<TileReservation>& reservations = tiles[index];
+        auto owned = [entity](const TileReservation& reservation) {
+            return reservation.entity == entity;
+        };
+        reservations.erase(std::remove_if(reservations.begin(), reservations.end(), owned), reservations.end());
+        changedTiles.push_back(index);
+    }
+    entities.erase(it);
+}
+
+entity_id_t ReservationTable::getReserver(tile_index_t index, uint64_t from, uint64_t until, entity_id_t ignore) const {
+    if (tiles.size() <= index) {
+        return 0;
+    }
+    for (const TileReservation& reservation : tiles[index]) {
+        if (reservation.entity != ignore && tick < reservation.until
+            && reservation.from < until && from < reservation.until) {
+            return reservation.entity;
+        }
+    }
+    return 0;
+}
+
+bool ReservationTable::isReservedByOther(tile_index_t index, entity_id_t entity) const {
+    if (tiles.size() <= index) {
+        return false;
+    }
+    for (const TileReservation& reservation : tiles[index]) {
+        if (reservation.entity != entity) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::vector<tile_index_t>& ReservationTable::getChangedTiles() const {
+    return changedTiles;
+}
+
+void ReservationTable::clearChangedTiles() {
+    changedTiles.clear();
+}
+
+void ReservationTable::getReservations(entity_id_t entity, std::vector<TileReservation>& reservations) const {
+    auto it = entities.find(entity);
+    if (it == entities.end()) {
+        return;
+    }
+    const std::vector<tile_index_t>& indexes = it->second;
+    for (auto index = indexes.begin(); index != indexes.end(); ++index) {
+        //Tile might be reserved several times by entity
+        if (std::find(indexes.begin(), index, *index) != index) {
+            continue;
+        }
+        for (const TileReservation& reservation : tiles[*index]) {
+            if (reservation.entity == entity && tick < reservation.until) {
+                reservations.push_back(reservation);
+            }
+        }
+    }
+}
@@ -0,0 +1,146 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_RESERVATION_TABLE_H
+#define OPENE2140_RESERVATION_TABLE_H
+
+#include <unordered_map>
+#include <vector>
+#include "engine/core/macros.h"
+#include "engine/core/types.h"
+
+/** Amount of upcoming path tiles that each moving entity reserves */
+#define RESERVATION_WINDOW 4
+/** Max ticks an entity waits for a tile reserved by other before entering anyway, avoids deadlocks */
+#define RESERVATION_WAIT_TICKS 30
+/** Max ticks estimated for an entity to cross a tile */
+#define RESERVATION_TILE_TICKS_MAX 60
+/** Extra path cost for entering a tile reserved by other entity, planners take short detours instead of waiting */
+#define RESERVATION_COST 4
+
+/**
+ * Time interval in which an entity will be in a tile
+ */
+struct TileReservation {
+    /** Entity which reserved the tile */
+    entity_id_t entity = 0;
+    /** Index of tile reserved */
+    tile_index_t index = 0;
+    /** Tick where reservation starts */
+    uint64_t from = 0;
+    /** Tick where reservation ends, not included */
+    uint64_t until = 0;
+};
+
+/**
+ * Space-time reservations of tiles, moving entities reserve the tiles of their path for the ticks they expect to be
+ * on them so others wait instead of colliding in the same tile
+ *
+ * Reservations are taken in order they are requested, a reservation fails if overlaps a reservation of other entity
+ */
+class ReservationTable {
+protected:
+    /**
+     * Reservations of each tile by index
+     */
+    std::vector<std::vector<TileReservation>> tiles;
+
+    /**
+     * Tiles reserved by each entity
+     */
+    std::unordered_map<entity_id_t, std::vector<tile_index_t>> entities;
+
+    /**
+     * Current simulation tick, reservations ending before it are expired
+     */
+    uint64_t tick = 0;
+
+    /**
+     * Indexes of tiles which reservations were added or removed since last clear, might contain duplicates
+     */
+    std::vector<tile_index_t> changedTiles;
+
+public:
+    /**
+     * Constructor
+     *
+     * @param tilesCount amount of tiles in world
+     */
+    explicit ReservationTable(size_t tilesCount);
+
+    /**
+     * Destructor
+     */
+    ~ReservationTable() = default;
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(ReservationTable)
+
+    /**
+     * Sets the current tick
+     *
+     * @param newTick current simulation tick
+     */
+    void update(uint64_t newTick);
+
+    /**
+     * Reserves a tile for entity during the interval
+     *
+     * @param entity reserving
+     * @param index of tile
+     * @param from tick where reservation starts
+     * @param until tick where reservation ends, not included
+     * @return true if reserved, false if other entity has the tile reserved in that interval
+     */
+    bool reserve(entity_id_t entity, tile_index_t index, uint64_t from, uint64_t until);
+
+    /**
+     * Removes all reservations of entity
+     *
+     * @param entity to release
+     */
+    void release(entity_id_t entity);
+
+    /**
+     * Obtains the entity that has the tile reserved during the interval
+     *
+     * @param index of tile
+     * @param from tick where interval starts
+     * @param until tick where interval ends, not included
+     * @param ignore entity which reservations are not considered
+     * @return entity which reserved the tile or 0 if none
+     */
+    entity_id_t getReserver(tile_index_t index, uint64_t from, uint64_t until, entity_id_t ignore) const;
+
+    /**
+     * Checks if other entity has any reservation in tile, expired reservations count until they are removed so
+     * planners notified about changed tiles see the same state
+     *
+     * @param index of tile
+     * @param entity which reservations are not considered
+     * @return true if reserved by other
+     */
+    bool isReservedByOther(tile_index_t index, entity_id_t entity) const;
+
+    /**
+     * @return indexes of tiles which reservations were added or removed since last clear
+     */
+    const std::vector<tile_index_t>& getChangedTiles() const;
+
+    /**
+     * Clears the changed tiles once planners handled them
+     */
+    void clearChangedTiles();
+
+    /**
+     * Obtains the reservations of entity which didn't expire
+     *
+     * @param entity to get
+     * @param reservations vector to write reservations
+     */
+    void getReservations(entity_id_t entity, std::vector<TileReservation>& reservations) const;
+};
+
+#endif //OPENE2140_RESERVATION_TABLE_H
@@ -2,9 +2,13 @@
 // Created by Ion Agorria on 3/08/19
 //
 
+#include <algorithm>
 #include "engine/core/macros.h"
 #include "engine/io/log.h"
+#include "engine/simulation/components/energy_component.h"
 #include "faction.h"
+#include "simulation.h"
+#include "save_stream.h"
 #include "player.h"
 
 Player::Player(player_id_t id):
@@ -25,8 +29,122 @@ void Player::removeEnemy(const Player* other) {
     BIT_OFF(enemies, other->mask);
 }
 
+void Player::toggleStateHash() {
+    if (!simulation) {
+        return;
+    }
+    StateHash& stateHash = simulation->getStateHash();
+    stateHash.toggle(StateHashField::PlayerMoney, id, StateHash::toBits(money));
+    stateHash.toggle(StateHashField::PlayerEnergyPool, id, StateHash::toBits(energyPool));
+    stateHash.toggle(StateHashField::PlayerEnergyGeneration, id, StateHash::toBits(energyGeneration));
+}
+
+void Player::setSimulation(Simulation* newSimulation) {
+    toggleStateHash();
+    simulation = newSimulation;
+    toggleStateHash();
+}
+
+money_t Player::getMoney() const {
+    return money;
+}
+
+void Player::setMoney(money_t newMoney) {
+    if (simulation) {
+        simulation->getStateHash().update(StateHashField::PlayerMoney, id, StateHash::toBits(money), StateHash::toBits(newMoney));
+    }
+    money = newMoney;
+}
+
+entity_energy_t Player::getEnergyGeneration() const {
+    return energyGeneration;
+}
+
+void Player::setEnergyGeneration(entity_energy_t newEnergyGeneration) {
+    if (simulation) {
+        simulation->getStateHash().update(
+                StateHashField::PlayerEnergyGeneration, id,
+                StateHash::toBits(energyGeneration), StateHash::toBits(newEnergyGeneration)
+        );
+    }
+    energyGeneration = newEnergyGeneration;
+}
+
+entity_energy_t Player::getEnergyPool() const {
+    return energyPool;
+}
+
+void Player::setEnergyPool(entity_energy_t newEnergyPool) {
+    if (simulation) {
+        simulation->getStateHash().update(
+                StateHashField::PlayerEnergyPool, id,
+                StateHash::toBits(energyPool), StateHash::toBits(newEnergyPool)
+        );
+    }
+    energyPool = newEnergyPool;
+}
+
+void Player::saveState(SaveWriter& writer) const {
+    writer.write<money_t>(money);
+    writer.write<entity_energy_t>(energyPool);
+    writer.write<entity_energy_t>(energyGeneration);
+    writer.write<player_mask_t>(enemies);
+    writer.write<faction_id_t>(faction ? faction->id : 0);
+    writer.writeString(name);
+}
+
+void Player::loadState(SaveReader& reader) {
+    setMoney(reader.read<money_t>());
+    setEnergyPool(reader.read<entity_energy_t>());
+    setEnergyGeneration(reader.read<entity_energy_t>());
+    enemies = reader.read<player_mask_t>();
+    faction_id_t factionId = reader.read<faction_id_t>();
+    faction = factionId && simulation ? simulation->getFaction(factionId) : nullptr;
+    name = reader.readString();
+}
+
+void Player::addEnergyEntity(entity_id_t entityId, EnergyComponent* component) {
+    energyLedger[entityId] = component;
+    energyLedgerChanged = true;
+}
+
+void Player::removeEnergyEntity(entity_id_t entityId) {
+    energyLedger.erase(entityId);
+    energyLedgerChanged = true;
+}
+
+void Player::energyChanged() {
+    energyLedgerChanged = true;
+}
+
 void Player::update() {
-    energyPool = energyGeneration;
-    energyGeneration = 0;
-    pathHandler->update();
+    if (!energyLedgerChanged) {
+        return;
+    }
+    energyLedgerChanged = false;
+
+    //Collect the generation and sort by priority, stable sort keeps the ledger id order for same priority
+    entity_energy_t generation = 0;
+    std::vector<EnergyComponent*> components;
+    components.reserve(energyLedger.size());
+    for (auto& pair : energyLedger) {
+        generation += pair.second->getEnergyGenerated();
+        components.push_back(pair.second);
+    }
+    std::stable_sort(components.begin(), components.end(), [](const EnergyComponent* a, const EnergyComponent* b) {
+        return a->getEnergyPriority() > b->getEnergyPriority();
+    });
+
+    //Satisfy each entity while there is energy left, lower priority ones may still fit with the remaining energy
+    entity_energy_t pool = generation;
+    for (EnergyComponent* component : components) {
+        entity_energy_t requirement = component->getEnergyRequired();
+        bool satisfied = component->isEnergyActive() && requirement <= pool;
+        if (satisfied) {
+            pool -= requirement;
+        }
+        component->setEnergySatisfied(satisfied);
+    }
+    setEnergyGeneration(generation);
+    setEnergyPool(pool);
 }
\ No newline at end of file
@@ -4,39 +4,62 @@
 #ifndef OPENE2140_PLAYER_H
 #define OPENE2140_PLAYER_H
 
+#include <map>
 #include "engine/simulation/pathfinder/path_handler.h"
 #include "engine/graphics/color.h"
 #include "engine/core/macros.h"
 
 class Faction;
+class EnergyComponent;
 class Simulation;
+class SaveWriter;
+class SaveReader;
 
 /**
  * Contains Player related data
  */
 class Player {
-public:
+protected:
     /**
-     * ID for the player
+     * Energy generated by all player entities
      */
-    const player_id_t id = 0;
+    entity_energy_t energyGeneration = 0;
 
     /**
-     * Mask of this player based on id
+     * Energy left after satisfying the entities that could be satisfied
      */
-    const player_mask_t mask = 0;
+    entity_energy_t energyPool = 0;
 
     /**
-     * Energy generated in previous update
-     * To be incremented by entities
+     * Energy ledger with entities that generate or use energy by id, so distribution follows entity order on same priority
      */
-    entity_energy_t energyGeneration = 0;
+    std::map<entity_id_t, EnergyComponent*> energyLedger;
 
     /**
-     * Energy pool available considering the energy generation
-     * Used by entities
+     * Flag for energy ledger changes that need the energy to be distributed again in next update
      */
-    entity_energy_t energyPool = 0;
+    bool energyLedgerChanged = false;
+
+    /**
+     * Player money amount
+     */
+    money_t money = 0;
+
+    /**
+     * Adds or removes the hashed state of this player from simulation state hash
+     */
+    void toggleStateHash();
+
+public:
+    /**
+     * ID for the player
+     */
+    const player_id_t id = 0;
+
+    /**
+     * Mask of this player based on id
+     */
+    const player_mask_t mask = 0;
 
     /**
      * Main color for this player
@@ -73,11 +96,6 @@ public:
      */
     std::string name = "";
 
-    /**
-     * Player money amount
-     */
-    money_t money = 0;
-
     /**
      * Constructor
      */
@@ -113,7 +131,78 @@ public:
     void removeEnemy(const Player* other);
 
     /**
-     * Handle the player energy
+     * Sets the simulation which player belongs
+     *
+     * @param newSimulation to set or null if removed
+     */
+    void setSimulation(Simulation* newSimulation);
+
+    /** @return player money amount */
+    money_t getMoney() const;
+
+    /**
+     * Sets the player money amount
+     *
+     * @param newMoney to set
+     */
+    void setMoney(money_t newMoney);
+
+    /** @return energy generated by player entities */
+    entity_energy_t getEnergyGeneration() const;
+
+    /**
+     * Sets the energy generated by player entities
+     *
+     * @param newEnergyGeneration to set
+     */
+    void setEnergyGeneration(entity_energy_t newEnergyGeneration);
+
+    /** @return energy left after satisfying entities */
+    entity_energy_t getEnergyPool() const;
+
+    /**
+     * Sets the energy left after satisfying entities
+     *
+     * @param newEnergyPool to set
+     */
+    void setEnergyPool(entity_energy_t newEnergyPool);
+
+    /**
+     * Adds entity to energy ledger
+     *
+     * @param entityId of entity
+     * @param component of entity energy
+     */
+    void addEnergyEntity(entity_id_t entityId, EnergyComponent* component);
+
+    /**
+     * Removes entity from energy ledger
+     *
+     * @param entityId of entity
+     */
+    void removeEnergyEntity(entity_id_t entityId);
+
+    /**
+     * Called when energy of a entity in ledger changed so energy is distributed again in next update
+     */
+    void energyChanged();
+
+    /**
+     * Writes the player state, colors are not included as they come from simulation parameters
+     *
+     * @param writer to write into
+     */
+    void saveState(SaveWriter& writer) const;
+
+    /**
+     * Reads the player state, id is read by simulation before calling this
+     *
+     * @param reader to read from
+     */
+    void loadState(SaveReader& reader);
+
+    /**
+     * Distributes the player energy if ledger changed, entities are satisfied in priority order until energy runs out
      */
     void update();
 };
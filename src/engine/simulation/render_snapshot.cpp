@@ -0,0 +1,62 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <algorithm>
+#include "engine/graphics/palette.h"
+#include "render_snapshot.h"
+
+void RenderSnapshot::clear() {
+    entities.clear();
+    sprites.clear();
+    tilesRectangle.set(0);
+    tileImages.clear();
+}
+
+RenderSnapshotEntity& RenderSnapshot::addEntity() {
+    RenderSnapshotEntity& entity = entities.emplace_back();
+    entity.spritesStart = sprites.size();
+    return entity;
+}
+
+RenderSnapshotSprite& RenderSnapshot::addSprite() {
+    if (!entities.empty()) {
+        entities.back().spritesCount++;
+    }
+    return sprites.emplace_back();
+}
+
+RenderSnapshotBuffer::RenderSnapshotBuffer() {
+    front = std::make_unique<RenderSnapshot>();
+    back = std::make_unique<RenderSnapshot>();
+}
+
+RenderSnapshot& RenderSnapshotBuffer::getBack() {
+    return *back;
+}
+
+void RenderSnapshotBuffer::publish() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::swap(front, back);
+    publishTimer.update();
+}
+
+std::unique_lock<std::mutex> RenderSnapshotBuffer::lockFront() {
+    return std::unique_lock<std::mutex>(mutex);
+}
+
+const RenderSnapshot& RenderSnapshotBuffer::getFront() const {
+    return *front;
+}
+
+float RenderSnapshotBuffer::getInterpolation(float updateDelta) {
+    return std::min(1.0f, publishTimer.elapsed() / updateDelta);
+}
+
+void RenderSnapshotBuffer::setVisibleRectangle(const Rectangle& rectangle) {
+    visibleRectangle.set(rectangle);
+}
+
+void RenderSnapshotBuffer::getVisibleRectangle(Rectangle& rectangle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    rectangle.set(visibleRectangle);
+}
@@ -0,0 +1,222 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_RENDER_SNAPSHOT_H
+#define OPENE2140_RENDER_SNAPSHOT_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include "engine/core/types.h"
+#include "engine/core/macros.h"
+#include "engine/math/rectangle.h"
+#include "engine/io/timer.h"
+
+class Image;
+class Palette;
+
+/**
+ * Sprite captured from a entity to be drawn
+ */
+struct RenderSnapshotSprite {
+    /**
+     * Image to draw
+     */
+    Image* image = nullptr;
+
+    /**
+     * Extra palette to use when drawing image if any
+     */
+    std::shared_ptr<Palette> palette;
+
+    /**
+     * Image offset from entity center
+     */
+    Vector2 offset;
+
+    /**
+     * Image size, negative if flipped
+     */
+    Vector2 size;
+
+    /**
+     * Image angle
+     */
+    float angle = 0;
+
+    /**
+     * Image centered to position state
+     */
+    bool centered = true;
+};
+
+/**
+ * Entity state captured at end of simulation update
+ */
+struct RenderSnapshotEntity {
+    /**
+     * Entity ID
+     */
+    entity_id_t id = 0;
+
+    /**
+     * Entity position at previous update
+     */
+    Vector2 lastPosition;
+
+    /**
+     * Entity position at this update
+     */
+    Vector2 position;
+
+    /**
+     * Entity bounds at this update
+     */
+    Rectangle bounds;
+
+    /**
+     * Index of first sprite of this entity in snapshot sprites
+     */
+    size_t spritesStart = 0;
+
+    /**
+     * Amount of sprites of this entity
+     */
+    size_t spritesCount = 0;
+};
+
+/**
+ * Compact state of visible tiles and entities so renderer doesn't need to access live simulation state
+ */
+class RenderSnapshot {
+public:
+    /**
+     * Captured entities in drawing order
+     */
+    std::vector<RenderSnapshotEntity> entities;
+
+    /**
+     * Captured sprites for all entities
+     */
+    std::vector<RenderSnapshotSprite> sprites;
+
+    /**
+     * Area of captured tiles in tile units
+     */
+    Rectangle tilesRectangle;
+
+    /**
+     * Images of captured tiles row by row, null if tile has no image
+     */
+    std::vector<Image*> tileImages;
+
+    /**
+     * Clears the snapshot content while keeping the memory
+     */
+    void clear();
+
+    /**
+     * Adds a entity to snapshot, subsequent sprites will belong to this entity
+     *
+     * @return entity entry to fill
+     */
+    RenderSnapshotEntity& addEntity();
+
+    /**
+     * Adds a sprite to last added entity
+     *
+     * @return sprite entry to fill
+     */
+    RenderSnapshotSprite& addSprite();
+};
+
+/**
+ * Double buffer of render snapshots
+ *
+ * Simulation writes the back snapshot during update and publishes it when done,
+ * renderer reads the front snapshot which is never written while locked
+ */
+class RenderSnapshotBuffer {
+private:
+    /**
+     * Guards the front snapshot and the swap
+     */
+    std::mutex mutex;
+
+    /**
+     * Snapshot being read by renderer
+     */
+    std::unique_ptr<RenderSnapshot> front;
+
+    /**
+     * Snapshot being written by simulation
+     */
+    std::unique_ptr<RenderSnapshot> back;
+
+    /**
+     * Measures time since last publish for interpolation
+     */
+    Timer publishTimer;
+
+    /**
+     * Rectangle that was drawn by renderer, guarded by mutex
+     */
+    Rectangle visibleRectangle;
+
+public:
+    /**
+     * Constructor
+     */
+    RenderSnapshotBuffer();
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(RenderSnapshotBuffer)
+
+    /**
+     * @return snapshot to write, must be only called by simulation
+     */
+    RenderSnapshot& getBack();
+
+    /**
+     * Swaps back with front snapshot, waits if front is locked
+     */
+    void publish();
+
+    /**
+     * Locks the front snapshot for reading
+     *
+     * @return lock to hold while reading
+     */
+    std::unique_lock<std::mutex> lockFront();
+
+    /**
+     * @return snapshot to read, lock must be held
+     */
+    const RenderSnapshot& getFront() const;
+
+    /**
+     * Calculates the interpolation between previous and current update positions, lock must be held
+     *
+     * @param updateDelta time between updates in seconds
+     * @return interpolation alpha in [0, 1] range
+     */
+    float getInterpolation(float updateDelta);
+
+    /**
+     * Sets the rectangle drawn by renderer so simulation can discard entities outside, lock must be held
+     *
+     * @param rectangle drawn
+     */
+    void setVisibleRectangle(const Rectangle& rectangle);
+
+    /**
+     * Obtains the last rectangle drawn by renderer
+     *
+     * @param rectangle to store it
+     */
+    void getVisibleRectangle(Rectangle& rectangle);
+};
+
+#endif //OPENE2140_RENDER_SNAPSHOT_H
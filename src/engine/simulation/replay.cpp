@@ -0,0 +1,85 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include "engine/io/config.h"
+#include "replay.h"
+
+void Replay::read(const std::string& path) {
+    Config config(path);
+    config.read();
+    error = config.getError();
+    if (hasError()) {
+        return;
+    }
+    config_data_t& data = config.data;
+    if (!data.is_object()) {
+        error = "Replay root is not object";
+        return;
+    }
+    int version = data.value("version", 0);
+    if (version != REPLAY_VERSION) {
+        error = "Replay version " + std::to_string(version) + " is not supported";
+        return;
+    }
+    seed = data.value("seed", 0L);
+    world = data.value("world", "");
+    pathfinderBudget = data.value("pathfinder_budget", static_cast<unsigned int>(PATHFINDER_DEFAULT_BUDGET));
+    testEntities = data.value("test_entities", false);
+    save = data.value("save", "");
+    startTick = data.value("start_tick", static_cast<uint64_t>(0));
+    ticks = data.value("ticks", static_cast<uint64_t>(0));
+    hash = data.value("hash", static_cast<uint64_t>(0));
+    hashes = data.value("hashes", std::vector<uint64_t>());
+    if (ticks < startTick) {
+        error = "Replay ends before it starts";
+        return;
+    }
+
+    //Each command is stored as [tick, type, entity, target] to keep file compact, group commands add the members
+    commands.clear();
+    for (const config_data_t& entry : data["commands"]) {
+        if (!entry.is_array() || entry.size() < 4) {
+            error = "Replay command is invalid";
+            return;
+        }
+        SimulationCommand command;
+        command.tick = entry[0].get<uint64_t>();
+        command.type = static_cast<SimulationCommandType>(entry[1].get<int>());
+        command.entity = entry[2].get<entity_id_t>();
+        command.target = entry[3].get<uint64_t>();
+        if (4 < entry.size()) {
+            command.group = entry[4].get<std::vector<entity_id_t>>();
+        }
+        if (!commands.empty() && command.tick < commands.back().tick) {
+            error = "Replay commands are not in order";
+            return;
+        }
+        commands.push_back(command);
+    }
+}
+
+void Replay::write(const std::string& path) {
+    Config config(path);
+    config_data_t& data = config.data;
+    data["version"] = REPLAY_VERSION;
+    data["seed"] = seed;
+    data["world"] = world;
+    data["pathfinder_budget"] = pathfinderBudget;
+    data["test_entities"] = testEntities;
+    data["save"] = save;
+    data["start_tick"] = startTick;
+    data["ticks"] = ticks;
+    data["hash"] = hash;
+    data["hashes"] = hashes;
+    config_data_t entries = config_data_t::array();
+    for (const SimulationCommand& command : commands) {
+        config_data_t entry = {command.tick, static_cast<int>(command.type), command.entity, command.target};
+        if (!command.group.empty()) {
+            entry.push_back(command.group);
+        }
+        entries.push_back(std::move(entry));
+    }
+    data["commands"] = std::move(entries);
+    config.write();
+    error = config.getError();
+}
@@ -0,0 +1,131 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_REPLAY_H
+#define OPENE2140_REPLAY_H
+
+#include <string>
+#include <vector>
+#include "engine/core/macros.h"
+#include "engine/core/common.h"
+#include "engine/core/types.h"
+#include "engine/core/error_possible.h"
+
+/** Version of replay format, replays with different version are rejected */
+#define REPLAY_VERSION 5
+/** Amount of ticks since recording start between each stored state hash */
+#define REPLAY_HASH_INTERVAL 60
+/** Default name of file in user path where replays are recorded */
+#define REPLAY_DEFAULT_FILE "replay.json"
+
+/**
+ * Type of command issued to simulation
+ */
+enum class SimulationCommandType {
+    Move = 0,
+    Follow = 1,
+    MoveGroup = 2,
+};
+
+/**
+ * Order issued to simulation from outside, such as by a player
+ */
+struct SimulationCommand {
+    /** Type of command */
+    SimulationCommandType type = SimulationCommandType::Move;
+    /** Entity that receives the command */
+    entity_id_t entity = 0;
+    /** Command target, tile index or entity id depending on type */
+    uint64_t target = 0;
+    /** Amount of simulation updates done when command was issued */
+    uint64_t tick = 0;
+    /** Other entities that receive the command together with entity */
+    std::vector<entity_id_t> group;
+};
+
+/**
+ * Stores the simulation parameters and commands issued during a simulation so it can be replayed
+ */
+class Replay: public IErrorPossible {
+public:
+    /**
+     * Seed of simulation parameters
+     */
+    long seed = 0;
+
+    /**
+     * World of simulation parameters
+     */
+    asset_path_t world;
+
+    /**
+     * Pathfinder budget of simulation parameters
+     */
+    unsigned int pathfinderBudget = PATHFINDER_DEFAULT_BUDGET;
+
+    /**
+     * Test entities flag of simulation parameters
+     */
+    bool testEntities = false;
+
+    /**
+     * Save loaded before recording started, empty if simulation started from world
+     */
+    std::string save;
+
+    /**
+     * Simulation tick when recording started
+     */
+    uint64_t startTick = 0;
+
+    /**
+     * Simulation tick when recording stopped
+     */
+    uint64_t ticks = 0;
+
+    /**
+     * Simulation state hash at end of recording
+     */
+    uint64_t hash = 0;
+
+    /**
+     * Simulation state hashes stored each REPLAY_HASH_INTERVAL ticks since start tick
+     */
+    std::vector<uint64_t> hashes;
+
+    /**
+     * Commands in order they were issued
+     */
+    std::vector<SimulationCommand> commands;
+
+    /**
+     * Constructor
+     */
+    Replay() = default;
+
+    /**
+     * Destructor
+     */
+    ~Replay() override = default;
+
+    /**
+     * Disable copy
+     */
+    NON_COPYABLE(Replay)
+
+    /**
+     * Loads replay from file
+     *
+     * @param path of file
+     */
+    void read(const std::string& path);
+
+    /**
+     * Writes replay into file
+     *
+     * @param path of file
+     */
+    void write(const std::string& path);
+};
+
+#endif //OPENE2140_REPLAY_H
@@ -0,0 +1,187 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <cstdio>
+#include "engine/core/utils.h"
+#include "engine/io/file.h"
+#include "engine/io/log.h"
+#include "save_stream.h"
+
+SaveWriter::SaveWriter() {
+    file = std::make_unique<File>();
+}
+
+SaveWriter::~SaveWriter() {
+    //Close without placing the incomplete save
+    file->close();
+    if (!pathTemporary.empty()) {
+        std::remove(pathTemporary.c_str());
+    }
+}
+
+void SaveWriter::open(const std::string& savePath) {
+    path = savePath;
+    pathTemporary = savePath + ".tmp";
+    file->fromPath(pathTemporary, File::FileMode::Write);
+    error = file->getError();
+    if (hasError()) {
+        return;
+    }
+    buffer.reserve(SAVE_WRITER_BUFFER_SIZE);
+    written = 0;
+    writeBytes(SAVE_MAGIC, SAVE_MAGIC_SIZE);
+    write<uint32_t>(SAVE_VERSION);
+}
+
+void SaveWriter::close() {
+    if (!blocks.empty()) {
+        error = "Save has unclosed blocks";
+    }
+    if (!hasError()) {
+        flush();
+    }
+    file->close();
+    if (hasError()) {
+        return;
+    }
+
+    //Replace the old save with the completed one
+    std::remove(path.c_str());
+    if (std::rename(pathTemporary.c_str(), path.c_str()) != 0) {
+        error = "Couldn't move save into " + path;
+        return;
+    }
+    pathTemporary.clear();
+}
+
+void SaveWriter::flush() {
+    if (buffer.empty() || hasError()) {
+        return;
+    }
+    if (!blocks.empty()) {
+        LOG_BUG("Save flush requested while blocks are open");
+        return;
+    }
+    size_t amount = file->write(buffer.data(), buffer.size());
+    if (amount != buffer.size()) {
+        error = file->getError();
+        if (!hasError()) {
+            error = "Couldn't write save data";
+        }
+    }
+    written += amount;
+    buffer.clear();
+}
+
+size_t SaveWriter::getSize() const {
+    return written + buffer.size();
+}
+
+void SaveWriter::writeBytes(const void* bytes, size_t amount) {
+    const byte_t* start = static_cast<const byte_t*>(bytes);
+    buffer.insert(buffer.end(), start, start + amount);
+
+    //Write buffered data once is big enough, blocks sizes are written afterwards so they must stay in buffer
+    if (SAVE_WRITER_BUFFER_SIZE <= buffer.size() && blocks.empty()) {
+        flush();
+    }
+}
+
+void SaveWriter::writeString(const std::string& value) {
+    write<uint32_t>(static_cast<uint32_t>(value.size()));
+    writeBytes(value.data(), value.size());
+}
+
+void SaveWriter::beginBlock() {
+    blocks.push_back(buffer.size());
+    write<uint32_t>(0);
+}
+
+void SaveWriter::endBlock() {
+    if (blocks.empty()) {
+        LOG_BUG("Save block ended without being started");
+        return;
+    }
+    size_t start = blocks.back();
+    blocks.pop_back();
+    uint32_t blockSize = static_cast<uint32_t>(buffer.size() - start - sizeof(uint32_t));
+    std::memcpy(&buffer[start], &blockSize, sizeof(uint32_t));
+    if (SAVE_WRITER_BUFFER_SIZE <= buffer.size() && blocks.empty()) {
+        flush();
+    }
+}
+
+void SaveReader::open(const std::string& savePath) {
+    //Load whole save in a single read
+    File file;
+    file.fromPath(savePath, File::FileMode::Read);
+    error = file.getError();
+    if (hasError()) {
+        return;
+    }
+    long fileSize = file.size();
+    if (fileSize < 0) {
+        error = "Couldn't get save size\n" + file.getError();
+        return;
+    }
+    size = static_cast<size_t>(fileSize);
+    data = Utils::createBuffer(size);
+    if (file.read(data.get(), size) != size) {
+        error = "Couldn't read save\n" + file.getError();
+        return;
+    }
+    file.close();
+    position = 0;
+
+    //Check header
+    const byte_t* magic = readBytes(SAVE_MAGIC_SIZE);
+    if (!magic || std::memcmp(magic, SAVE_MAGIC, SAVE_MAGIC_SIZE) != 0) {
+        error = "File is not a save";
+        return;
+    }
+    uint32_t version = read<uint32_t>();
+    if (version != SAVE_VERSION) {
+        error = "Save version " + std::to_string(version) + " is not supported";
+        return;
+    }
+}
+
+const byte_t* SaveReader::readBytes(size_t amount) {
+    size_t end = blocks.empty() ? size : blocks.back();
+    if (hasError() || end < position + amount) {
+        if (!hasError()) {
+            error = "Save data ended unexpectedly";
+        }
+        return nullptr;
+    }
+    const byte_t* bytes = data.get() + position;
+    position += amount;
+    return bytes;
+}
+
+std::string SaveReader::readString() {
+    uint32_t length = read<uint32_t>();
+    const byte_t* bytes = readBytes(length);
+    if (!bytes) {
+        return "";
+    }
+    return std::string(reinterpret_cast<const char*>(bytes), length);
+}
+
+void SaveReader::beginBlock() {
+    uint32_t blockSize = read<uint32_t>();
+    size_t end = blocks.empty() ? size : blocks.back();
+    if (!hasError() && end < position + blockSize) {
+        error = "Save block exceeds data";
+    }
+    blocks.push_back(hasError() ? position : position + blockSize);
+}
+
+void SaveReader::endBlock() {
+    if (blocks.empty()) {
+        LOG_BUG("Save block ended without being started");
+        return;
+    }
+    position = blocks.back();
+    blocks.pop_back();
+}
@@ -0,0 +1,230 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_SAVE_STREAM_H
+#define OPENE2140_SAVE_STREAM_H
+
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "engine/core/macros.h"
+#include "engine/core/types.h"
+#include "engine/core/error_possible.h"
+
+class File;
+
+/** Magic at start of every save file */
+#define SAVE_MAGIC "OE2140SV"
+/** Size of save magic */
+#define SAVE_MAGIC_SIZE 8
+/** Version of save format, saves with different version are rejected */
+#define SAVE_VERSION 3
+/** Amount of bytes buffered by writer before being written to file */
+#define SAVE_WRITER_BUFFER_SIZE (256 * 1024)
+/** Name of file in user path where autosaves are written */
+#define SAVE_AUTOSAVE_FILE "autosave.sav"
+
+/**
+ * Writes a binary save into a file, data is buffered and written in big chunks as it's produced
+ *
+ * Values are written in native byte order, save files are not meant to be moved between different endianness
+ */
+class SaveWriter: public IErrorPossible {
+private:
+    /**
+     * File being written
+     */
+    std::unique_ptr<File> file;
+
+    /**
+     * Path where save is placed once completed
+     */
+    std::string path;
+
+    /**
+     * Path being written until save is completed, avoids leaving corrupted saves if interrupted
+     */
+    std::string pathTemporary;
+
+    /**
+     * Data pending to be written into file
+     */
+    std::vector<byte_t> buffer;
+
+    /**
+     * Positions in buffer of size placeholders of blocks that are open
+     */
+    std::vector<size_t> blocks;
+
+    /**
+     * Total amount of bytes written into file
+     */
+    size_t written = 0;
+
+public:
+    /**
+     * Constructor
+     */
+    SaveWriter();
+
+    /**
+     * Destructor
+     */
+    ~SaveWriter() override;
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(SaveWriter)
+
+    /**
+     * Opens the file to write save and writes the header
+     *
+     * @param savePath of file
+     */
+    void open(const std::string& savePath);
+
+    /**
+     * Writes any pending data and places the save in the path
+     */
+    void close();
+
+    /**
+     * Writes pending data into file, blocks must not be open
+     */
+    void flush();
+
+    /**
+     * @return total amount of bytes written so far
+     */
+    size_t getSize() const;
+
+    /**
+     * Writes raw bytes
+     *
+     * @param data to write
+     * @param amount of bytes
+     */
+    void writeBytes(const void* data, size_t amount);
+
+    /**
+     * Writes a value as is
+     *
+     * @param value to write
+     */
+    template<typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "Value must be trivially copyable");
+        writeBytes(&value, sizeof(T));
+    }
+
+    /**
+     * Writes a string with its length
+     *
+     * @param value to write
+     */
+    void writeString(const std::string& value);
+
+    /**
+     * Starts a block which size is written before its content so it can be skipped when reading
+     */
+    void beginBlock();
+
+    /**
+     * Ends the last started block
+     */
+    void endBlock();
+};
+
+/**
+ * Reads a binary save, whole file is loaded at once and values are read directly from loaded data
+ */
+class SaveReader: public IErrorPossible {
+private:
+    /**
+     * Save content
+     */
+    std::unique_ptr<byte_array_t> data;
+
+    /**
+     * Size of content
+     */
+    size_t size = 0;
+
+    /**
+     * Current read position
+     */
+    size_t position = 0;
+
+    /**
+     * End positions of blocks that are open
+     */
+    std::vector<size_t> blocks;
+
+public:
+    /**
+     * Constructor
+     */
+    SaveReader() = default;
+
+    /**
+     * Destructor
+     */
+    ~SaveReader() override = default;
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(SaveReader)
+
+    /**
+     * Loads the save from file and checks the header
+     *
+     * @param savePath of file
+     */
+    void open(const std::string& savePath);
+
+    /**
+     * Obtains bytes from save without copying
+     *
+     * @param amount of bytes
+     * @return pointer to bytes or null if there is not enough data
+     */
+    const byte_t* readBytes(size_t amount);
+
+    /**
+     * Reads a value, if there is not enough data a default value is returned and error is set
+     *
+     * @return value read
+     */
+    template<typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable_v<T>, "Value must be trivially copyable");
+        T value{};
+        const byte_t* bytes = readBytes(sizeof(T));
+        if (bytes) {
+            std::memcpy(&value, bytes, sizeof(T));
+        }
+        return value;
+    }
+
+    /**
+     * Reads a string with its length
+     *
+     * @return string read
+     */
+    std::string readString();
+
+    /**
+     * Starts reading a block
+     */
+    void beginBlock();
+
+    /**
+     * Ends the last started block, any unread data in block is skipped
+     */
+    void endBlock();
+};
+
+#endif //OPENE2140_SAVE_STREAM_H
@@ -2,16 +2,29 @@
 // Created by Ion Agorria on 1/11/18
 //
 
-#include "engine/core/utils.h"
+#include <algorithm>
+#include <map>
 #include "engine/core/engine.h"
+#include "engine/core/job_system.h"
+#include "engine/core/profiler.h"
+#include "engine/io/metrics.h"
+#include "engine/io/scheduler.h"
 #include "engine/graphics/renderer.h"
+#include "engine/graphics/palette.h"
 #include "faction.h"
 #include "player.h"
 #include "entity.h"
 #include "entity_store.h"
+#include "render_snapshot.h"
+#include "save_stream.h"
 #include "components/player_component.h"
 #include "src/engine/entities/entity_manager.h"
+#include "engine/entities/entity_pool.h"
+#include "engine/entities/entity_config.h"
 #include "world/world.h"
+#include "pathfinder/path_scheduler.h"
+#include "pathfinder/reservation_table.h"
+#include "world/tile.h"
 #include "engine/assets/asset.h"
 #include "engine/assets/asset_level.h"
 #include "simulation.h"
@@ -19,11 +32,19 @@
 Simulation::Simulation(std::shared_ptr<Engine> engine, std::unique_ptr<SimulationParameters> parameters):
         parameters(std::move(parameters)), engine(std::move(engine)) {
     log = Log::get("Simulation");
-    debugEntities = Utils::isFlag(FLAG_DEBUG_ALL);
+    renderSnapshots = std::make_unique<RenderSnapshotBuffer>();
+    Metrics* metrics = this->engine->getMetrics();
+    if (metrics) {
+        metricEntities = metrics->gauge(METRIC_ENTITIES);
+        metricPathRequests = metrics->gauge(METRIC_PATH_REQUESTS);
+        metricExpansions = metrics->histogram(METRIC_ASTAR_EXPANSIONS);
+    }
     if (!this->parameters || this->parameters->world.empty()) {
         error = "Parameters not set";
         return;
     }
+    debugEntities = this->parameters->debugAll;
+    pathScheduler = std::make_unique<PathScheduler>(this->parameters->pathfinderBudget);
     //Load asset
     assetLevel = this->engine->getAssetManager()->getAsset<AssetLevel>(this->parameters->world);
     if (!assetLevel) {
@@ -50,13 +71,19 @@ void Simulation::loadWorld() {
     }
 
     //Create world
-    world = std::make_unique<World>(assetLevel, tilesetImages);
+    world = std::make_unique<World>(assetLevel, tilesetImages, parameters->debug, parameters->debugAll);
     error = world->getError();
     if (hasError()) {
         return;
     }
     tileSize = world->getTileSize();
     tileSizeHalf = tileSize / 2;
+    reservations = std::make_unique<ReservationTable>(world->getTiles().size());
+
+    //Let tiles update the state hash when their entity flags change
+    for (std::unique_ptr<Tile>& tile : world->getTiles()) {
+        tile->stateHash = &stateHash;
+    }
 }
 
 void Simulation::loadPlayers() {
@@ -88,7 +115,7 @@ void Simulation::loadPlayers() {
                 addPlayer(std::move(playerPtr));
             }
             player->enemies = playerPrototype.enemies;
-            player->money = playerPrototype.money;
+            player->setMoney(playerPrototype.money);
             player->faction = faction;
         }
     }
@@ -105,6 +132,20 @@ void Simulation::loadEntities() {
         if (hasError()) {
             return;
         }
+        //Count entities of each type so pools can be prewarmed before creation
+        std::map<std::pair<entity_kind_t, entity_type_id_t>, size_t> typeCounts;
+        for (EntityPrototype& entityPrototype : levelEntities) {
+            if (entityPrototype.exists) {
+                typeCounts[{entityPrototype.type.kind, entityPrototype.type.id}]++;
+            }
+        }
+        EntityManager* entityManager = engine->getEntityManager();
+        std::vector<std::pair<IEntityPool*, size_t>> poolCounts;
+        for (auto& pair : typeCounts) {
+            poolCounts.emplace_back(entityManager->getEntityPool({pair.first.first, pair.first.second}), pair.second);
+        }
+        IEntityPool::prewarm(poolCounts);
+
         for (EntityPrototype& entityPrototype : levelEntities) {
             if (!entityPrototype.exists) {
                 //TODO these should be stored for later use
@@ -115,6 +156,155 @@ void Simulation::loadEntities() {
     }
 }
 
+void Simulation::save(SaveWriter& writer) {
+    PROFILE_ZONE("Simulation::save");
+    //Parameters required to create the simulation before loading
+    writer.write<int64_t>(parameters->seed);
+    writer.writeString(parameters->world);
+    writer.write<uint32_t>(parameters->pathfinderBudget);
+
+    //Simulation state
+    writer.write<uint64_t>(tick);
+    writer.write<entity_id_t>(entityStore->getLastEntityID());
+    writer.write<uint64_t>(stateHash.get());
+
+    //Players
+    uint32_t playersCount = 0;
+    for (const std::unique_ptr<Player>& player : players) {
+        if (player) playersCount++;
+    }
+    writer.write<uint32_t>(playersCount);
+    for (const std::unique_ptr<Player>& player : players) {
+        if (player) {
+            writer.write<player_id_t>(player->id);
+            player->saveState(writer);
+        }
+    }
+
+    //Tiles
+    std::vector<std::unique_ptr<Tile>>& tiles = world->getTiles();
+    writer.write<uint32_t>(static_cast<uint32_t>(tiles.size()));
+    for (const std::unique_ptr<Tile>& tile : tiles) {
+        writer.write<uint32_t>(tile->tilesetIndex);
+        writer.write<tile_flags_t>(tile->tileFlags);
+        writer.write<money_t>(tile->ore);
+    }
+
+    //Entity types first so all entities can be created before reading their state which may reference others
+    const std::vector<std::shared_ptr<Entity>>& entities = entityStore->getEntities();
+    writer.write<uint32_t>(static_cast<uint32_t>(entities.size()));
+    for (const std::shared_ptr<Entity>& entity : entities) {
+        const EntityConfig* config = entity->getConfig();
+        Entity* parent = entity->getParent();
+        writer.write<entity_id_t>(entity->getID());
+        writer.write<entity_kind_t>(config->kind);
+        writer.write<entity_type_id_t>(config->id);
+        writer.write<entity_id_t>(parent ? parent->getID() : 0);
+    }
+    for (const std::shared_ptr<Entity>& entity : entities) {
+        writer.write<entity_id_t>(entity->getID());
+        entity->saveState(writer);
+    }
+}
+
+void Simulation::loadParameters(SaveReader& reader, SimulationParameters& parameters) {
+    parameters.seed = static_cast<long>(reader.read<int64_t>());
+    parameters.world = reader.readString();
+    parameters.pathfinderBudget = reader.read<uint32_t>();
+    //Entities come from save instead
+    parameters.loadLevelContent = false;
+}
+
+void Simulation::load(SaveReader& reader) {
+    PROFILE_ZONE("Simulation::load");
+    tick = reader.read<uint64_t>();
+    entity_id_t lastEntityID = reader.read<entity_id_t>();
+    uint64_t savedHash = reader.read<uint64_t>();
+
+    //Players
+    uint32_t playersCount = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < playersCount && !reader.hasError(); ++i) {
+        player_id_t id = reader.read<player_id_t>();
+        Player* player = getPlayer(id);
+        if (!player) {
+            std::unique_ptr<Player> playerPtr = std::make_unique<Player>(id);
+            player = playerPtr.get();
+            addPlayer(std::move(playerPtr));
+        }
+        player->loadState(reader);
+    }
+
+    //Tiles
+    std::vector<std::unique_ptr<Tile>>& tiles = world->getTiles();
+    uint32_t tilesCount = reader.read<uint32_t>();
+    if (!reader.hasError() && tilesCount != tiles.size()) {
+        error = "Save world has " + std::to_string(tilesCount) + " tiles but world has " + std::to_string(tiles.size());
+        return;
+    }
+    for (uint32_t i = 0; i < tilesCount && !reader.hasError(); ++i) {
+        Tile* tile = tiles[i].get();
+        TilePrototype prototype;
+        prototype.tilesetIndex = reader.read<uint32_t>();
+        prototype.tileFlags = reader.read<tile_flags_t>();
+        prototype.ore = reader.read<money_t>();
+        if (tile->tilesetIndex != prototype.tilesetIndex || tile->tileFlags != prototype.tileFlags) {
+            tile->isImageDirty = true;
+        }
+        tile->setPrototype(prototype);
+    }
+
+    //Create root entities with their original id, attached entities are created by their parent right after it
+    uint32_t entitiesCount = reader.read<uint32_t>();
+    std::vector<entity_id_t> entityIDs;
+    for (uint32_t i = 0; i < entitiesCount && !reader.hasError(); ++i) {
+        entity_id_t id = reader.read<entity_id_t>();
+        entity_type_t type;
+        type.kind = reader.read<entity_kind_t>();
+        type.id = reader.read<entity_type_id_t>();
+        entity_id_t parentID = reader.read<entity_id_t>();
+        entityIDs.push_back(id);
+        if (parentID || reader.hasError()) {
+            continue;
+        }
+        entityStore->setLastEntityID(id - 1);
+        std::shared_ptr<Entity> entity = createEntity(type, true);
+        if (!entity || entity->getID() != id) {
+            error = "Couldn't restore entity " + std::to_string(id) + " of type " + std::to_string(type.kind) + ":" + std::to_string(type.id);
+            return;
+        }
+    }
+    entityStore->setLastEntityID(lastEntityID);
+    for (entity_id_t id : entityIDs) {
+        if (!entityStore->getEntity(id)) {
+            error = "Attached entity " + std::to_string(id) + " was not restored";
+            return;
+        }
+    }
+
+    //Read each entity state now that all are present
+    for (uint32_t i = 0; i < entitiesCount && !reader.hasError(); ++i) {
+        entity_id_t id = reader.read<entity_id_t>();
+        std::shared_ptr<Entity> entity = entityStore->getEntity(id);
+        if (!entity) {
+            error = "Save contains state for unknown entity " + std::to_string(id);
+            return;
+        }
+        entity->loadState(reader);
+    }
+    error = reader.getError();
+    if (hasError()) {
+        return;
+    }
+
+    //State hash covers what was restored so it must match unless save is incomplete
+    if (stateHash.get() != savedHash) {
+        log->warn("Loaded state hash {0:x} differs from saved {1:x}", stateHash.get(), savedHash);
+    }
+    if (getRenderer()) {
+        publishSnapshot();
+    }
+}
+
 Simulation::~Simulation() {
     close();
 }
@@ -128,9 +318,11 @@ void Simulation::close() {
         }
         entityStore->clear();
     }
+    updateEntities.clear();
+    wokenEntities.clear();
     for (std::unique_ptr<Player>& player : players) {
         if (player) {
-            player->simulation = nullptr;
+            player->setSimulation(nullptr);
         }
     }
     players.clear();
@@ -138,10 +330,14 @@ void Simulation::close() {
     if (world) {
         world.reset();
     }
+    reservations.reset();
 }
 
 void Simulation::update() {
+    PROFILE_ZONE("Simulation::update");
+    updating = true;
     world->update();
+    reservations->update(tick);
 
     //Update players
     for (const std::unique_ptr<Player>& player : players) {
@@ -150,47 +346,231 @@ void Simulation::update() {
         }
     }
 
+    //Pathfinders of all players share the budget
+    size_t expansions = pathScheduler->update(players, tick);
+    size_t pathRequests = 0;
+    for (const std::unique_ptr<Player>& player : players) {
+        if (player) {
+            pathRequests += player->pathHandler->getRequestsCount();
+        }
+    }
+    //Pathfinders have repaired their searches with the changes
+    world->clearChangedTiles();
+    reservations->clearChangedTiles();
+    if (metricExpansions) {
+        metricExpansions->record(static_cast<double>(expansions));
+        metricPathRequests->set(static_cast<double>(pathRequests));
+        metricEntities->set(static_cast<double>(entityStore->getEntities().size()));
+    }
+
+    //Woken entities join the awake ones, ids follow the store order so sorting keeps updates in entity order
+    if (!wokenEntities.empty()) {
+        updateEntities.insert(updateEntities.end(), wokenEntities.begin(), wokenEntities.end());
+        wokenEntities.clear();
+        std::sort(updateEntities.begin(), updateEntities.end(), [](const Entity* a, const Entity* b) {
+            return (a ? a->getID() : 0) < (b ? b->getID() : 0);
+        });
+        //Entities woken after sleeping in same update are present twice
+        updateEntities.erase(std::unique(updateEntities.begin(), updateEntities.end()), updateEntities.end());
+    }
     std::vector<std::shared_ptr<Entity>> toRemove;
-    for (const std::shared_ptr<Entity>& entity : entityStore->getEntities()) {
+    auto last = std::remove_if(updateEntities.begin(), updateEntities.end(), [&](Entity* entity) {
+        //Removed from simulation
+        if (!entity) {
+            return true;
+        }
+
         //Parent already handles their entities
         if (entity->getParent()) {
-            continue;
+            entity->sleep();
+            return true;
         }
 
         //Entity is destroyed
         if (entity->isDestroyed()) {
-            toRemove.emplace_back(entity);
+            toRemove.emplace_back(entity->getEntityPtr());
+            return true;
+        }
+        return false;
+    });
+    updateEntities.erase(last, updateEntities.end());
+
+    //Update entities by phases, these only modify their own entity so can run in parallel
+    updatePhase(&Entity::updatePlan);
+    updatePhase(&Entity::updateIntegrate);
+    updatePhase(&Entity::updateAnimate);
+
+    //Commit phase runs sequentially in entity order so changes in shared state are deterministic
+    for (Entity* entity : updateEntities) {
+        if (!entity) {
             continue;
         }
-
-        //Update entity
         entity->update();
+
+        //Entity sleeps until something wakes it, changes done by later entities wake it again
+        if (!entity->hasPendingWork()) {
+            entity->sleep();
+        }
     }
 
     //Remove entities
     for (const std::shared_ptr<Entity>& entity : toRemove) {
         removeEntity(entity);
     }
+    updateEntities.erase(std::remove_if(updateEntities.begin(), updateEntities.end(), [](Entity* entity) {
+        return !entity || entity->isSleeping();
+    }), updateEntities.end());
+
+    //Publish the new state for drawing, not needed when there is nothing to draw such as headless replays
+    if (getRenderer()) {
+        publishSnapshot();
+    }
+    tick++;
+    updating = false;
+
+    //Store the state hash periodically so replays can detect where they diverge
+    if (recording && (tick - recording->startTick) % REPLAY_HASH_INTERVAL == 0) {
+        recording->hashes.push_back(stateHash.get());
+    }
 }
 
-void Simulation::draw(const Rectangle& rectangle, std::vector<std::shared_ptr<Entity>>& visibleEntities) {
-    //Draw world
-    Renderer* renderer = getRenderer();
-    world->draw(renderer, rectangle);
+void Simulation::updatePhase(void (Entity::*phase)()) {
+    PROFILE_ZONE("Simulation::updatePhase");
+    JobSystem* jobSystem = engine->getJobSystem();
+    if (!jobSystem || !parameters->parallelUpdates || updateEntities.size() < SIMULATION_PARALLEL_MIN_ENTITIES) {
+        for (Entity* entity : updateEntities) {
+            (entity->*phase)();
+        }
+        return;
+    }
+    jobSystem->parallelFor(updateEntities.size(), SIMULATION_PARALLEL_CHUNK, [&](size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+            (updateEntities[i]->*phase)();
+        }
+    });
+}
 
-    //Draw entities
+void Simulation::publishSnapshot() {
+    RenderSnapshot& snapshot = renderSnapshots->getBack();
+    snapshot.clear();
+
+    //Only capture what renderer might draw, entities can move up to a tile until next publish
+    Rectangle visibleRectangle;
+    renderSnapshots->getVisibleRectangle(visibleRectangle);
+    bool captureAll = visibleRectangle.w == 0 || visibleRectangle.h == 0;
+    visibleRectangle.grow(tileSize);
+
+    //Capture tiles
+    world->snapshot(snapshot, captureAll ? world->getWorldRectangle() : visibleRectangle);
+
+    //Capture entities
     for (const std::shared_ptr<Entity>& entity : entityStore->getEntities()) {
         const Rectangle& bounds = entity->getBounds();
-        if (rectangle.isOverlap(bounds)) {
-            visibleEntities.emplace_back(entity);
-            entity->draw();
-            if (debugEntities) {
-                renderer->drawRectangle(bounds, 2, Color::DEBUG_ENTITIES);
+        if (captureAll || visibleRectangle.isOverlap(bounds)) {
+            RenderSnapshotEntity& entry = snapshot.addEntity();
+            entry.id = entity->getID();
+            entry.lastPosition.set(entity->getLastPosition());
+            entry.position.set(entity->getPosition());
+            entry.bounds.set(bounds);
+            entity->snapshot(snapshot);
+        }
+    }
+
+    renderSnapshots->publish();
+}
+
+void Simulation::draw(const Rectangle& rectangle, std::vector<RenderSnapshotEntity>& visibleEntities) {
+    PROFILE_ZONE("Simulation::draw");
+    //Lock the snapshot so is not swapped while drawing
+    Renderer* renderer = getRenderer();
+    std::unique_lock<std::mutex> lock = renderSnapshots->lockFront();
+    renderSnapshots->setVisibleRectangle(rectangle);
+    const RenderSnapshot& snapshot = renderSnapshots->getFront();
+
+    //Draw world
+    world->draw(renderer, rectangle, snapshot);
+    //Tick length comes from scheduler so interpolation matches the pace snapshots are published
+    Scheduler* scheduler = engine->getScheduler();
+    number_t alpha = float_to_number(scheduler ? renderSnapshots->getInterpolation(scheduler->getTickDelta()) : 1.0f);
+    unsigned int teleportDistance = static_cast<unsigned int>(tileSize * tileSize);
+
+    //Draw entities
+    for (const RenderSnapshotEntity& entry : snapshot.entities) {
+        //Interpolate position between updates unless it was a big jump
+        Vector2 position;
+        if (entry.lastPosition == entry.position || teleportDistance < entry.lastPosition.distanceSquared(entry.position)) {
+            position.set(entry.position);
+        } else {
+            entry.lastPosition.lerp(entry.position, alpha, position);
+        }
+        Rectangle bounds(entry.bounds);
+        bounds.x += position.x - entry.position.x;
+        bounds.y += position.y - entry.position.y;
+        if (!rectangle.isOverlap(bounds)) {
+            continue;
+        }
+
+        //Store visible entity with the position that is drawn
+        RenderSnapshotEntity& visible = visibleEntities.emplace_back(entry);
+        visible.position.set(position);
+        visible.bounds.set(bounds);
+
+        //Draw sprites
+        for (size_t i = entry.spritesStart; i < entry.spritesStart + entry.spritesCount; ++i) {
+            const RenderSnapshotSprite& sprite = snapshot.sprites[i];
+            Palette* palette = sprite.palette.get();
+            if (palette) {
+                palette->updateTexture();
             }
+            Vector2 spritePosition = position + sprite.offset;
+            if (sprite.centered) {
+                renderer->drawImageCenter(spritePosition, sprite.size, sprite.angle, *sprite.image, palette);
+            } else {
+                renderer->drawImage(spritePosition, sprite.size, *sprite.image, palette);
+            }
+        }
+
+        if (debugEntities) {
+            renderer->drawRectangle(bounds, 2, Color::DEBUG_ENTITIES);
         }
     }
 }
 
+StateHash& Simulation::getStateHash() {
+    return stateHash;
+}
+
+uint64_t Simulation::getTick() const {
+    return tick;
+}
+
+void Simulation::startRecording(const std::string& save) {
+    recording = std::make_unique<Replay>();
+    recording->seed = parameters->seed;
+    recording->world = parameters->world;
+    recording->pathfinderBudget = parameters->pathfinderBudget;
+    recording->testEntities = parameters->testEntities;
+    recording->save = save;
+    recording->startTick = tick;
+    log->debug("Recording started at tick {0}", tick);
+}
+
+std::unique_ptr<Replay> Simulation::stopRecording() {
+    if (recording) {
+        recording->ticks = tick;
+        recording->hash = stateHash.get();
+    }
+    return std::move(recording);
+}
+
+void Simulation::recordCommand(SimulationCommand command) {
+    if (!recording || updating) {
+        return;
+    }
+    command.tick = tick;
+    recording->commands.push_back(command);
+}
+
 EntityStore* Simulation::getEntitiesStore() const {
     return entityStore.get();
 }
@@ -199,6 +579,10 @@ World* Simulation::getWorld() const {
     return world.get();
 }
 
+ReservationTable* Simulation::getReservations() const {
+    return reservations.get();
+}
+
 std::shared_ptr<Entity> Simulation::createEntity(const EntityPrototype& entityPrototype) {
     std::shared_ptr<Entity> entityPtr = engine->getEntityManager()->makeEntity(entityPrototype.type);
     if (entityPtr) {
@@ -256,6 +640,15 @@ void Simulation::removeEntity(const std::shared_ptr<Entity>& entity) {
     }
     entityStore->remove(entity);
     entity->removedFromSimulation();
+
+    //Entity won't be updated anymore, cleared instead of erased as it might be removed while updating
+    Entity* pointer = entity.get();
+    std::replace(updateEntities.begin(), updateEntities.end(), pointer, static_cast<Entity*>(nullptr));
+    wokenEntities.erase(std::remove(wokenEntities.begin(), wokenEntities.end(), pointer), wokenEntities.end());
+}
+
+void Simulation::wakeEntity(Entity* entity) {
+    wokenEntities.push_back(entity);
 }
 
 Renderer* Simulation::getRenderer() const {
@@ -302,7 +695,7 @@ void Simulation::addPlayer(std::unique_ptr<Player> player) {
         log->warn("Player with ID {0} already exists!", id);
         return;
     }
-    player->simulation = this;
+    player->setSimulation(this);
     players[id].swap(player);
 }
 
@@ -8,17 +8,33 @@
 #include "engine/core/macros.h"
 #include "entity.h"
 #include "simulation_parameters.h"
+#include "replay.h"
+#include "state_hash.h"
 #include "engine/assets/asset_manager.h"
 #include "engine/io/log.h"
 
+/** Minimum amount of entities to update to run update phases in parallel */
+#define SIMULATION_PARALLEL_MIN_ENTITIES 256
+
+/** Amount of entities per parallel update chunk */
+#define SIMULATION_PARALLEL_CHUNK 64
+
 struct EntityPrototype;
 class Faction;
 class Player;
 class Engine;
 class World;
+class PathScheduler;
+class ReservationTable;
 class Renderer;
 class AssetLevel;
 class EntityStore;
+class RenderSnapshotBuffer;
+struct RenderSnapshotEntity;
+class SaveWriter;
+class SaveReader;
+class MetricGauge;
+class MetricHistogram;
 
 /**
  * Contains everything inside the running game
@@ -55,6 +71,16 @@ private:
      */
     std::unique_ptr<World> world;
 
+    /**
+     * Shares the pathfinding budget between players
+     */
+    std::unique_ptr<PathScheduler> pathScheduler;
+
+    /**
+     * Tiles reserved by moving entities
+     */
+    std::unique_ptr<ReservationTable> reservations;
+
     /**
      * Factions for this simulation
      */
@@ -65,6 +91,60 @@ private:
      */
     std::vector<std::unique_ptr<Player>> players;
 
+    /**
+     * Snapshots of simulation state for drawing
+     */
+    std::unique_ptr<RenderSnapshotBuffer> renderSnapshots;
+
+    /**
+     * Root entities which are awake in entity order, only these are updated
+     */
+    std::vector<Entity*> updateEntities;
+
+    /**
+     * Entities woken since last update, these join the updated ones in next update
+     */
+    std::vector<Entity*> wokenEntities;
+
+    /**
+     * Amount of updates done since simulation started
+     */
+    uint64_t tick = 0;
+
+    /**
+     * Hash of simulation state updated on each mutation
+     */
+    StateHash stateHash;
+
+    /**
+     * Flag for simulation being inside update, commands issued by simulation itself are not recorded
+     */
+    bool updating = false;
+
+    /**
+     * Replay where issued commands are recorded if recording
+     */
+    std::unique_ptr<Replay> recording;
+
+    /**
+     * Cached metrics updated by simulation
+     */
+    MetricGauge* metricEntities = nullptr;
+    MetricGauge* metricPathRequests = nullptr;
+    MetricHistogram* metricExpansions = nullptr;
+
+    /**
+     * Calls the entity update phase for each entity being updated, in parallel if worth it
+     *
+     * @param phase entity method to call
+     */
+    void updatePhase(void (Entity::*phase)());
+
+    /**
+     * Captures the entities state into back snapshot and publishes it
+     */
+    void publishSnapshot();
+
 public:
     /**
      * Flag for enabling debugging entities
@@ -111,6 +191,28 @@ public:
      */
     void loadEntities();
 
+    /**
+     * Writes the simulation state into save
+     *
+     * @param writer to write into
+     */
+    void save(SaveWriter& writer);
+
+    /**
+     * Reads the parameters from start of save, these are required to create the simulation that will load the save
+     *
+     * @param reader to read from
+     * @param parameters to set
+     */
+    static void loadParameters(SaveReader& reader, SimulationParameters& parameters);
+
+    /**
+     * Reads the simulation state from save, must be called after loading world and players
+     *
+     * @param reader to read from after parameters
+     */
+    void load(SaveReader& reader);
+
     /**
      * Called when simulation is being updated
      */
@@ -122,12 +224,43 @@ public:
     virtual void close();
 
     /**
-     * Draws this simulation
+     * Draws this simulation from last published snapshot, can be called from a different thread than update
      *
      * @param rectangle the visible rectangle to draw
      * @param visibleEntities stores the drawn entities
      */
-    virtual void draw(const Rectangle& rectangle, std::vector<std::shared_ptr<Entity>>& visibleEntities);
+    virtual void draw(const Rectangle& rectangle, std::vector<RenderSnapshotEntity>& visibleEntities);
+
+    /**
+     * @return hash of current simulation state
+     */
+    StateHash& getStateHash();
+
+    /**
+     * @return amount of updates done since simulation started
+     */
+    uint64_t getTick() const;
+
+    /**
+     * Starts recording the commands issued to simulation from now on
+     *
+     * @param save path of save loaded into simulation before recording, empty if none
+     */
+    void startRecording(const std::string& save);
+
+    /**
+     * Stops recording and returns the recorded replay
+     *
+     * @return replay or null if not recording
+     */
+    std::unique_ptr<Replay> stopRecording();
+
+    /**
+     * Records a command issued to simulation from outside if recording
+     *
+     * @param command to record, tick is set by simulation
+     */
+    void recordCommand(SimulationCommand command);
 
     /**
      * @return entities store in simulation
@@ -139,6 +272,11 @@ public:
      */
     World* getWorld() const;
 
+    /**
+     * @return tiles reserved by moving entities
+     */
+    ReservationTable* getReservations() const;
+
     /**
      * Creates a new entity and adds to simulation
      */
@@ -164,6 +302,13 @@ public:
      */
     void removeEntity(const std::shared_ptr<Entity>& entity);
 
+    /**
+     * Schedules a woken root entity to be updated from next update
+     *
+     * @param entity that was woken
+     */
+    void wakeEntity(Entity* entity);
+
     /**
      * @return current renderer
      */
@@ -5,6 +5,7 @@
 #define OPENE2140_SIMULATION_PARAMETERS_H
 
 #include "engine/core/macros.h"
+#include "engine/core/common.h"
 #include "engine/simulation/player.h"
 
 /**
@@ -17,6 +18,16 @@ struct SimulationParameters {
     asset_path_t world = "";
     /** Load level players and entities */
     bool loadLevelContent = false;
+    /** Spawn the entities used for testing when simulation is not restored from a save */
+    bool testEntities = false;
+    /** Enable debugging features such as showing world borders */
+    bool debug = false;
+    /** Enable extra debugging features such as drawing tiles and entities bounds */
+    bool debugAll = false;
+    /** Run update phases in parallel using engine job system, not needed when simulation already runs in a worker */
+    bool parallelUpdates = true;
+    /** Vertices that pathfinders of all players can expand in each update, affects simulation outcome */
+    unsigned int pathfinderBudget = PATHFINDER_DEFAULT_BUDGET;
     /** Players in this simulation */
     std::vector<std::unique_ptr<Player>> players;
 };
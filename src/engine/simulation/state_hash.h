@@ -0,0 +1,115 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_STATE_HASH_H
+#define OPENE2140_STATE_HASH_H
+
+#include <atomic>
+#include <cstring>
+#include "engine/core/types.h"
+
+/**
+ * Part of simulation state that is hashed, used to separate same id and values in different fields
+ */
+enum class StateHashField: uint64_t {
+    EntityPosition = 1,
+    EntityDirection = 2,
+    EntityHealth = 3,
+    TileEntityFlags = 4,
+    PlayerMoney = 5,
+    PlayerEnergyPool = 6,
+    PlayerEnergyGeneration = 7,
+};
+
+/**
+ * Hash of simulation state that is updated incrementally on each mutation instead of recomputed
+ *
+ * Each field value contributes a hash that is XOR'ed into the state, so changing a value removes the old contribution
+ * and adds the new one, the result doesn't depend on mutation order so parallel updates produce the same hash.
+ * Zero values contribute nothing so default initialized state doesn't need to be added
+ */
+class StateHash {
+private:
+    /**
+     * Current hash value
+     */
+    std::atomic<uint64_t> value = 0;
+
+    /**
+     * Mixes the bits of value, SplitMix64 finalizer
+     */
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    /**
+     * Contribution of a field value to state
+     */
+    static uint64_t contribution(StateHashField field, uint64_t id, uint64_t fieldValue) {
+        if (fieldValue == 0) {
+            return 0;
+        }
+        return mix(mix((id << 8) | static_cast<uint64_t>(field)) ^ fieldValue);
+    }
+
+public:
+    /**
+     * Converts a value into bits for hashing
+     */
+    template<typename T>
+    static uint64_t toBits(const T& fieldValue) {
+        static_assert(sizeof(T) <= sizeof(uint64_t), "Value is too big");
+        uint64_t bits = 0;
+        std::memcpy(&bits, &fieldValue, sizeof(T));
+        return bits;
+    }
+
+    /**
+     * Adds or removes the contribution of field value, as XOR is used both operations are the same
+     *
+     * @param field being hashed
+     * @param id of object that owns the field
+     * @param fieldValue current value
+     */
+    void toggle(StateHashField field, uint64_t id, uint64_t fieldValue) {
+        uint64_t hash = contribution(field, id, fieldValue);
+        if (hash) {
+            value.fetch_xor(hash, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Replaces the contribution of field old value with the new value
+     *
+     * @param field being hashed
+     * @param id of object that owns the field
+     * @param oldValue value before change
+     * @param newValue value after change
+     */
+    void update(StateHashField field, uint64_t id, uint64_t oldValue, uint64_t newValue) {
+        if (oldValue != newValue) {
+            value.fetch_xor(contribution(field, id, oldValue) ^ contribution(field, id, newValue), std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @return current hash
+     */
+    uint64_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Resets the hash to empty state
+     */
+    void clear() {
+        value.store(0, std::memory_order_relaxed);
+    }
+};
+
+#endif //OPENE2140_STATE_HASH_H
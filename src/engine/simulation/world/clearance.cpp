@@ -0,0 +1,126 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <algorithm>
+#include <cstdlib>
+#include "engine/core/profiler.h"
+#include "world.h"
+#include "clearance.h"
+
+Clearance::Clearance(World* world): world(world) {
+}
+
+void Clearance::calculate(ClearanceLayer& layer, int x, int y) {
+    size_t index = static_cast<size_t>(x + y * layer.width);
+    if (!layer.passability->isPassable(x, y)) {
+        layer.values[index] = 0;
+        return;
+    }
+
+    //Square grows by one if right, below and diagonal squares allow it
+    bool right = x + 1 < layer.width;
+    bool below = y + 1 < layer.height;
+    unsigned int value = 0;
+    if (right && below) {
+        value = std::min({
+            layer.values[index + 1],
+            layer.values[index + layer.width],
+            layer.values[index + layer.width + 1]
+        });
+    }
+    layer.values[index] = static_cast<uint8_t>(std::min(value + 1, static_cast<unsigned int>(CLEARANCE_MAX)));
+}
+
+ClearanceLayer& Clearance::getLayer(tile_flags_t tileFlagsRequired, tile_flags_t entityFlagsMask) {
+    for (std::unique_ptr<ClearanceLayer>& layer : layers) {
+        if (layer->tileFlagsRequired == tileFlagsRequired && layer->entityFlagsMask == entityFlagsMask) {
+            return *layer;
+        }
+    }
+
+    //Build the layer of this movement class from bottom right corner
+    PROFILE_ZONE("Clearance::build");
+    std::unique_ptr<ClearanceLayer>& layer = layers.emplace_back(std::make_unique<ClearanceLayer>());
+    const Rectangle& rectangle = world->getRealRectangle();
+    layer->tileFlagsRequired = tileFlagsRequired;
+    layer->entityFlagsMask = entityFlagsMask;
+    layer->width = rectangle.w;
+    layer->height = rectangle.h;
+    layer->passability = &world->getPassability()->getLayer(tileFlagsRequired, entityFlagsMask);
+    layer->values.resize(static_cast<size_t>(rectangle.w) * static_cast<size_t>(rectangle.h), 0);
+    for (int y = layer->height - 1; 0 <= y; --y) {
+        for (int x = layer->width - 1; 0 <= x; --x) {
+            calculate(*layer, x, y);
+        }
+    }
+    return *layer;
+}
+
+unsigned int Clearance::getClearance(tile_flags_t tileFlagsRequired, tile_flags_t entityFlagsMask, const Tile* tile) {
+    ClearanceLayer& layer = getLayer(tileFlagsRequired, entityFlagsMask);
+    if (layer.width <= tile->position.x || layer.height <= tile->position.y) {
+        return 0;
+    }
+    return layer.values[static_cast<size_t>(tile->position.x + tile->position.y * layer.width)];
+}
+
+bool Clearance::isClear(tile_flags_t tileFlagsRequired, tile_flags_t entityFlagsMask, const Tile* tile,
+                        unsigned int size, tile_index_t entityTileIndex) {
+    if (size <= getClearance(tileFlagsRequired, entityFlagsMask, tile)) {
+        return true;
+    }
+
+    //Entity occupies its own square, only when overlapping it the tiles need to be checked one by one
+    const Tile* entityTile = world->getTile(entityTileIndex);
+    if (!entityTile) {
+        return false;
+    }
+    const Vector2& position = tile->position;
+    const Vector2& entityPosition = entityTile->position;
+    int squareSize = static_cast<int>(size);
+    if (squareSize <= std::abs(position.x - entityPosition.x) || squareSize <= std::abs(position.y - entityPosition.y)) {
+        return false;
+    }
+    //Tiles of own square only need the tile flags, so rows are checked by joining both layers bits
+    const ClearanceLayer& layer = getLayer(tileFlagsRequired, entityFlagsMask);
+    const PassabilityLayer& terrain = world->getPassability()->getLayer(tileFlagsRequired, 0);
+    if (layer.width < position.x + squareSize || layer.height < position.y + squareSize) {
+        return false;
+    }
+    uint64_t squareMask = (static_cast<uint64_t>(1) << squareSize) - 1;
+    int ownStart = std::max(position.x, entityPosition.x);
+    int ownEnd = std::min(position.x, entityPosition.x) + squareSize;
+    uint64_t ownMask = ((static_cast<uint64_t>(1) << (ownEnd - ownStart)) - 1) << (ownStart - position.x);
+    for (int y = position.y; y < position.y + squareSize; ++y) {
+        uint64_t row = layer.passability->getRowBits(position.x, y, squareSize);
+        bool own = entityPosition.y <= y && y < entityPosition.y + squareSize;
+        if (own) {
+            row |= terrain.getRowBits(position.x, y, squareSize) & ownMask;
+        }
+        if (row != squareMask) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Clearance::tileChanged(const Tile* tile) {
+    for (std::unique_ptr<ClearanceLayer>& layer : layers) {
+        int x = tile->position.x;
+        int y = tile->position.y;
+        if (layer->width <= x || layer->height <= y) {
+            continue;
+        }
+        bool wasPassable = layer->values[static_cast<size_t>(x + y * layer->width)] != 0;
+        if (wasPassable == layer->passability->isPassable(x, y)) {
+            continue;
+        }
+
+        //Only the squares containing this tile change, recalculate them in same order as build
+        for (int cy = y; std::max(0, y - CLEARANCE_MAX + 1) <= cy; --cy) {
+            for (int cx = x; std::max(0, x - CLEARANCE_MAX + 1) <= cx; --cx) {
+                calculate(*layer, cx, cy);
+            }
+        }
+    }
+}
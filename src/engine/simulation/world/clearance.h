@@ -0,0 +1,123 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_CLEARANCE_H
+#define OPENE2140_CLEARANCE_H
+
+#include <vector>
+#include <memory>
+#include "engine/core/macros.h"
+#include "engine/core/types.h"
+
+class World;
+class Tile;
+struct PassabilityLayer;
+
+/** Biggest clearance stored, entities footprints can't be bigger than this */
+#define CLEARANCE_MAX 8
+
+/**
+ * Clearance of tiles for a movement class
+ */
+struct ClearanceLayer {
+    /** Flags of tiles that should be present to be passable */
+    tile_flags_t tileFlagsRequired = 0;
+    /** Entity flags in tiles that shouldn't be set to be passable */
+    tile_flags_t entityFlagsMask = 0;
+    /** Width of world in tiles */
+    int width = 0;
+    /** Height of world in tiles */
+    int height = 0;
+    /** Passable tiles of movement class */
+    const PassabilityLayer* passability = nullptr;
+    /** Size of biggest passable square which top left corner is each tile by index, 0 if tile is not passable */
+    std::vector<uint8_t> values;
+};
+
+/**
+ * Keeps the clearance of tiles for each movement class, so entities occupying a square of several tiles can check if
+ * they fit at a tile without checking each tile of square
+ *
+ * Layers are built on first use of a class and updated when tiles change, a tile only affects the clearance of tiles
+ * above and left of it up to CLEARANCE_MAX distance
+ */
+class Clearance {
+private:
+    /**
+     * World which tiles are stored
+     */
+    World* world;
+
+    /**
+     * Layers for each movement class used so far
+     */
+    std::vector<std::unique_ptr<ClearanceLayer>> layers;
+
+    /**
+     * Calculates the clearance of position from the clearance of tiles at right and below
+     *
+     * @param layer to update
+     * @param x of position
+     * @param y of position
+     */
+    void calculate(ClearanceLayer& layer, int x, int y);
+
+    /**
+     * Obtains the layer for movement class, building it if is not present
+     *
+     * @param tileFlagsRequired of movement class
+     * @param entityFlagsMask of movement class
+     * @return layer
+     */
+    ClearanceLayer& getLayer(tile_flags_t tileFlagsRequired, tile_flags_t entityFlagsMask);
+
+public:
+    /**
+     * Constructor
+     *
+     * @param world which tiles are stored
+     */
+    explicit Clearance(World* world);
+
+    /**
+     * Destructor
+     */
+    ~Clearance() = default;
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(Clearance)
+
+    /**
+     * Obtains the clearance of tile
+     *
+     * @param tileFlagsRequired of movement class
+     * @param entityFlagsMask of movement class
+     * @param tile to get
+     * @return size of biggest passable square which top left corner is tile
+     */
+    unsigned int getClearance(tile_flags_t tileFlagsRequired, tile_flags_t entityFlagsMask, const Tile* tile);
+
+    /**
+     * Checks if a square of tiles is passable, the tiles occupied by the entity itself are not considered occupied
+     *
+     * @param tileFlagsRequired of movement class
+     * @param entityFlagsMask of movement class
+     * @param tile at top left corner of square
+     * @param size of square in tiles
+     * @param entityTileIndex tile at top left corner of square occupied by entity
+     * @return true if entity fits
+     */
+    bool isClear(tile_flags_t tileFlagsRequired, tile_flags_t entityFlagsMask, const Tile* tile, unsigned int size,
+                 tile_index_t entityTileIndex);
+
+    /**
+     * Called when tile or entity flags of tile change
+     *
+     * @param tile which changed
+     */
+    void tileChanged(const Tile* tile);
+};
+
+#endif //OPENE2140_CLEARANCE_H
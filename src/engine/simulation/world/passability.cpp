@@ -0,0 +1,180 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <algorithm>
+#include "engine/core/profiler.h"
+#include "world.h"
+#include "passability.h"
+
+/**
+ * @return true if tile reached moving horizontally has a forced neighbour, so it's a jump point
+ */
+static bool isForcedHorizontal(const PassabilityLayer& layer, int x, int y, int dx) {
+    return (!layer.isPassable(x, y + 1) && layer.isPassable(x + dx, y + 1))
+        || (!layer.isPassable(x, y - 1) && layer.isPassable(x + dx, y - 1));
+}
+
+/**
+ * @return true if tile reached moving vertically has a forced neighbour, so it's a jump point
+ */
+static bool isForcedVertical(const PassabilityLayer& layer, int x, int y, int dy) {
+    return (!layer.isPassable(x + 1, y) && layer.isPassable(x + 1, y + dy))
+        || (!layer.isPassable(x - 1, y) && layer.isPassable(x - 1, y + dy));
+}
+
+/**
+ * @return jump distance of tile which next tile in direction has the provided state and jump distance
+ */
+static int16_t nextJump(bool passable, bool forced, int16_t next) {
+    if (!passable) {
+        return 0;
+    }
+    if (forced) {
+        return 1;
+    }
+    return static_cast<int16_t>(0 < next ? next + 1 : next - 1);
+}
+
+Passability::Passability(World* world): world(world) {
+}
+
+void Passability::setTile(PassabilityLayer& layer, const Tile* tile) {
+    if (layer.width <= tile->position.x || layer.height <= tile->position.y) {
+        return;
+    }
+    bool passable = (tile->tileFlags & layer.tileFlagsRequired) == layer.tileFlagsRequired
+                 && (tile->entityFlags & layer.entityFlagsMask) == 0;
+    size_t bit = static_cast<size_t>(tile->position.x);
+    uint64_t& word = layer.bits[static_cast<size_t>(tile->position.y) * layer.rowWords + bit / 64];
+    uint64_t mask = static_cast<uint64_t>(1) << (bit % 64);
+    if (passable) {
+        word |= mask;
+    } else {
+        word &= ~mask;
+    }
+}
+
+void Passability::markDirty(PassabilityLayer& layer, int x, int y) {
+    //Nothing to recalculate if layer jumps were never requested
+    if (layer.jumps[0].empty()) {
+        return;
+    }
+
+    //Forced neighbours depend on adjacent rows and columns
+    for (int i = std::max(0, y - 1); i <= std::min(layer.height - 1, y + 1); ++i) {
+        layer.dirtyRows[static_cast<size_t>(i)] = true;
+    }
+    for (int i = std::max(0, x - 1); i <= std::min(layer.width - 1, x + 1); ++i) {
+        layer.dirtyColumns[static_cast<size_t>(i)] = true;
+    }
+    layer.dirty = true;
+}
+
+void Passability::calculateRow(PassabilityLayer& layer, int y) {
+    int16_t* east = &layer.jumps[static_cast<size_t>(JumpDirection::East)][static_cast<size_t>(y * layer.width)];
+    int16_t* west = &layer.jumps[static_cast<size_t>(JumpDirection::West)][static_cast<size_t>(y * layer.width)];
+    int16_t next = 0;
+    for (int x = layer.width - 1; 0 <= x; --x) {
+        int nx = x + 1;
+        next = nextJump(layer.isPassable(nx, y), isForcedHorizontal(layer, nx, y, 1), next);
+        east[x] = next;
+    }
+    next = 0;
+    for (int x = 0; x < layer.width; ++x) {
+        int nx = x - 1;
+        next = nextJump(layer.isPassable(nx, y), isForcedHorizontal(layer, nx, y, -1), next);
+        west[x] = next;
+    }
+}
+
+void Passability::calculateColumn(PassabilityLayer& layer, int x) {
+    std::vector<int16_t>& south = layer.jumps[static_cast<size_t>(JumpDirection::South)];
+    std::vector<int16_t>& north = layer.jumps[static_cast<size_t>(JumpDirection::North)];
+    int16_t next = 0;
+    for (int y = layer.height - 1; 0 <= y; --y) {
+        int ny = y + 1;
+        next = nextJump(layer.isPassable(x, ny), isForcedVertical(layer, x, ny, 1), next);
+        south[static_cast<size_t>(x + y * layer.width)] = next;
+    }
+    next = 0;
+    for (int y = 0; y < layer.height; ++y) {
+        int ny = y - 1;
+        next = nextJump(layer.isPassable(x, ny), isForcedVertical(layer, x, ny, -1), next);
+        north[static_cast<size_t>(x + y * layer.width)] = next;
+    }
+}
+
+void Passability::calculateDirty(PassabilityLayer& layer) {
+    PROFILE_ZONE("Passability::calculateDirty");
+    for (int y = 0; y < layer.height; ++y) {
+        if (layer.dirtyRows[static_cast<size_t>(y)]) {
+            layer.dirtyRows[static_cast<size_t>(y)] = false;
+            calculateRow(layer, y);
+        }
+    }
+    for (int x = 0; x < layer.width; ++x) {
+        if (layer.dirtyColumns[static_cast<size_t>(x)]) {
+            layer.dirtyColumns[static_cast<size_t>(x)] = false;
+            calculateColumn(layer, x);
+        }
+    }
+    layer.dirty = false;
+}
+
+PassabilityLayer& Passability::obtainLayer(tile_flags_t tileFlagsRequired, tile_flags_t entityFlagsMask) {
+    for (std::unique_ptr<PassabilityLayer>& layer : layers) {
+        if (layer->tileFlagsRequired == tileFlagsRequired && layer->entityFlagsMask == entityFlagsMask) {
+            return *layer;
+        }
+    }
+
+    //Build the layer of this movement class
+    PROFILE_ZONE("Passability::build");
+    std::unique_ptr<PassabilityLayer>& layer = layers.emplace_back(std::make_unique<PassabilityLayer>());
+    const Rectangle& rectangle = world->getRealRectangle();
+    layer->tileFlagsRequired = tileFlagsRequired;
+    layer->entityFlagsMask = entityFlagsMask;
+    layer->width = rectangle.w;
+    layer->height = rectangle.h;
+    layer->rowWords = (static_cast<size_t>(rectangle.w) + 63) / 64;
+    layer->bits.resize(layer->rowWords * static_cast<size_t>(rectangle.h), 0);
+    for (std::unique_ptr<Tile>& tile : world->getTiles()) {
+        setTile(*layer, tile.get());
+    }
+    return *layer;
+}
+
+const PassabilityLayer& Passability::getLayer(tile_flags_t tileFlagsRequired, tile_flags_t entityFlagsMask) {
+    return obtainLayer(tileFlagsRequired, entityFlagsMask);
+}
+
+const PassabilityLayer& Passability::getJumpLayer(tile_flags_t tileFlagsRequired, tile_flags_t entityFlagsMask) {
+    PassabilityLayer& layer = obtainLayer(tileFlagsRequired, entityFlagsMask);
+
+    //Jumps are calculated in full the first time, since then only when rows or columns change
+    if (layer.jumps[0].empty()) {
+        for (std::vector<int16_t>& jumps : layer.jumps) {
+            jumps.resize(static_cast<size_t>(layer.width) * static_cast<size_t>(layer.height), 0);
+        }
+        layer.dirtyRows.assign(static_cast<size_t>(layer.height), true);
+        layer.dirtyColumns.assign(static_cast<size_t>(layer.width), true);
+        layer.dirty = true;
+    }
+    if (layer.dirty) {
+        calculateDirty(layer);
+    }
+    return layer;
+}
+
+void Passability::tileChanged(const Tile* tile) {
+    for (std::unique_ptr<PassabilityLayer>& layer : layers) {
+        if (layer->width <= tile->position.x || layer->height <= tile->position.y) {
+            continue;
+        }
+        bool wasPassable = layer->isPassable(tile->position.x, tile->position.y);
+        setTile(*layer, tile);
+        if (wasPassable != layer->isPassable(tile->position.x, tile->position.y)) {
+            markDirty(*layer, tile->position.x, tile->position.y);
+        }
+    }
+}
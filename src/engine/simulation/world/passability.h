@@ -0,0 +1,250 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_PASSABILITY_H
+#define OPENE2140_PASSABILITY_H
+
+#include <vector>
+#include <memory>
+#include "engine/core/macros.h"
+#include "engine/core/types.h"
+
+class World;
+class Tile;
+
+/**
+ * Straight directions which jump distances are stored
+ */
+enum class JumpDirection {
+    East = 0,
+    West = 1,
+    South = 2,
+    North = 3,
+};
+
+/** Amount of jump directions */
+#define JUMP_DIRECTIONS 4
+
+/**
+ * Packed passable state of tiles for a movement class and the straight jump distances for jump point search
+ *
+ * Jump distance of a tile in a direction is positive if a jump point is found at that distance, otherwise is the
+ * negated amount of passable tiles before reaching a blocked tile or world edge
+ */
+struct PassabilityLayer {
+    /** Flags of tiles that should be present to be passable */
+    tile_flags_t tileFlagsRequired = 0;
+    /** Entity flags in tiles that shouldn't be set to be passable */
+    tile_flags_t entityFlagsMask = 0;
+    /** Width of world in tiles */
+    int width = 0;
+    /** Height of world in tiles */
+    int height = 0;
+    /** Amount of words of each row, rows start at word boundary */
+    size_t rowWords = 0;
+    /** Row major bits set for passable tiles */
+    std::vector<uint64_t> bits;
+    /** Jump distances for each direction by tile index, empty until jumps are requested */
+    std::vector<int16_t> jumps[JUMP_DIRECTIONS];
+    /** Rows which east and west jumps must be recalculated */
+    std::vector<bool> dirtyRows;
+    /** Columns which south and north jumps must be recalculated */
+    std::vector<bool> dirtyColumns;
+    /** Flag for any dirty row or column */
+    bool dirty = false;
+
+    /**
+     * @return true if position is inside world and passable
+     */
+    bool isPassable(int x, int y) const {
+        if (x < 0 || y < 0 || width <= x || height <= y) {
+            return false;
+        }
+        size_t bit = static_cast<size_t>(x);
+        return (bits[static_cast<size_t>(y) * rowWords + bit / 64] >> (bit % 64)) & 1;
+    }
+
+    /**
+     * Obtains the bits of a row segment, bit 0 is the tile at x and tiles outside world are not passable
+     *
+     * @param x of first tile
+     * @param y of row
+     * @param count of tiles, up to 64
+     * @return bits of segment
+     */
+    uint64_t getRowBits(int x, int y, int count) const {
+        if (y < 0 || height <= y || count <= 0 || x + count <= 0 || width <= x) {
+            return 0;
+        }
+        //Tiles before world start are not present in row
+        int offset = 0;
+        if (x < 0) {
+            offset = -x;
+            x = 0;
+        }
+        const uint64_t* row = &bits[static_cast<size_t>(y) * rowWords];
+        size_t word = static_cast<size_t>(x) / 64;
+        unsigned int bit = static_cast<unsigned int>(x) % 64;
+        uint64_t value = row[word] >> bit;
+        if (bit != 0 && word + 1 < rowWords) {
+            value |= row[word + 1] << (64 - bit);
+        }
+        value <<= offset;
+        if (count < 64) {
+            value &= (static_cast<uint64_t>(1) << count) - 1;
+        }
+        return value;
+    }
+
+    /**
+     * Obtains the passable adjacents of position, bits 0 to 2 are the row above from left to right, bits 3 and 4
+     * are left and right and bits 5 to 7 are the row below from left to right
+     *
+     * @param x of position
+     * @param y of position
+     * @return bits of passable adjacents
+     */
+    uint8_t getAdjacents(int x, int y) const {
+        uint64_t above = getRowBits(x - 1, y - 1, 3);
+        uint64_t middle = getRowBits(x - 1, y, 3);
+        uint64_t below = getRowBits(x - 1, y + 1, 3);
+        return static_cast<uint8_t>(above | (middle & 1) << 3 | (middle & 4) << 2 | below << 5);
+    }
+
+    /**
+     * @return true if all tiles of rectangle are inside world and passable, width must be up to 64
+     */
+    bool isAreaPassable(int x, int y, int w, int h) const {
+        if (x < 0 || y < 0 || width < x + w || height < y + h) {
+            return false;
+        }
+        uint64_t mask = w < 64 ? (static_cast<uint64_t>(1) << w) - 1 : ~static_cast<uint64_t>(0);
+        for (int row = y; row < y + h; ++row) {
+            if (getRowBits(x, row, w) != mask) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @return jump distance of position in direction, position must be inside world
+     */
+    int getJump(JumpDirection direction, int x, int y) const {
+        return jumps[static_cast<size_t>(direction)][static_cast<size_t>(x + y * width)];
+    }
+};
+
+/**
+ * Keeps the passable state of tiles packed for each movement class, considering both tile flags and entities
+ *
+ * Pathfinders, regions and clearances share these bits so neighbour and area checks are done on words instead of
+ * reading each tile. Layers are built on first use of a class and bits are updated when tiles change, jump distances
+ * are calculated only for layers that request them and recalculated lazily for rows and columns that changed
+ */
+class Passability {
+private:
+    /**
+     * World which tiles are stored
+     */
+    World* world;
+
+    /**
+     * Layers for each movement class used so far
+     */
+    std::vector<std::unique_ptr<PassabilityLayer>> layers;
+
+    /**
+     * Sets the bit of tile in layer
+     *
+     * @param layer to update
+     * @param tile to set
+     */
+    static void setTile(PassabilityLayer& layer, const Tile* tile);
+
+    /**
+     * Marks the rows and columns affected by tile as dirty
+     *
+     * @param layer to update
+     * @param x of tile
+     * @param y of tile
+     */
+    static void markDirty(PassabilityLayer& layer, int x, int y);
+
+    /**
+     * Recalculates east and west jumps of row
+     *
+     * @param layer to update
+     * @param y of row
+     */
+    static void calculateRow(PassabilityLayer& layer, int y);
+
+    /**
+     * Recalculates south and north jumps of column
+     *
+     * @param layer to update
+     * @param x of column
+     */
+    static void calculateColumn(PassabilityLayer& layer, int x);
+
+    /**
+     * Recalculates jumps of dirty rows and columns
+     *
+     * @param layer to update
+     */
+    static void calculateDirty(PassabilityLayer& layer);
+
+    /**
+     * Obtains the layer for movement class, building it if is not present
+     *
+     * @param tileFlagsRequired of movement class
+     * @param entityFlagsMask of movement class
+     * @return layer
+     */
+    PassabilityLayer& obtainLayer(tile_flags_t tileFlagsRequired, tile_flags_t entityFlagsMask);
+
+public:
+    /**
+     * Constructor
+     *
+     * @param world which tiles are stored
+     */
+    explicit Passability(World* world);
+
+    /**
+     * Destructor
+     */
+    ~Passability() = default;
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(Passability)
+
+    /**
+     * Obtains the layer for movement class, building it if is not present
+     *
+     * @param tileFlagsRequired of movement class
+     * @param entityFlagsMask of movement class, 0 to ignore entities
+     * @return layer
+     */
+    const PassabilityLayer& getLayer(tile_flags_t tileFlagsRequired, tile_flags_t entityFlagsMask);
+
+    /**
+     * Obtains the layer for movement class with up to date jumps, building it if is not present
+     *
+     * @param tileFlagsRequired of movement class
+     * @param entityFlagsMask of movement class, 0 to ignore entities
+     * @return layer
+     */
+    const PassabilityLayer& getJumpLayer(tile_flags_t tileFlagsRequired, tile_flags_t entityFlagsMask);
+
+    /**
+     * Called when tile or entity flags of tile change
+     *
+     * @param tile which changed
+     */
+    void tileChanged(const Tile* tile);
+};
+
+#endif //OPENE2140_PASSABILITY_H
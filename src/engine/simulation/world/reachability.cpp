@@ -0,0 +1,237 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include "engine/core/profiler.h"
+#include "world.h"
+#include "reachability.h"
+
+Reachability::Reachability(World* world): world(world) {
+}
+
+/** Offsets of each adjacent bit returned by PassabilityLayer::getAdjacents */
+static const int ADJACENT_OFFSETS[8][2] = {
+    {-1, -1}, {0, -1}, {1, -1},
+    {-1, 0}, {1, 0},
+    {-1, 1}, {0, 1}, {1, 1},
+};
+
+bool Reachability::isPassable(const ReachabilityLayer& layer, const Tile* tile) {
+    return layer.passability->isPassable(tile->position.x, tile->position.y);
+}
+
+ReachabilityLayer& Reachability::getLayer(tile_flags_t tileFlagsRequired) {
+    for (std::unique_ptr<ReachabilityLayer>& layer : layers) {
+        if (layer->tileFlagsRequired == tileFlagsRequired) {
+            return *layer;
+        }
+    }
+
+    //Build the regions of this movement class
+    PROFILE_ZONE("Reachability::build");
+    std::unique_ptr<ReachabilityLayer>& layer = layers.emplace_back(std::make_unique<ReachabilityLayer>());
+    layer->tileFlagsRequired = tileFlagsRequired;
+    layer->passability = &world->getPassability()->getLayer(tileFlagsRequired, 0);
+    std::vector<std::unique_ptr<Tile>>& tiles = world->getTiles();
+    layer->labels.resize(tiles.size(), 0);
+    for (std::unique_ptr<Tile>& tile : tiles) {
+        if (layer->labels[tile->index] == 0 && isPassable(*layer, tile.get())) {
+            reachability_label_t label = nextLabel++;
+            layer->sizes[label] = flood(*layer, tile.get(), label);
+        }
+    }
+    return *layer;
+}
+
+size_t Reachability::flood(ReachabilityLayer& layer, Tile* start, reachability_label_t label) {
+    size_t count = 0;
+    pending.clear();
+    pending.push_back(start);
+    layer.labels[start->index] = label;
+    while (!pending.empty()) {
+        Tile* tile = pending.back();
+        pending.pop_back();
+        count++;
+        //Passable adjacents are obtained from packed bits at once so blocked tiles are never read
+        const Vector2& position = tile->position;
+        uint8_t adjacents = layer.passability->getAdjacents(position.x, position.y);
+        for (unsigned int i = 0; adjacents != 0; ++i, adjacents >>= 1) {
+            if ((adjacents & 1) == 0) {
+                continue;
+            }
+            unsigned int x = static_cast<unsigned int>(position.x + ADJACENT_OFFSETS[i][0]);
+            unsigned int y = static_cast<unsigned int>(position.y + ADJACENT_OFFSETS[i][1]);
+            Tile* adjacent = world->getTile(x, y);
+            reachability_label_t& adjacentLabel = layer.labels[adjacent->index];
+            if (adjacentLabel != label) {
+                adjacentLabel = label;
+                pending.push_back(adjacent);
+            }
+        }
+    }
+    return count;
+}
+
+void Reachability::addTile(ReachabilityLayer& layer, Tile* tile) {
+    //Use the biggest adjacent region so the least amount of tiles are relabeled when joining
+    reachability_label_t label = 0;
+    size_t labelSize = 0;
+    for (Tile* adjacent : tile->adjacents) {
+        reachability_label_t adjacentLabel = layer.labels[adjacent->index];
+        if (adjacentLabel != 0 && labelSize < layer.sizes[adjacentLabel]) {
+            label = adjacentLabel;
+            labelSize = layer.sizes[adjacentLabel];
+        }
+    }
+
+    //No adjacent region, this tile is a new one
+    if (label == 0) {
+        label = nextLabel++;
+        layer.labels[tile->index] = label;
+        layer.sizes[label] = 1;
+        return;
+    }
+    layer.labels[tile->index] = label;
+    layer.sizes[label]++;
+
+    //Join the other adjacent regions
+    for (Tile* adjacent : tile->adjacents) {
+        reachability_label_t adjacentLabel = layer.labels[adjacent->index];
+        if (adjacentLabel != 0 && adjacentLabel != label) {
+            layer.sizes[label] += flood(layer, adjacent, label);
+            layer.sizes.erase(adjacentLabel);
+        }
+    }
+}
+
+void Reachability::removeTile(ReachabilityLayer& layer, Tile* tile) {
+    reachability_label_t label = layer.labels[tile->index];
+    layer.labels[tile->index] = 0;
+    if (label == 0) {
+        return;
+    }
+    size_t& labelSize = layer.sizes[label];
+    labelSize--;
+
+    //Group the passable adjacents that are still connected between them without this tile
+    std::vector<Tile*> adjacents;
+    for (Tile* adjacent : tile->adjacents) {
+        if (layer.labels[adjacent->index] == label) {
+            adjacents.push_back(adjacent);
+        }
+    }
+    std::vector<size_t> groups(adjacents.size());
+    for (size_t i = 0; i < adjacents.size(); ++i) {
+        groups[i] = i;
+    }
+    for (size_t i = 0; i < adjacents.size(); ++i) {
+        for (size_t j = i + 1; j < adjacents.size(); ++j) {
+            const Vector2& a = adjacents[i]->position;
+            const Vector2& b = adjacents[j]->position;
+            if (std::abs(a.x - b.x) <= 1 && std::abs(a.y - b.y) <= 1) {
+                size_t from = groups[j];
+                for (size_t& group : groups) {
+                    if (group == from) {
+                        group = groups[i];
+                    }
+                }
+            }
+        }
+    }
+
+    //If all adjacents are still connected locally the region can't be split
+    bool split = false;
+    for (size_t group : groups) {
+        if (group != groups[0]) {
+            split = true;
+            break;
+        }
+    }
+    if (!split) {
+        if (labelSize == 0) {
+            layer.sizes.erase(label);
+        }
+        return;
+    }
+
+    //Relabel each group which is not reached by previous floods, the region might still be connected elsewhere
+    for (size_t i = 1; i < adjacents.size(); ++i) {
+        if (layer.labels[adjacents[i]->index] != label) {
+            continue;
+        }
+        reachability_label_t newLabel = nextLabel++;
+        size_t count = flood(layer, adjacents[i], newLabel);
+        layer.sizes[newLabel] = count;
+        labelSize -= count;
+    }
+    if (labelSize == 0) {
+        layer.sizes.erase(label);
+    }
+}
+
+reachability_label_t Reachability::getLabel(tile_flags_t tileFlagsRequired, const Tile* tile) {
+    return getLayer(tileFlagsRequired).labels[tile->index];
+}
+
+bool Reachability::isReachable(tile_flags_t tileFlagsRequired, const Tile* origin, const Tile* destination) {
+    ReachabilityLayer& layer = getLayer(tileFlagsRequired);
+    reachability_label_t label = layer.labels[origin->index];
+    return label == 0 || label == layer.labels[destination->index];
+}
+
+Tile* Reachability::getNearestReachable(tile_flags_t tileFlagsRequired, Tile* origin, Tile* destination) {
+    ReachabilityLayer& layer = getLayer(tileFlagsRequired);
+    reachability_label_t label = layer.labels[origin->index];
+    if (label == 0 || label == layer.labels[destination->index]) {
+        return destination;
+    }
+
+    //Scan rings around destination, tiles in next ring are at least radius squared away so stop once best is closer
+    const Rectangle& rectangle = world->getRealRectangle();
+    const Vector2& center = destination->position;
+    int maxRadius = std::max(rectangle.w, rectangle.h);
+    Tile* nearest = nullptr;
+    unsigned int nearestDistance = std::numeric_limits<unsigned int>::max();
+    for (int radius = 1; radius <= maxRadius; ++radius) {
+        if (nearest && nearestDistance < static_cast<unsigned int>(radius * radius)) {
+            break;
+        }
+        for (int y = center.y - radius; y <= center.y + radius; ++y) {
+            //Only the ring edges, middle rows have only the left and right tiles
+            bool edgeRow = y == center.y - radius || y == center.y + radius;
+            int step = edgeRow ? 1 : radius * 2;
+            for (int x = center.x - radius; x <= center.x + radius; x += step) {
+                if (!rectangle.isInside(x, y)) {
+                    continue;
+                }
+                Tile* tile = world->getTile(static_cast<unsigned int>(x), static_cast<unsigned int>(y));
+                if (!tile || layer.labels[tile->index] != label) {
+                    continue;
+                }
+                unsigned int distance = tile->position.distanceSquared(center);
+                if (distance < nearestDistance) {
+                    nearest = tile;
+                    nearestDistance = distance;
+                }
+            }
+        }
+    }
+    return nearest ? nearest : origin;
+}
+
+void Reachability::tileFlagsChanged(Tile* tile, tile_flags_t oldFlags) {
+    for (std::unique_ptr<ReachabilityLayer>& layer : layers) {
+        bool wasPassable = (oldFlags & layer->tileFlagsRequired) == layer->tileFlagsRequired;
+        bool passable = isPassable(*layer, tile);
+        if (wasPassable == passable) {
+            continue;
+        }
+        if (passable) {
+            addTile(*layer, tile);
+        } else {
+            removeTile(*layer, tile);
+        }
+    }
+}
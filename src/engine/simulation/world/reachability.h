@@ -0,0 +1,156 @@
+//
+// Created by Ion Agorria on 18/10/26
+//
+#ifndef OPENE2140_REACHABILITY_H
+#define OPENE2140_REACHABILITY_H
+
+#include <unordered_map>
+#include <vector>
+#include <memory>
+#include "engine/core/macros.h"
+#include "engine/core/types.h"
+
+class World;
+class Tile;
+struct PassabilityLayer;
+
+/**
+ * Connected regions of tiles for a movement class, tiles with same label can reach each other when ignoring entities
+ */
+struct ReachabilityLayer {
+    /** Flags of tiles that should be present to be passable for this movement class */
+    tile_flags_t tileFlagsRequired = 0;
+    /** Passable tiles of movement class ignoring entities */
+    const PassabilityLayer* passability = nullptr;
+    /** Region label of each tile by index, 0 if tile is not passable */
+    std::vector<reachability_label_t> labels;
+    /** Amount of tiles in each region */
+    std::unordered_map<reachability_label_t, size_t> sizes;
+};
+
+/**
+ * Keeps the connected regions of world for each movement class so reachability of a tile can be checked without
+ * pathfinding, regions are built on first use of a class and updated incrementally when tile flags change
+ *
+ * Tiles are connected to their 8 adjacents same as pathfinder does, entities are not considered as they move constantly
+ */
+class Reachability {
+private:
+    /**
+     * World which tiles are labeled
+     */
+    World* world;
+
+    /**
+     * Layers for each movement class used so far
+     */
+    std::vector<std::unique_ptr<ReachabilityLayer>> layers;
+
+    /**
+     * Next label to assign to a new region
+     */
+    reachability_label_t nextLabel = 1;
+
+    /**
+     * Tiles pending to visit during flood, kept to avoid allocating each time
+     */
+    std::vector<Tile*> pending;
+
+    /**
+     * Obtains the layer for movement class, building it if is not present
+     *
+     * @param tileFlagsRequired of movement class
+     * @return layer
+     */
+    ReachabilityLayer& getLayer(tile_flags_t tileFlagsRequired);
+
+    /**
+     * Sets the label to all passable tiles connected to start that don't have it already
+     *
+     * @param layer to label
+     * @param start tile to start from
+     * @param label to set
+     * @return amount of tiles labeled
+     */
+    size_t flood(ReachabilityLayer& layer, Tile* start, reachability_label_t label);
+
+    /**
+     * Handles a tile that became passable, joining the adjacent regions
+     *
+     * @param layer to update
+     * @param tile that changed
+     */
+    void addTile(ReachabilityLayer& layer, Tile* tile);
+
+    /**
+     * Handles a tile that is no longer passable, splitting the region if adjacents are no longer connected
+     *
+     * @param layer to update
+     * @param tile that changed
+     */
+    void removeTile(ReachabilityLayer& layer, Tile* tile);
+
+    /**
+     * @return if tile can be traversed by movement class of layer
+     */
+    static bool isPassable(const ReachabilityLayer& layer, const Tile* tile);
+
+public:
+    /**
+     * Constructor
+     *
+     * @param world which tiles are labeled
+     */
+    explicit Reachability(World* world);
+
+    /**
+     * Destructor
+     */
+    ~Reachability() = default;
+
+    /**
+     * Disable copy/move
+     */
+    NON_COPYABLE_NOR_MOVABLE(Reachability)
+
+    /**
+     * Obtains the region where tile belongs for movement class
+     *
+     * @param tileFlagsRequired of movement class
+     * @param tile to check
+     * @return label or 0 if tile is not passable
+     */
+    reachability_label_t getLabel(tile_flags_t tileFlagsRequired, const Tile* tile);
+
+    /**
+     * Checks if destination can be reached from origin, origins that are not passable are considered to reach anything
+     * as their region is unknown
+     *
+     * @param tileFlagsRequired of movement class
+     * @param origin tile where movement starts
+     * @param destination tile to reach
+     * @return true if reachable
+     */
+    bool isReachable(tile_flags_t tileFlagsRequired, const Tile* origin, const Tile* destination);
+
+    /**
+     * Obtains the closest tile to destination that can be reached from origin, by scanning the labels around
+     * destination in growing rings
+     *
+     * @param tileFlagsRequired of movement class
+     * @param origin tile where movement starts
+     * @param destination tile desired to reach
+     * @return destination if reachable, closest reachable tile or origin if none is found
+     */
+    Tile* getNearestReachable(tile_flags_t tileFlagsRequired, Tile* origin, Tile* destination);
+
+    /**
+     * Updates the regions after tile flags changed
+     *
+     * @param tile that changed
+     * @param oldFlags flags that tile had before
+     */
+    void tileFlagsChanged(Tile* tile, tile_flags_t oldFlags);
+};
+
+#endif //OPENE2140_REACHABILITY_H
@@ -1,7 +1,10 @@
 //
 // Created by Ion Agorria on 20/05/18
 //
+#include <algorithm>
 #include "engine/simulation/entity.h"
+#include "engine/simulation/state_hash.h"
+#include "world.h"
 #include "tile.h"
 
 Tile::Tile(tile_index_t index, Vector2& position): index(index), position(position) {
@@ -9,8 +12,16 @@ Tile::Tile(tile_index_t index, Vector2& position): index(index), position(positi
 
 void Tile::setPrototype(TilePrototype prototype) {
     this->tilesetIndex = prototype.tilesetIndex;
-    this->tileFlags = prototype.tileFlags;
     this->ore = prototype.ore;
+    setTileFlags(prototype.tileFlags);
+}
+
+void Tile::setTileFlags(tile_flags_t flags) {
+    tile_flags_t oldFlags = tileFlags;
+    tileFlags = flags;
+    if (world && oldFlags != flags) {
+        world->tileFlagsChanged(this, oldFlags);
+    }
 }
 
 bool Tile::addEntity(const std::shared_ptr<Entity>& entity, bool clearTiles) {
@@ -31,32 +42,27 @@ bool Tile::addEntity(const std::shared_ptr<Entity>& entity, bool clearTiles) {
     }
     entity->getTiles().push_back(this);
     entities.push_back(entity);
-    entityFlags |= entity->entityFlagsMask;
+    setEntityFlags(entityFlags | entity->entityFlagsMask);
     return true;
 }
 
 bool Tile::removeEntity(entity_id_t id) {
     std::shared_ptr<Entity> deletedEntity;
-    for (auto it = entities.begin(); it != entities.end(); ) {
-        std::shared_ptr<Entity> entity = *it;
-        if (entity->getID() == id) {
+    for (auto it = entities.begin(); it != entities.end(); ++it) {
+        if ((*it)->getID() == id) {
+            deletedEntity = *it;
             entities.erase(it);
-            deletedEntity = entity;
             break;
         }
     }
     //Remove tile from entity tiles and update flags if entity was deleted
-    if (deletedEntity) {
-        auto& tiles = deletedEntity->getTiles();
-        for (auto it_tiles = tiles.begin(); it_tiles != tiles.end(); ) {
-            if (*it_tiles == this) {
-                tiles.erase(it_tiles);
-                continue;
-            }
-        }
-        updateFlags();
+    if (!deletedEntity) {
+        return false;
     }
-    return false;
+    auto& tiles = deletedEntity->getTiles();
+    tiles.erase(std::remove(tiles.begin(), tiles.end(), this), tiles.end());
+    updateFlags();
+    return true;
 }
 
 std::string Tile::toStringContent() const {
@@ -64,8 +70,22 @@ std::string Tile::toStringContent() const {
 }
 
 void Tile::updateFlags() {
-    entityFlags = 0;
+    tile_flags_t flags = 0;
     for (auto& entity : entities) {
-        entityFlags |= entity->entityFlagsMask;
+        flags |= entity->entityFlagsMask;
+    }
+    setEntityFlags(flags);
+}
+
+void Tile::setEntityFlags(tile_flags_t flags) {
+    if (entityFlags == flags) {
+        return;
+    }
+    if (stateHash) {
+        stateHash->update(StateHashField::TileEntityFlags, index, entityFlags, flags);
+    }
+    entityFlags = flags;
+    if (world) {
+        world->tileEntityFlagsChanged(this);
     }
 }
@@ -8,6 +8,8 @@
 #include "world_prototypes.h"
 
 class Entity;
+class StateHash;
+class World;
 
 /**
  * Stores each tile information
@@ -24,6 +26,16 @@ public:
      */
     tile_flags_t entityFlags = 0;
 
+    /**
+     * Simulation state hash to update when entity flags change
+     */
+    StateHash* stateHash = nullptr;
+
+    /**
+     * World to notify when tile or entity flags change
+     */
+    World* world = nullptr;
+
     /**
      * Tile position in the world
      */
@@ -70,11 +82,25 @@ public:
      */
     void setPrototype(TilePrototype prototype);
 
+    /**
+     * Sets the tile flags notifying the world
+     *
+     * @param flags to set
+     */
+    void setTileFlags(tile_flags_t flags);
+
     /**
      * Updates the current entity flags
      */
     void updateFlags();
 
+    /**
+     * Sets the entity flags updating the state hash and notifying the world
+     *
+     * @param flags to set
+     */
+    void setEntityFlags(tile_flags_t flags);
+
     /**
      * Adds a entity to this tile and tile to entity tiles list
      *
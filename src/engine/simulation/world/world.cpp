@@ -1,18 +1,21 @@
 //
 // Created by Ion Agorria on 20/05/18
 //
+#include "engine/core/profiler.h"
 #include "engine/graphics/renderer.h"
 #include "engine/assets/asset_level.h"
 #include "engine/simulation/simulation.h"
+#include "engine/simulation/entity.h"
+#include "engine/simulation/render_snapshot.h"
 #include "world.h"
 
-World::World(AssetLevel* assetLevel, std::unordered_map<unsigned int, Image*>& tilesetImages) :
+World::World(AssetLevel* assetLevel, std::unordered_map<unsigned int, Image*>& tilesetImages, bool debug, bool debugAll) :
     tilesetImages(std::move(tilesetImages)),
     tileSize(static_cast<int>(assetLevel->tileSize())),
     tilesetIndex(assetLevel->tilesetIndex())
     {
     log = Log::get("World");
-    debugTiles = Utils::isFlag(FLAG_DEBUG_ALL);
+    debugTiles = debugAll;
 
     //Set dimensions
     Vector2 size;
@@ -24,7 +27,7 @@ World::World(AssetLevel* assetLevel, std::unordered_map<unsigned int, Image*>& t
         return;
     }
     realRectangle.set(Vector2(0), size);
-    if (Utils::isFlag(FLAG_DEBUG)) {
+    if (debug) {
         tileRectangle.set(realRectangle);
     } else {
         tileRectangle.set(
@@ -75,17 +78,30 @@ World::World(AssetLevel* assetLevel, std::unordered_map<unsigned int, Image*>& t
             }
         }
     }
+
+    //Keep regions, passable tiles and clearances updated when tiles change
+    reachability = std::make_unique<Reachability>(this);
+    passability = std::make_unique<Passability>(this);
+    clearance = std::make_unique<Clearance>(this);
+    for (std::unique_ptr<Tile>& tile : tiles) {
+        tile->world = this;
+    }
 }
 
 World::~World() {
     realRectangle.set(0);
     tileRectangle.set(0);
     worldRectangle.set(0);
+    changedTiles.clear();
     tiles.clear();
     tilesImages.clear();
+    reachability.reset();
+    passability.reset();
+    clearance.reset();
 }
 
 void World::update() {
+    PROFILE_ZONE("World::update");
     size_t size = tiles.size();
     for (size_t i = 0; i < size; ++i) {
         Tile& tile = *tiles[i];
@@ -97,22 +113,42 @@ void World::update() {
     }
 }
 
-void World::draw(Renderer* renderer, const Rectangle& rectangle, int scaling) {
-    //Do pixel to tile conversions
+void World::snapshot(RenderSnapshot& snapshot, const Rectangle& rectangle) {
+    //Do pixel to tile conversions, including the tile partially covered at end
+    int tileStartX = std::max(tileRectangle.x, rectangle.x / tileSize);
+    int tileStartY = std::max(tileRectangle.y, rectangle.y / tileSize);
+    int tileEndX = std::min(tileRectangle.w, (rectangle.x + rectangle.w) / tileSize + 1);
+    int tileEndY = std::min(tileRectangle.h, (rectangle.y + rectangle.h) / tileSize + 1);
+    if (tileEndX <= tileStartX || tileEndY <= tileStartY) {
+        return;
+    }
+
+    //Copy the current image of each tile
+    snapshot.tilesRectangle.set(tileStartX, tileStartY, tileEndX - tileStartX, tileEndY - tileStartY);
+    for (int y = tileStartY; y < tileEndY; ++y) {
+        for (int x = tileStartX; x < tileEndX; ++x) {
+            snapshot.tileImages.push_back(tilesImages.at(x + realRectangle.w * y));
+        }
+    }
+}
+
+void World::draw(Renderer* renderer, const Rectangle& rectangle, const RenderSnapshot& snapshot, int scaling) const {
+    //Do pixel to tile conversions, only tiles captured in snapshot can be drawn
+    const Rectangle& captured = snapshot.tilesRectangle;
     int viewX = rectangle.x;
     int viewY = rectangle.y;
-    int tileStartX = std::max(tileRectangle.x, viewX / tileSize);
-    int tileStartY = std::max(tileRectangle.y, viewY / tileSize);
-    int tileEndX = std::min(tileRectangle.w, (viewX + rectangle.w) / tileSize);
-    int tileEndY = std::min(tileRectangle.h, (viewY + rectangle.h) / tileSize);
+    int tileStartX = std::max({tileRectangle.x, captured.x, viewX / tileSize});
+    int tileStartY = std::max({tileRectangle.y, captured.y, viewY / tileSize});
+    int tileEndX = std::min({tileRectangle.w, captured.x + captured.w, (viewX + rectangle.w) / tileSize});
+    int tileEndY = std::min({tileRectangle.h, captured.y + captured.h, (viewY + rectangle.h) / tileSize});
     int drawTileSize = tileSize * scaling;
     //Iterate each tile inside rectangle
     std::vector<Rectangle> rectangles;
     for (int y = tileStartY; y < tileEndY; ++y) {
         for (int x = tileStartX; x < tileEndX; ++x) {
-            //Get current image of tile and draw it
-            int index = x + realRectangle.w * y;
-            Image* image = tilesImages.at(index);
+            //Get captured image of tile and draw it
+            int index = (x - captured.x) + captured.w * (y - captured.y);
+            Image* image = snapshot.tileImages.at(index);
             if (!image) {
                 continue;
             }
@@ -162,6 +198,55 @@ std::vector<std::unique_ptr<Tile>>& World::getTiles() {
     return tiles;
 }
 
+Reachability* World::getReachability() const {
+    return reachability.get();
+}
+
+Passability* World::getPassability() const {
+    return passability.get();
+}
+
+Clearance* World::getClearance() const {
+    return clearance.get();
+}
+
+void World::occupyTiles(const std::shared_ptr<Entity>& entity, Tile* tile) {
+    //Top left tile is added first so it's the entity tile
+    entity->clearTiles();
+    int size = static_cast<int>(entity->footprint);
+    const Vector2& position = tile->position;
+    for (int y = position.y; y < position.y + size; ++y) {
+        for (int x = position.x; x < position.x + size; ++x) {
+            if (!realRectangle.isInside(x, y)) {
+                continue;
+            }
+            getTile(static_cast<unsigned int>(x), static_cast<unsigned int>(y))->addEntity(entity, false);
+        }
+    }
+}
+
+void World::tileFlagsChanged(Tile* tile, tile_flags_t oldFlags) {
+    //Regions read the passable bits so these must be updated first
+    passability->tileChanged(tile);
+    reachability->tileFlagsChanged(tile, oldFlags);
+    clearance->tileChanged(tile);
+    changedTiles.push_back(tile);
+}
+
+void World::tileEntityFlagsChanged(Tile* tile) {
+    passability->tileChanged(tile);
+    clearance->tileChanged(tile);
+    changedTiles.push_back(tile);
+}
+
+const std::vector<Tile*>& World::getChangedTiles() const {
+    return changedTiles;
+}
+
+void World::clearChangedTiles() {
+    changedTiles.clear();
+}
+
 Tile* World::getTile(tile_index_t index) const {
     if (index < 0 || index >= tiles.size()) {
         return nullptr;
@@ -9,11 +9,16 @@
 #include "engine/io/log.h"
 #include "engine/math/rectangle.h"
 #include "tile.h"
+#include "reachability.h"
+#include "passability.h"
+#include "clearance.h"
 
 class Renderer;
 class Image;
 class AssetLevel;
 class Simulation;
+class Entity;
+class RenderSnapshot;
 
 /**
  * Contains the world data such as tiles
@@ -60,6 +65,26 @@ private:
      */
     int tileSize;
 
+    /**
+     * Connected regions of tiles for each movement class
+     */
+    std::unique_ptr<Reachability> reachability;
+
+    /**
+     * Packed passable tiles for each movement class
+     */
+    std::unique_ptr<Passability> passability;
+
+    /**
+     * Passable squares of tiles for each movement class
+     */
+    std::unique_ptr<Clearance> clearance;
+
+    /**
+     * Tiles which flags changed since last clear, might contain duplicates
+     */
+    std::vector<Tile*> changedTiles;
+
 public:
     /**
      * Flag for enabling debugging tiles
@@ -73,8 +98,13 @@ public:
 
     /**
      * World constructor
+     *
+     * @param assetLevel to load world from
+     * @param tilesetImages images for each tileset index
+     * @param debug shows the world borders
+     * @param debugAll draws the tile debug info
      */
-    World(AssetLevel* assetLevel, std::unordered_map<unsigned int, Image*>& tilesetImages);
+    World(AssetLevel* assetLevel, std::unordered_map<unsigned int, Image*>& tilesetImages, bool debug, bool debugAll);
 
     /**
      * World destructor
@@ -92,12 +122,21 @@ public:
     void update();
 
     /**
-     * Draws the world using provided view
+     * Captures the images of tiles inside rectangle into snapshot
+     *
+     * @param snapshot to write
+     * @param rectangle the rectangle that might be drawn
+     */
+    void snapshot(RenderSnapshot& snapshot, const Rectangle& rectangle);
+
+    /**
+     * Draws the world tiles captured in snapshot using provided view, can be called from any thread
      *
      * @param renderer to use for drawing
      * @param rectangle the rectangle to draw
+     * @param snapshot to read tiles from
      */
-    void draw(Renderer* renderer, const Rectangle& rectangle, int scaling = 1);
+    void draw(Renderer* renderer, const Rectangle& rectangle, const RenderSnapshot& snapshot, int scaling = 1) const;
 
     /**
      * @return world tile size
@@ -124,6 +163,54 @@ public:
      */
     std::vector<std::unique_ptr<Tile>>& getTiles();
 
+    /**
+     * @return connected regions of tiles
+     */
+    Reachability* getReachability() const;
+
+    /**
+     * @return packed passable tiles
+     */
+    Passability* getPassability() const;
+
+    /**
+     * @return passable squares of tiles
+     */
+    Clearance* getClearance() const;
+
+    /**
+     * Sets the tiles occupied by entity to the square of entity footprint which top left corner is tile
+     *
+     * @param entity to set
+     * @param tile at top left corner of square
+     */
+    void occupyTiles(const std::shared_ptr<Entity>& entity, Tile* tile);
+
+    /**
+     * Called by tile when tile flags change
+     *
+     * @param tile which changed
+     * @param oldFlags tile flags before change
+     */
+    void tileFlagsChanged(Tile* tile, tile_flags_t oldFlags);
+
+    /**
+     * Called by tile when entity flags change
+     *
+     * @param tile which changed
+     */
+    void tileEntityFlagsChanged(Tile* tile);
+
+    /**
+     * @return tiles which flags changed since last clear
+     */
+    const std::vector<Tile*>& getChangedTiles() const;
+
+    /**
+     * Clears the changed tiles once every interested part has handled them
+     */
+    void clearChangedTiles();
+
     /**
      * Tile in specified tile index
      *
@@ -2,6 +2,7 @@
 // Created by Ion Agorria on 08/09/19
 //
 
+#include <algorithm>
 #include <src/engine/simulation/components/rotation_component.h>
 #include "engine/simulation/components/player_component.h"
 #include "engine/simulation/components/image_component.h"
@@ -9,6 +10,9 @@
 #include "engine/entities/entity_config.h"
 #include "engine/simulation/simulation.h"
 #include "engine/simulation/world/world.h"
+#include "engine/simulation/entity_store.h"
+#include "engine/simulation/save_stream.h"
+#include "engine/simulation/pathfinder/reservation_table.h"
 #include "movement_component.h"
 
 CLASS_COMPONENT_DEFAULT(MovementComponent)
@@ -27,8 +31,9 @@ void MovementComponent::dispatchPathTile() {
     const Tile* currentTile = path.empty() ? nullptr : path.back();
     if (currentTile) {
         //Get distance
+        Simulation* simulation = base->getSimulation();
         Vector2 targetPosition;
-        base->getSimulation()->toWorldVector(currentTile->position, targetPosition, true);
+        simulation->toWorldVector(currentTile->position, targetPosition, true);
         number_t distance = base->getPosition().distance(targetPosition);
 
         //Already on position, skip it
@@ -37,6 +42,27 @@ void MovementComponent::dispatchPathTile() {
             dispatchPathTile();
             return;
         }
+
+        //Wait while other entity is expected to be in next tile instead of colliding with it
+        uint64_t tick = simulation->getTick();
+        uint64_t tileTicks = std::max<uint64_t>(getTileTicks(), 1);
+        ReservationTable* reservations = simulation->getReservations();
+        entity_id_t reserver = reservations->getReserver(currentTile->index, tick, tick + tileTicks, base->getID());
+        if (reserver != 0 && reservationWait < RESERVATION_WAIT_TICKS) {
+            //Keep the tile where entity waits so others don't plan to pass through it meanwhile
+            Tile* tile = base->getTile();
+            if (tile) {
+                reservations->reserve(base->getID(), tile->index, tick, tick + tileTicks);
+            }
+            reservationWait++;
+            setStateTo(MovementState::WaitReservation);
+            return;
+        }
+        if (0 < reservationWait) {
+            //Reservations are shifted by the time waited
+            reservationWait = 0;
+            reservePath();
+        }
         RotationComponent* rotationComponent = GET_COMPONENT_DYNAMIC(base, RotationComponent);
         if (rotationComponent) {
             //Check if target angle is correct, else rotate it
@@ -56,6 +82,81 @@ void MovementComponent::dispatchPathTile() {
     }
 }
 
+uint64_t MovementComponent::getTileTicks() {
+    number_t speed = number_mul(getForwardSpeed(), GAME_DELTA);
+    if (NUMBER_ZERO >= speed) {
+        return 0;
+    }
+    number_t tileSize = int_to_number(base->getSimulation()->tileSize);
+    int ticks = number_to_int(number_ceil(number_div(tileSize, speed)));
+    if (ticks <= 0 || RESERVATION_TILE_TICKS_MAX < ticks) {
+        return RESERVATION_TILE_TICKS_MAX;
+    }
+    return static_cast<uint64_t>(ticks);
+}
+
+void MovementComponent::reservePath() {
+    Simulation* simulation = base->getSimulation();
+    ReservationTable* reservations = simulation->getReservations();
+    entity_id_t entityId = base->getID();
+    reservations->release(entityId);
+    uint64_t tileTicks = getTileTicks();
+    if (tileTicks == 0) {
+        return;
+    }
+
+    //Current tile is kept until leaving it, each next tile from leaving previous one until leaving it
+    uint64_t from = simulation->getTick();
+    Tile* tile = base->getTile();
+    if (tile) {
+        reservations->reserve(entityId, tile->index, from, from + tileTicks);
+    }
+    size_t count = 0;
+    for (auto it = path.rbegin(); it != path.rend() && count < RESERVATION_WINDOW; ++it, ++count) {
+        //Stop at first tile taken by other, the rest would be reached later than estimated
+        if (!reservations->reserve(entityId, (*it)->index, from, from + tileTicks * 2)) {
+            break;
+        }
+        from += tileTicks;
+    }
+}
+
+void MovementComponent::releaseReservations() {
+    Simulation* simulation = base->getSimulation();
+    if (simulation && simulation->getReservations()) {
+        simulation->getReservations()->release(base->getID());
+    }
+}
+
+bool MovementComponent::updatePath() {
+    if (!pathRequest) {
+        return true;
+    }
+    entity_id_t entityId = base->getID();
+    uint32_t revision = pathRequest->getRevision(entityId);
+    if (revision == pathRevision) {
+        return true;
+    }
+
+    //Keep following current path while pathfinder is still repairing it
+    std::vector<const Tile*> newPath;
+    PathFinderStatus status = pathRequest->getResult(entityId, newPath);
+    switch (status) {
+        case PathFinderStatus::Success:
+        case PathFinderStatus::Partial:
+            path.swap(newPath);
+            pathRevision = revision;
+            break;
+        case PathFinderStatus::Fail:
+            //Let pathfinder wait state handle the failure
+            setStateTo(MovementState::WaitPathfinder);
+            return false;
+        default:
+            break;
+    }
+    return true;
+}
+
 void MovementComponent::setStateTo(MovementState newState) {
     //Only run if state changes
     if (state == newState) return;
@@ -68,12 +169,19 @@ void MovementComponent::setStateTo(MovementState newState) {
             break;
         case MovementState::WaitPathfinder:
             path.clear();
+            reservationWait = 0;
+            releaseReservations();
             break;
         default:
             break;
     }
 
     state = newState;
+
+    //Any state other than standby has work to do in next updates
+    if (state != MovementState::Standby) {
+        base->wake();
+    }
 }
 
 void MovementComponent::update() {
@@ -107,6 +215,8 @@ void MovementComponent::update() {
                         break;
                     case PathFinderStatus::Success:
                     case PathFinderStatus::Partial:
+                        pathRevision = pathRequest->getRevision(entityId);
+                        reservePath();
                         dispatchPathTile();
                         break;
                 }
@@ -127,51 +237,92 @@ void MovementComponent::update() {
             }
             break;
         }
+        case MovementState::WaitReservation:
+            //Check again if next tile is still reserved
+            dispatchPathTile();
+            break;
         case MovementState::Moving:
-            const Tile* currentTile = path.back();
-            if (currentTile) {
-                //Get factor of lerp
-                number_t factor = NUMBER_ZERO;
-                Vector2 targetPosition;
-                base->getSimulation()->toWorldVector(currentTile->position, targetPosition, true);
-                if (NUMBER_ZERO < getForwardSpeed()) {
-                    number_t distance = base->getPosition().distance(targetPosition);
-                    number_t speed = number_mul(getForwardSpeed(), GAME_DELTA);
-                    if (speed < distance) {
-                        factor = number_div(speed, distance);
-                    } else {
-                        factor = NUMBER_ONE;
-                    }
-                }
-
-                //There is movement to apply?
-                if (NUMBER_ZERO < factor) {
-                    //Check if factor goes beyond goal position
-                    bool reach = NUMBER_ONE <= factor;
-                    if (reach) factor = NUMBER_ONE;
-
-                    //Apply position
-                    Vector2 result;
-                    base->getPosition().lerp(targetPosition, factor, result);
-                    base->setPosition(result);
+            //Movement was done in integrate phase, handle the reached tile or lack of it
+            if (reachedTile) {
+                reachedTile = false;
 
-                    //Next
-                    if (reach) {
-                        path.pop_back();
-                        dispatchPathTile();
-                    }
+                //Occupy the reached tiles so pathfinders see the entity moving
+                World* world = base->getSimulation()->getWorld();
+                Tile* tile = world->getTile(base->getPosition());
+                if (tile) {
+                    world->occupyTiles(base->getEntityPtr(), tile);
                 }
-            } else {
+                if (!updatePath()) {
+                    break;
+                }
+                reservePath();
+                dispatchPathTile();
+            } else if (path.empty() || !path.back()) {
                 dispatchPathTile();
             }
             break;
     }
 }
 
+void MovementComponent::updatePlan() {
+    plannedMove = false;
+    if (state != MovementState::Moving || path.empty()) {
+        return;
+    }
+    const Tile* currentTile = path.back();
+    if (!currentTile || NUMBER_ZERO >= getForwardSpeed()) {
+        return;
+    }
+
+    //Get factor of lerp
+    Vector2 targetPosition;
+    base->getSimulation()->toWorldVector(currentTile->position, targetPosition, true);
+    number_t distance = base->getPosition().distance(targetPosition);
+    number_t speed = number_mul(getForwardSpeed(), GAME_DELTA);
+    number_t factor;
+    if (speed < distance) {
+        factor = number_div(speed, distance);
+    } else {
+        factor = NUMBER_ONE;
+    }
+
+    //There is movement to apply?
+    if (NUMBER_ZERO < factor) {
+        //Check if factor goes beyond goal position
+        plannedReach = NUMBER_ONE <= factor;
+        if (plannedReach) factor = NUMBER_ONE;
+        base->getPosition().lerp(targetPosition, factor, plannedPosition);
+        plannedMove = true;
+    }
+}
+
+void MovementComponent::updateIntegrate() {
+    if (!plannedMove) {
+        return;
+    }
+    plannedMove = false;
+
+    //Apply position
+    base->setPosition(plannedPosition);
+
+    //Next tile is handled in commit phase as it might touch pathfinder
+    if (plannedReach) {
+        path.pop_back();
+        reachedTile = true;
+    }
+}
+
+bool MovementComponent::hasPendingWork() {
+    return !isIdle();
+}
+
 void MovementComponent::setup() {
+    subscribedChanges = ENTITY_CHANGE_DIRECTION;
     const EntityConfig* config = base->getConfig();
     forwardSpeed = float_to_number(config->getData<float>("forward_speed", 0.0));
     altitudeSpeed = float_to_number(config->getData<float>("altitude_speed", 0.0));
+    unsigned int footprint = config->getData<unsigned int>("footprint", 1);
+    base->footprint = std::clamp(footprint, 1u, static_cast<unsigned int>(CLEARANCE_MAX));
 
     //Set movement type
     const std::string& entType = config->type;
@@ -212,9 +363,7 @@ void MovementComponent::simulationChanged() {
             Simulation* simulation =  base->getSimulation();
             World* world = simulation->getWorld();
             Tile* tile = world->getTile(base->getPosition());
-            base->clearTiles();
-            std::shared_ptr<Entity> entity = base->getEntityPtr();
-            tile->addEntity(entity);
+            world->occupyTiles(base->getEntityPtr(), tile);
         }
     } else {
         //Reset state
@@ -222,10 +371,90 @@ void MovementComponent::simulationChanged() {
     }
 }
 
-void MovementComponent::entityChanged() {
+void MovementComponent::entityChanged(entity_changes_t changes) {
     updateSpriteIndex(base);
 }
 
+void MovementComponent::saveState(SaveWriter& writer) {
+    writer.write<uint8_t>(static_cast<uint8_t>(state));
+    writer.write<uint32_t>(static_cast<uint32_t>(path.size()));
+    for (const Tile* tile : path) {
+        writer.write<tile_index_t>(tile->index);
+    }
+
+    //Store what the pending request was for so it can be requested again
+    bool pending = state == MovementState::WaitPathfinder && pathRequest && pathRequest->mode != PathRequestMode::INACTIVE;
+    writer.write<bool>(pending);
+    if (pending) {
+        Tile* destination = pathRequest->getDestination();
+        std::shared_ptr<Entity> target = pathRequest->getTarget();
+        writer.write<bool>(pathRequest->mode == PathRequestMode::ACTIVE_PARTIAL);
+        writer.write<bool>(destination != nullptr);
+        writer.write<tile_index_t>(destination ? destination->index : 0);
+        writer.write<entity_id_t>(target ? target->getID() : 0);
+    }
+
+    //Reservations are restored as they were since they decide which entity waits for other
+    std::vector<TileReservation> reservations;
+    base->getSimulation()->getReservations()->getReservations(base->getID(), reservations);
+    writer.write<uint32_t>(reservationWait);
+    writer.write<uint32_t>(static_cast<uint32_t>(reservations.size()));
+    for (const TileReservation& reservation : reservations) {
+        writer.write<tile_index_t>(reservation.index);
+        writer.write<uint64_t>(reservation.from);
+        writer.write<uint64_t>(reservation.until);
+    }
+}
+
+void MovementComponent::loadState(SaveReader& reader) {
+    Simulation* simulation = base->getSimulation();
+    World* world = simulation->getWorld();
+    state = static_cast<MovementState>(reader.read<uint8_t>());
+    plannedMove = false;
+    plannedReach = false;
+    reachedTile = false;
+    pathRevision = 0;
+    path.clear();
+    uint32_t pathSize = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < pathSize && !reader.hasError(); ++i) {
+        const Tile* tile = world->getTile(reader.read<tile_index_t>());
+        if (tile) {
+            path.push_back(tile);
+        }
+    }
+
+    //Request again the path that was pending, without recording it as a new command
+    pathRequest = nullptr;
+    if (reader.read<bool>()) {
+        bool partial = reader.read<bool>();
+        bool hasDestination = reader.read<bool>();
+        Tile* destination = world->getTile(reader.read<tile_index_t>());
+        std::shared_ptr<Entity> target = simulation->getEntitiesStore()->getEntity(reader.read<entity_id_t>());
+        entity_ptr entityPtr = base->getEntityPtr();
+        PathHandler* pathHandler = getPathHandler(base);
+        if (pathHandler && target && !partial) {
+            pathRequest = pathHandler->requestTarget(entityPtr, target);
+        } else if (pathHandler && hasDestination && destination) {
+            pathRequest = pathHandler->requestDestination(entityPtr, destination, partial);
+        }
+    }
+    if (state == MovementState::WaitPathfinder && !pathRequest) {
+        state = MovementState::Standby;
+    }
+
+    ReservationTable* reservations = simulation->getReservations();
+    entity_id_t entityId = base->getID();
+    reservations->release(entityId);
+    reservationWait = reader.read<uint32_t>();
+    uint32_t reservationsCount = reader.read<uint32_t>();
+    for (uint32_t i = 0; i < reservationsCount && !reader.hasError(); ++i) {
+        tile_index_t index = reader.read<tile_index_t>();
+        uint64_t from = reader.read<uint64_t>();
+        uint64_t until = reader.read<uint64_t>();
+        reservations->reserve(entityId, index, from, until);
+    }
+}
+
 void MovementComponent::chooseSprite() {
     ImageComponent* imageComponent = GET_COMPONENT_DYNAMIC(base, ImageComponent);
     if (state == MovementState::Moving && movementType == MovementType::GroundWalker) {
@@ -244,8 +473,10 @@ bool MovementComponent::isIdle() {
 }
 
 void MovementComponent::stop() {
-    //Remove any pending path
+    //Remove any pending path and reserved tiles
     path.clear();
+    reservationWait = 0;
+    releaseReservations();
 
     //Remove ourselves from request if any
     if (pathRequest) {
@@ -263,13 +494,58 @@ void MovementComponent::stop() {
 }
 
 void MovementComponent::move(Tile* tile) {
+    base->getSimulation()->recordCommand({SimulationCommandType::Move, base->getID(), tile->index});
     entity_ptr entityPtr = base->getEntityPtr();
     PathHandler* pathHandler = getPathHandler(base);
     pathRequest = pathHandler->requestDestination(entityPtr, tile);
     setStateTo(MovementState::WaitPathfinder);
 }
 
+void MovementComponent::moveGroup(std::vector<std::shared_ptr<Entity>>& entities, Tile* tile) {
+    if (entities.empty()) {
+        return;
+    }
+
+    //Record as single command so group is formed again in same way when replaying
+    SimulationCommand command = {SimulationCommandType::MoveGroup, entities.front()->getID(), tile->index};
+    for (size_t i = 1; i < entities.size(); ++i) {
+        command.group.push_back(entities[i]->getID());
+    }
+    entities.front()->getSimulation()->recordCommand(command);
+
+    //Each player has its own path handler so group is split by handler
+    std::vector<bool> grouped(entities.size(), false);
+    for (size_t i = 0; i < entities.size(); ++i) {
+        if (grouped[i]) {
+            continue;
+        }
+        PathHandler* pathHandler = getPathHandler(entities[i].get());
+        std::vector<std::shared_ptr<Entity>> members;
+        std::vector<MovementComponent*> components;
+        for (size_t j = i; j < entities.size(); ++j) {
+            if (grouped[j] || getPathHandler(entities[j].get()) != pathHandler) {
+                continue;
+            }
+            grouped[j] = true;
+            MovementComponent* component = GET_COMPONENT_DYNAMIC(entities[j].get(), MovementComponent);
+            if (component) {
+                members.push_back(entities[j]);
+                components.push_back(component);
+            }
+        }
+        if (!pathHandler || members.empty()) {
+            continue;
+        }
+        std::vector<std::shared_ptr<PathRequest>> requests = pathHandler->requestGroup(members, tile);
+        for (size_t j = 0; j < components.size(); ++j) {
+            components[j]->pathRequest = requests[j];
+            components[j]->setStateTo(MovementState::WaitPathfinder);
+        }
+    }
+}
+
 void MovementComponent::follow(const std::shared_ptr<Entity>& entity) {
+    base->getSimulation()->recordCommand({SimulationCommandType::Follow, base->getID(), entity->getID()});
     entity_ptr entityPtr = base->getEntityPtr();
     PathHandler* pathHandler = getPathHandler(base);
     pathRequest = pathHandler->requestTarget(entityPtr, entity);
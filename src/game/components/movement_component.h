@@ -15,6 +15,7 @@ enum class MovementState {
     ChangeAltitude,
     Rotating,
     Moving,
+    WaitReservation,
 };
 
 /**
@@ -66,6 +67,36 @@ protected:
      */
     std::vector<const Tile*> path;
 
+    /**
+     * Revision of pathfinder result when path was taken
+     */
+    uint32_t pathRevision = 0;
+
+    /**
+     * Position planned to move in integrate phase
+     */
+    Vector2 plannedPosition;
+
+    /**
+     * Flag for pending planned position
+     */
+    bool plannedMove = false;
+
+    /**
+     * Flag for planned position reaching the current path tile
+     */
+    bool plannedReach = false;
+
+    /**
+     * Flag for current path tile reached in integrate phase, handled in commit phase
+     */
+    bool reachedTile = false;
+
+    /**
+     * Ticks waited for next path tile to stop being reserved by other entity
+     */
+    uint32_t reservationWait = 0;
+
     /**
      * Called when new movement state is set
      *
@@ -78,6 +109,28 @@ protected:
      */
     void dispatchPathTile();
 
+    /**
+     * Takes the path repaired by pathfinder if it changed since current path was taken
+     *
+     * @return false if path can't be followed anymore
+     */
+    bool updatePath();
+
+    /**
+     * @return estimated ticks to cross a tile, 0 if entity can't move
+     */
+    uint64_t getTileTicks();
+
+    /**
+     * Reserves the current tile and next path tiles for the ticks entity is expected to be on them
+     */
+    void reservePath();
+
+    /**
+     * Removes all reservations of entity
+     */
+    void releaseReservations();
+
     /*
      * SpriteRotationComponentCommon
      */
@@ -91,6 +144,21 @@ public:
     /** @return if entity is idle without any pending stuff */
     bool isIdle();
 
+    /**
+     * Computes the next position from path without applying it
+     */
+    void updatePlan();
+
+    /**
+     * Applies the planned position
+     */
+    void updateIntegrate();
+
+    /**
+     * @return true if entity is not idle
+     */
+    bool hasPendingWork();
+
     /**
      * Tells the movement component to stop any movement
      *
@@ -105,6 +173,15 @@ public:
      */
     void move(Tile* tile);
 
+    /**
+     * Tells the movement components of entities to start moving together to target tile, a single path is searched
+     * and entities take formation slots near target tile
+     *
+     * @param entities to move
+     * @param tile
+     */
+    static void moveGroup(std::vector<std::shared_ptr<Entity>>& entities, Tile* tile);
+
     /**
      * Tells the movement component to start following the entity to target entity
      *
@@ -69,10 +69,15 @@ void PaletteComponent::simulationChanged() {
     //Setup the rest
     setupShadows(config);
     palette->setColor(0xFF - lowestEntry, Color::BLACK);
-    palette->updateTexture();
 }
 
-void PaletteComponent::entityChanged() {
+void PaletteComponent::entityChanged(entity_changes_t changes) {
+}
+
+void PaletteComponent::saveState(SaveWriter& writer) {
+}
+
+void PaletteComponent::loadState(SaveReader& reader) {
 }
 
 void PaletteComponent::setupShadows(const EntityConfig* config) {
@@ -137,7 +142,6 @@ void PaletteComponent::setLight(bool state) {
             //Nothing to do
             return;
     }
-    palette->updateTexture();
 }
 
 std::shared_ptr<Palette> PaletteComponent::getPalette() {
@@ -13,6 +13,7 @@ void SpriteDamageComponent::update() {
 }
 
 void SpriteDamageComponent::setup() {
+    subscribedChanges = ENTITY_CHANGE_HEALTH;
 }
 
 void SpriteDamageComponent::simulationChanged() {
@@ -25,10 +26,16 @@ void SpriteDamageComponent::simulationChanged() {
     }
 }
 
-void SpriteDamageComponent::entityChanged() {
+void SpriteDamageComponent::entityChanged(entity_changes_t changes) {
     chooseSprite();
 }
 
+void SpriteDamageComponent::saveState(SaveWriter& writer) {
+}
+
+void SpriteDamageComponent::loadState(SaveReader& reader) {
+}
+
 void SpriteDamageComponent::chooseSprite() {
     ImageComponent* imageComponent = GET_COMPONENT_DYNAMIC(base, ImageComponent);
 
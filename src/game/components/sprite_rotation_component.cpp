@@ -45,6 +45,7 @@ void SpriteRotationComponent::update() {
 }
 
 void SpriteRotationComponent::setup() {
+    subscribedChanges = ENTITY_CHANGE_DIRECTION;
 }
 
 void SpriteRotationComponent::simulationChanged() {
@@ -53,10 +54,16 @@ void SpriteRotationComponent::simulationChanged() {
     }
 }
 
-void SpriteRotationComponent::entityChanged() {
+void SpriteRotationComponent::entityChanged(entity_changes_t changes) {
     updateSpriteIndex(base);
 }
 
+void SpriteRotationComponent::saveState(SaveWriter& writer) {
+}
+
+void SpriteRotationComponent::loadState(SaveReader& reader) {
+}
+
 void SpriteRotationComponent::chooseSprite() {
     ImageComponent* imageComponent = GET_COMPONENT_DYNAMIC(base, ImageComponent);
     imageComponent->setImageFromSprite("default_" + std::to_string(spriteIndex));
@@ -5,6 +5,8 @@
 #include "engine/graphics/window.h"
 #include "engine/simulation/player.h"
 #include "engine/simulation/faction.h"
+#include "engine/simulation/entity_store.h"
+#include "engine/simulation/replay.h"
 #include "engine/simulation/world/world.h"
 #include "engine/simulation/world/tile.h"
 #include "engine/core/utils.h"
@@ -18,7 +20,7 @@
 #include "game/gui/game_layout.h"
 #include "game.h"
 
-number_t Game::SpriteRotationCorrection = 0;
+const number_t Game::SpriteRotationCorrection = number_div(NUMBER_PI, int_to_number(2));
 
 void Game::setupEventHandler() {
     //Register event listeners
@@ -64,24 +66,57 @@ void Game::setupEntityManager() {
     Engine::setupEntityManager();
 }
 
-void Game::setupSimulation(std::unique_ptr<SimulationParameters> parameters) {
+std::unique_ptr<SimulationParameters> Game::createSimulationParameters() {
+    //Fixed level and players until they can be chosen from menu
+    std::unique_ptr<SimulationParameters> parameters = std::make_unique<SimulationParameters>();
+    parameters->seed = 1;
+    parameters->loadLevelContent = true;
+    parameters->world = "LEVEL/DATA/LEVEL01";
+    parameters->world = "LEVEL/DATA/LEVEL06";
+    //parameters->world = "LEVEL/DATA/LEVEL351";
+    //parameters->world = "LEVEL/DATA/LEVEL334";
+    //parameters->world = "LEVEL2/DATA/LEVEL511";
+    std::unique_ptr<Player> player = std::make_unique<Player>(1);
+    player->color = {{0x60, 0xA0, 0x20, 0xFF}};
+    parameters->players.emplace_back(std::move(player));
+    player = std::make_unique<Player>(2);
+    player->color = {{0xFF, 0x40, 0x40, 0xFF}};
+    parameters->players.emplace_back(std::move(player));
+
+    //Test entities are spawned unless disabled in config
+    parameters->testEntities = getData<bool>("test_entities", true);
+    return parameters;
+}
+
+std::unique_ptr<Simulation> Game::createSimulation(std::unique_ptr<SimulationParameters> parameters, SaveReader* reader) {
     //Call setup
-    Engine::setupSimulation(std::move(parameters));
-    if (hasError()) return;
+    bool testEntities = parameters && parameters->testEntities;
+    std::unique_ptr<Simulation> simulationPtr = Engine::createSimulation(std::move(parameters), reader);
+    if (hasError()) return nullptr;
 
     //Load the simulation
-    simulation->loadWorld();
-    error = simulation->getError();
-    if (hasError()) return;
-
-    simulation->loadPlayers();
-    error = simulation->getError();
-    if (hasError()) return;
-    setupPlayerColors();
-
-    simulation->loadEntities();
-    error = simulation->getError();
-    if (hasError()) return;
+    simulationPtr->loadWorld();
+    error = simulationPtr->getError();
+    if (hasError()) return nullptr;
+
+    simulationPtr->loadPlayers();
+    error = simulationPtr->getError();
+    if (hasError()) return nullptr;
+    setupPlayerColors(simulationPtr.get());
+
+    simulationPtr->loadEntities();
+    error = simulationPtr->getError();
+    if (hasError()) return nullptr;
+
+    //Restore the save if loading any, otherwise create test entities if requested
+    if (reader) {
+        loadSimulationState(simulationPtr.get(), *reader);
+        if (hasError()) return nullptr;
+    } else if (testEntities) {
+        spawnTestEntities(simulationPtr.get());
+    }
+
+    return simulationPtr;
 }
 
 void Game::setupGUI() {
@@ -89,45 +124,91 @@ void Game::setupGUI() {
     Engine::setupGUI();
 }
 
+void Game::applyCommand(Simulation* simulationPtr, const SimulationCommand& command) {
+    std::shared_ptr<Entity> entity = simulationPtr->getEntitiesStore()->getEntity(command.entity);
+    MovementComponent* movement = entity ? GET_COMPONENT_DYNAMIC(entity.get(), MovementComponent) : nullptr;
+    if (!movement) {
+        log->warn("Command entity {0} not found or can't move", command.entity);
+        return;
+    }
+    switch (command.type) {
+        case SimulationCommandType::Move: {
+            Tile* tile = simulationPtr->getWorld()->getTile(static_cast<tile_index_t>(command.target));
+            if (tile) {
+                movement->move(tile);
+            }
+            break;
+        }
+        case SimulationCommandType::MoveGroup: {
+            Tile* tile = simulationPtr->getWorld()->getTile(static_cast<tile_index_t>(command.target));
+            std::vector<std::shared_ptr<Entity>> entities;
+            entities.push_back(entity);
+            for (entity_id_t member : command.group) {
+                std::shared_ptr<Entity> memberEntity = simulationPtr->getEntitiesStore()->getEntity(member);
+                if (memberEntity) {
+                    entities.push_back(memberEntity);
+                }
+            }
+            if (tile) {
+                MovementComponent::moveGroup(entities, tile);
+            }
+            break;
+        }
+        case SimulationCommandType::Follow: {
+            std::shared_ptr<Entity> target = simulationPtr->getEntitiesStore()->getEntity(command.target);
+            if (target) {
+                movement->follow(target);
+            }
+            break;
+        }
+        default:
+            Engine::applyCommand(simulationPtr, command);
+            break;
+    }
+}
+
 void Game::run() {
     Engine::run();
     if (hasError()) {
         return;
     }
 
-    //Setup static stuff
-    SpriteRotationCorrection = number_div(NUMBER_PI, int_to_number(2));
+    //Run many headless simulations instead of the interactive one if requested
+    if (0 < batchCount) {
+        runBatch();
+        return;
+    }
 
     //Prepare simulation
-    //TODO this is only for testings
-    std::unique_ptr<SimulationParameters> parameters = std::make_unique<SimulationParameters>();
-    parameters->seed = 1;
-    parameters->loadLevelContent = true;
-    parameters->world = "LEVEL/DATA/LEVEL01";
-    parameters->world = "LEVEL/DATA/LEVEL06";
-    //parameters->world = "LEVEL/DATA/LEVEL351";
-    //parameters->world = "LEVEL/DATA/LEVEL334";
-    //parameters->world = "LEVEL2/DATA/LEVEL511";
-    std::unique_ptr<Player> player = std::make_unique<Player>(1);
-    player->color = {{0x60, 0xA0, 0x20, 0xFF}};
-    parameters->players.emplace_back(std::move(player));
-    player = std::make_unique<Player>(2);
-    player->color = {{0xFF, 0x40, 0x40, 0xFF}};
-    parameters->players.emplace_back(std::move(player));
-
-    setupSimulation(std::move(parameters));
+    setupSimulation(createSimulationParameters());
     if (hasError()) {
         return;
     }
-
-    //Create some entities
     Player* playerPtr = simulation->getPlayer(1);
+
+    //Do like we are launching the game GUI
+    auto gameLayout = std::make_shared<GameLayout>();
+    gameLayout->setUserPlayer(playerPtr);
+    setGUI(gameLayout);
+
+    //Show main window
+    if (window) {
+        window->show();
+    }
+
+    //Main loop
+    log->debug("Starting loop");
+    loop();
+}
+
+void Game::spawnTestEntities(Simulation* simulationPtr) {
+    Player* playerPtr = simulationPtr->getPlayer(1);
     std::shared_ptr<Entity> entityPtr = entityManager->makeEntity({ENTITY_KIND_BUILDING, 19});
     entityPtr->setPosition({64 * 8 + 32, 64 * 8 + 32});
     PlayerComponent* component = GET_COMPONENT_DYNAMIC(entityPtr.get(), PlayerComponent);
     component->setPlayer(playerPtr);
-    simulation->addEntity(entityPtr);
-    auto tile = simulation->getWorld()->getTile(10, 2);
+    simulationPtr->addEntity(entityPtr);
+    auto tile = simulationPtr->getWorld()->getTile(10, 2);
     unsigned int y = 0;
     for (unsigned int i = 41; i <= 85; ++i) {
         entityPtr = entityManager->makeEntity({ENTITY_KIND_UNIT, i});
@@ -144,7 +225,7 @@ void Game::run() {
         }
         component = GET_COMPONENT_DYNAMIC(entityPtr.get(), PlayerComponent);
         component->setPlayer(playerPtr);
-        simulation->addEntity(entityPtr);
+        simulationPtr->addEntity(entityPtr);
         y++;
 
         //Test pathfinder
@@ -153,28 +234,11 @@ void Game::run() {
             movement->move(tile);
         }
     }
-
-    //Do like we are launching the game GUI
-    auto gameLayout = std::make_shared<GameLayout>();
-    gameLayout->setUserPlayer(playerPtr);
-    setGUI(gameLayout);
-
-    //Show main window
-    if (window) {
-        window->show();
-    }
-
-    //Main loop
-    log->debug("Starting loop");
-    while (!eventHandler->isClosing()) {
-        update();
-        draw();
-    }
 }
 
-void Game::setupPlayerColors() {
+void Game::setupPlayerColors(Simulation* simulationPtr) {
     //Generate player palette colors using base color
-    for (std::unique_ptr<Player>& player : simulation->getPlayers()) {
+    for (std::unique_ptr<Player>& player : simulationPtr->getPlayers()) {
         if (!player) continue;
         ColorHSV base;
         base.fromRGB(player->color);
@@ -193,8 +257,10 @@ void Game::setupPlayerColors() {
 }
 
 void Game::setReactorCrate(Tile& tile) {
-    BIT_OFF(tile.tileFlags, TILE_FLAG_PASSABLE);
-    BIT_ON(tile.tileFlags, TILE_FLAG_IMMUTABLE);
+    tile_flags_t flags = tile.tileFlags;
+    BIT_OFF(flags, TILE_FLAG_PASSABLE);
+    BIT_ON(flags, TILE_FLAG_IMMUTABLE);
+    tile.setTileFlags(flags);
     tile.isImageDirty = true;
     //TODO set damage type and destroy any entity inside
     //TODO mark the surrounding tiles a radiactive
@@ -17,7 +17,7 @@ protected:
     /**
      * Correction to apply when converting rotation
      */
-    static number_t SpriteRotationCorrection;
+    static const number_t SpriteRotationCorrection;
 
     void run() override;
 
@@ -27,14 +27,27 @@ protected:
 
     void setupEntityManager() override;
 
-    void setupSimulation(std::unique_ptr<SimulationParameters> parameters) override;
+    std::unique_ptr<SimulationParameters> createSimulationParameters() override;
+
+    std::unique_ptr<Simulation> createSimulation(std::unique_ptr<SimulationParameters> parameters, SaveReader* reader) override;
 
     void setupGUI() override;
 
+    void applyCommand(Simulation* simulationPtr, const SimulationCommand& command) override;
+
+    /**
+     * Creates some entities for testing, only done if simulation parameters request it
+     *
+     * @param simulationPtr simulation to create entities in
+     */
+    void spawnTestEntities(Simulation* simulationPtr);
+
     /**
      * Setup player extra colors as palette colors
+     *
+     * @param simulationPtr simulation which players to setup
      */
-    void setupPlayerColors();
+    void setupPlayerColors(Simulation* simulationPtr);
 
     /**
      * Sets a tile as reactor crate
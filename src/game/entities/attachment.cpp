@@ -3,16 +3,16 @@
 //
 #include "src/engine/entities/entity_config.h"
 #include "engine/simulation/world/world.h"
+#include "engine/simulation/render_snapshot.h"
 #include "attachment.h"
 
 void Spinner::simulationChanged() {
     if (isActive()) {
         applyCorrection = config->code == "flywheel_mine";
-        //Setup the animation
+        //Setup the animation, it goes forth and back while flipping the image to look like a full rotation
         setAnimationFromSprite("default");
-        if (animation) {
-            animation->reverse = !clockwise;
-        }
+        setAnimationFlag(ANIMATION_FLAG_REVERSE, !clockwise);
+        setAnimationFlag(ANIMATION_FLAG_PINGPONG, true);
     }
 
     Entity::simulationChanged();
@@ -20,31 +20,32 @@ void Spinner::simulationChanged() {
 
 void Spinner::update() {
     Entity::update();
-    if (!animation) {
+}
+
+void Spinner::snapshot(RenderSnapshot& snapshot) {
+    size_t spritesCount = snapshot.sprites.size();
+    ImageComponent::snapshot(snapshot);
+    if (snapshot.sprites.size() == spritesCount) {
         return;
     }
 
-    //Check if animation finished, flip the image and reverse the animation
-    if (animation->isFinished()) {
-        animation->reverse = !animation->reverse;
-    }
-    imageFlipX = clockwise == animation->reverse;
+    //Flip the captured image when animation goes backwards, the component state is left untouched
+    RenderSnapshotSprite& sprite = snapshot.sprites.back();
+    bool backwards = false;
+    size_t index = getAnimationIndex(backwards);
+    bool flipX = clockwise == backwards;
+    if (flipX) sprite.size.x *= -1;
 
     //Some sprites need compensation of X by 1 pixel
     if (applyCorrection) {
-        size_t index = animation->getCurrentIndex();
         if (index < 2) {
-            imageOffset.x = imageFlipX ? -1 : 1;
+            sprite.offset.x = flipX ? -1 : 1;
         } else {
-            imageOffset.x = 0;
+            sprite.offset.x = 0;
         }
     }
 }
 
-void Spinner::draw() {
-    ImageComponent::draw(renderer);
-}
-
 void ConveyorBelt::simulationChanged() {
     if (isActive()) {
         ImageComponentSlotted<0>::setImageFromSprite("head");
@@ -74,38 +75,35 @@ void ConveyorBelt::update() {
     Entity::update();
 }
 
-void ConveyorBelt::draw() {
-    ImageComponentSlotted<0>::draw(renderer);
-    ImageComponentSlotted<1>::draw(renderer);
+void ConveyorBelt::snapshot(RenderSnapshot& snapshot) {
+    ImageComponentSlotted<0>::snapshot(snapshot);
+    ImageComponentSlotted<1>::snapshot(snapshot);
 }
 
 void ConveyorBelt::setDirection(bool left) {
-    auto& animation = ImageComponentSlotted<1>::animation;
-    if (animation) {
-        animation->reverse = left;
-    }
+    ImageComponentSlotted<1>::setAnimationFlag(ANIMATION_FLAG_REVERSE, left);
 }
 
 void ConveyorBelt::setRunning(bool state) {
-    ImageComponentSlotted<1>::animationPlay = state;
+    ImageComponentSlotted<1>::setAnimationPlay(state);
 }
 
 void BuildingExit::update() {
     Entity::update();
 }
 
-void BuildingExit::draw() {
-    ImageComponent::draw(renderer);
+void BuildingExit::snapshot(RenderSnapshot& snapshot) {
+    ImageComponent::snapshot(snapshot);
 }
 
 void BuildingExitUnderground::update() {
     Entity::update();
 }
 
-void BuildingExitUnderground::draw() {
-    ImageComponentSlotted<0>::draw(renderer);
-    ImageComponentSlotted<1>::draw(renderer);
-    ImageComponentSlotted<2>::draw(renderer);
+void BuildingExitUnderground::snapshot(RenderSnapshot& snapshot) {
+    ImageComponentSlotted<0>::snapshot(snapshot);
+    ImageComponentSlotted<1>::snapshot(snapshot);
+    ImageComponentSlotted<2>::snapshot(snapshot);
 }
 
 void Turret::simulationChanged() {
@@ -125,6 +123,6 @@ void Turret::update() {
     setDirection(number_add(getDirection(), float_to_number(0.005)));
 }
 
-void Turret::draw() {
-    ImageComponent::draw(renderer);
+void Turret::snapshot(RenderSnapshot& snapshot) {
+    ImageComponent::snapshot(snapshot);
 }
\ No newline at end of file
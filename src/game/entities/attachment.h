@@ -25,7 +25,7 @@ CLASS_ENTITY_COMPONENTS(Entity, Spinner, ImageComponent)
 
     void update() override;
 
-    void draw() override;
+    void snapshot(RenderSnapshot& snapshot) override;
 };
 
 /**
@@ -39,7 +39,7 @@ public:
 
     void update() override;
 
-    void draw() override;
+    void snapshot(RenderSnapshot& snapshot) override;
 
     /**
      * Controls if animation is left or right
@@ -62,7 +62,7 @@ CLASS_ENTITY_COMPONENTS(Entity, BuildingExit,
 public:
     void update() override;
 
-    void draw() override;
+    void snapshot(RenderSnapshot& snapshot) override;
 };
 
 /**
@@ -77,7 +77,7 @@ CLASS_ENTITY_COMPONENTS(Entity, BuildingExitUnderground,
 public:
     void update() override;
 
-    void draw() override;
+    void snapshot(RenderSnapshot& snapshot) override;
 };
 
 /**
@@ -90,7 +90,7 @@ CLASS_ENTITY_COMPONENTS(Entity, Turret,
 
     void update() override;
 
-    void draw() override;
+    void snapshot(RenderSnapshot& snapshot) override;
 };
 
 #endif //OPENE2140_ATTACHMENT_H
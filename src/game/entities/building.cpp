@@ -11,6 +11,10 @@ void Building::simulationChanged() {
     if (isActive()) {
         setSelectable(true);
 
+        //Layout is relative to the tile where building is placed
+        World* world = simulation->getWorld();
+        Tile* origin = world->getTile(position);
+
         //Set the building bounds
         simulation->toWorldRectangle(config->bounds, bounds, false);
         bounds += Rectangle(position);
@@ -23,15 +27,27 @@ void Building::simulationChanged() {
         config->getRectangle("offset", offset);
         bounds += offset;
 
-        //Layout setup to claim tiles
+        //Layout setup to claim tiles, unless tiles were already restored from save
+        entityFlagsMask = TILE_FLAG_ENTITY_TERRAIN;
         config_data_t layout = config->getData("layout");
-        if (layout.is_array()) {
+        if (origin && getTiles().empty() && layout.is_array()) {
+            const Rectangle& rectangle = world->getRealRectangle();
+            std::shared_ptr<Entity> entity = getEntityPtr();
             for (config_data_t& layoutData : layout) {
                 Rectangle layoutRectangle;
                 if (!Config::getRectangle(layoutData, layoutRectangle)) {
                     continue;
                 }
-                //TODO
+                layoutRectangle += Rectangle(origin->position);
+                for (int y = layoutRectangle.y; y < layoutRectangle.y + layoutRectangle.h; ++y) {
+                    for (int x = layoutRectangle.x; x < layoutRectangle.x + layoutRectangle.w; ++x) {
+                        if (!rectangle.isInside(x, y)) {
+                            continue;
+                        }
+                        Tile* tile = world->getTile(static_cast<unsigned int>(x), static_cast<unsigned int>(y));
+                        tile->addEntity(entity, false);
+                    }
+                }
             }
         }
     }
@@ -39,15 +55,17 @@ void Building::simulationChanged() {
     Entity::simulationChanged();
 }
 
-void Building::entityChanged() {
-    setLight(energySatisfied);
+void Building::entityChanged(entity_changes_t changes) {
+    if (changes & ENTITY_CHANGE_ENERGY) {
+        setLight(energySatisfied);
+    }
 
     //First call parent code
-    Entity::entityChanged();
+    Entity::entityChanged(changes);
 }
 
-void Building::draw() {
-    ImageComponent::draw(renderer);
+void Building::snapshot(RenderSnapshot& snapshot) {
+    ImageComponent::snapshot(snapshot);
 }
 
 void Mine::simulationChanged() {
@@ -63,19 +81,21 @@ void Mine::simulationChanged() {
     }
 }
 
-void Mine::entityChanged() {
+void Mine::entityChanged(entity_changes_t changes) {
     //Update attached entities energy
-    Spinner* spinner = dynamic_cast<Spinner*>(AttachmentComponent::getAttached("flywheel_top").get());
-    if (spinner) {
-        spinner->animationPlay = energySatisfied;
-    }
-    spinner = dynamic_cast<Spinner*>(AttachmentComponent::getAttached("flywheel_bottom").get());
-    if (spinner) {
-        spinner->animationPlay = energySatisfied;
+    if (changes & ENTITY_CHANGE_ENERGY) {
+        Spinner* spinner = dynamic_cast<Spinner*>(AttachmentComponent::getAttached("flywheel_top").get());
+        if (spinner) {
+            spinner->setAnimationPlay(energySatisfied);
+        }
+        spinner = dynamic_cast<Spinner*>(AttachmentComponent::getAttached("flywheel_bottom").get());
+        if (spinner) {
+            spinner->setAnimationPlay(energySatisfied);
+        }
     }
 
     //First call parent code
-    Entity::entityChanged();
+    Entity::entityChanged(changes);
 }
 
 void Refinery::simulationChanged() {
@@ -91,7 +111,7 @@ void Refinery::simulationChanged() {
     }
 }
 
-void Refinery::entityChanged() {
+void Refinery::entityChanged(entity_changes_t changes) {
     /*
     ConveyorBelt* conveyor = dynamic_cast<ConveyorBelt*>(AttachmentComponent::getAttached("conveyor_belt").get());
     if (conveyor) {
@@ -100,5 +120,5 @@ void Refinery::entityChanged() {
     */
 
     //First call parent code
-    Building::entityChanged();
+    Building::entityChanged(changes);
 }
\ No newline at end of file
@@ -29,9 +29,9 @@ CLASS_ENTITY_COMPONENTS(Entity, Building,
 public:
     void simulationChanged() override;
 
-    void entityChanged() override;
+    void entityChanged(entity_changes_t changes) override;
 
-    void draw() override;
+    void snapshot(RenderSnapshot& snapshot) override;
 };
 
 /**
@@ -48,7 +48,7 @@ CLASS_ENTITY(Building, Mine)
 public:
     void simulationChanged() override;
 
-    void entityChanged() override;
+    void entityChanged(entity_changes_t changes) override;
 };
 
 /**
@@ -58,7 +58,7 @@ CLASS_ENTITY(Building, Refinery)
 public:
     void simulationChanged() override;
 
-    void entityChanged() override;
+    void entityChanged(entity_changes_t changes) override;
 };
 
 #endif //OPENE2140_BUILDING_H
@@ -6,6 +6,7 @@
 
 #include "engine/io/config.h"
 #include "engine/entities/entity_factory.h"
+#include "engine/entities/entity_pool.h"
 #include "game/core/constants.h"
 #include "building.h"
 #include "object.h"
@@ -37,6 +38,26 @@ public:
 class ObjectFactory: public ACommonEntityFactory {
     TYPE_NAME_OVERRIDE(ObjectFactory);
 
+    /**
+     * Pool for Object entities
+     */
+    EntityPool<Object> objectPool;
+
+    /**
+     * Pool for Tree entities
+     */
+    EntityPool<Tree> treePool;
+
+    /**
+     * Pool for Ore entities
+     */
+    EntityPool<Ore> orePool;
+
+    /**
+     * Pool for Wall entities
+     */
+    EntityPool<Wall> wallPool;
+
     std::string getConfigPath() const override {
         return "objects.json";
     }
@@ -53,17 +74,17 @@ class ObjectFactory: public ACommonEntityFactory {
         return ENTITY_KIND_OBJECT;
     }
 
-    std::shared_ptr<Entity> instanceEntity(EntityConfig* config) override {
+    IEntityPool* getEntityPool(EntityConfig* config) override {
         if (config) {
             if (config->type == "tree") {
-                return std::make_shared<Tree>();
+                return &treePool;
             } else if (config->type == "ore") {
-                return std::make_shared<Ore>();
+                return &orePool;
             } else if (config->type == "wall") {
-                return std::make_shared<Wall>();
+                return &wallPool;
             }
         }
-        return std::make_shared<Object>();
+        return &objectPool;
     }
 
     void setupEntityConfig(EntityConfig* config) override {
@@ -88,6 +109,11 @@ class ObjectFactory: public ACommonEntityFactory {
 class UnitFactory: public ACommonEntityFactory {
     TYPE_NAME_OVERRIDE(UnitFactory);
 
+    /**
+     * Pool for Unit entities
+     */
+    EntityPool<Unit> unitPool;
+
     std::string getConfigPath() const override {
         return "units.json";
     }
@@ -100,8 +126,8 @@ class UnitFactory: public ACommonEntityFactory {
         return ENTITY_KIND_UNIT;
     }
 
-    std::shared_ptr<Entity> instanceEntity(EntityConfig* config) override {
-        return std::make_shared<Unit>();
+    IEntityPool* getEntityPool(EntityConfig* config) override {
+        return &unitPool;
     }
 
     void setupEntityConfig(EntityConfig* config) override {
@@ -146,6 +172,26 @@ class UnitFactory: public ACommonEntityFactory {
 class BuildingFactory: public ACommonEntityFactory {
     TYPE_NAME_OVERRIDE(BuildingFactory);
 
+    /**
+     * Pool for Building entities
+     */
+    EntityPool<Building> buildingPool;
+
+    /**
+     * Pool for Factory entities
+     */
+    EntityPool<Factory> factoryPool;
+
+    /**
+     * Pool for Mine entities
+     */
+    EntityPool<Mine> minePool;
+
+    /**
+     * Pool for Refinery entities
+     */
+    EntityPool<Refinery> refineryPool;
+
     std::string getConfigPath() const override {
         return "buildings.json";
     }
@@ -158,20 +204,20 @@ class BuildingFactory: public ACommonEntityFactory {
         return ENTITY_KIND_BUILDING;
     }
 
-    std::shared_ptr<Entity> instanceEntity(EntityConfig* config) override {
+    IEntityPool* getEntityPool(EntityConfig* config) override {
         if (config) {
             if (config->type == "construction_factory"
             || config->type == "light_factory"
             || config->type == "heavy_factory"
             || config->type == "heavy_factory") {
-                return std::make_shared<Factory>();
+                return &factoryPool;
             } else if (config->code == "mine") {
-                return std::make_shared<Mine>();
+                return &minePool;
             } else if (config->code == "refinery") {
-                return std::make_shared<Refinery>();
+                return &refineryPool;
             }
         }
-        return std::make_shared<Building>();
+        return &buildingPool;
     }
 
     void setupEntityConfig(EntityConfig* config) override {
@@ -215,6 +261,31 @@ class BuildingFactory: public ACommonEntityFactory {
 class AttachmentFactory: public ACommonEntityFactory {
     TYPE_NAME_OVERRIDE(AttachmentFactory);
 
+    /**
+     * Pool for Spinner entities
+     */
+    EntityPool<Spinner> spinnerPool;
+
+    /**
+     * Pool for Turret entities
+     */
+    EntityPool<Turret> turretPool;
+
+    /**
+     * Pool for BuildingExit entities
+     */
+    EntityPool<BuildingExit> buildingExitPool;
+
+    /**
+     * Pool for BuildingExitUnderground entities
+     */
+    EntityPool<BuildingExitUnderground> buildingExitUndergroundPool;
+
+    /**
+     * Pool for ConveyorBelt entities
+     */
+    EntityPool<ConveyorBelt> conveyorBeltPool;
+
     std::string getConfigPath() const override {
         return "attachments.json";
     }
@@ -223,21 +294,21 @@ class AttachmentFactory: public ACommonEntityFactory {
         return ENTITY_KIND_ATTACHMENT;
     }
 
-    std::shared_ptr<Entity> instanceEntity(EntityConfig* config) override {
+    IEntityPool* getEntityPool(EntityConfig* config) override {
         if (config) {
             if (config->type == "spinner") {
-                return std::make_shared<Spinner>();
+                return &spinnerPool;
             } else if (config->type == "turret") {
-                return std::make_shared<Turret>();
+                return &turretPool;
             } else if (config->type == "building_exit") {
-                return std::make_shared<BuildingExit>();
+                return &buildingExitPool;
             } else if (config->type == "building_exit_underground") {
-                return std::make_shared<BuildingExitUnderground>();
+                return &buildingExitUndergroundPool;
             } else if (config->code == "conveyor_belt") {
-                return std::make_shared<ConveyorBelt>();
+                return &conveyorBeltPool;
             }
         }
-        return std::shared_ptr<Entity>();
+        return nullptr;
     }
 
     void setupEntityConfig(EntityConfig* config) override {
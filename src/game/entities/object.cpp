@@ -16,8 +16,8 @@ void Object::simulationChanged() {
     Entity::simulationChanged();
 }
 
-void Object::draw() {
-    ImageComponent::draw(renderer);
+void Object::snapshot(RenderSnapshot& snapshot) {
+    ImageComponent::snapshot(snapshot);
 }
 
 void Tree::simulationChanged() {
@@ -28,17 +28,17 @@ void Tree::simulationChanged() {
     Entity::simulationChanged();
 }
 
-void Tree::draw() {
-    ImageComponent::draw(renderer);
+void Tree::snapshot(RenderSnapshot& snapshot) {
+    ImageComponent::snapshot(snapshot);
 }
 
-void Ore::draw() {
-    ImageComponent::draw(renderer);
+void Ore::snapshot(RenderSnapshot& snapshot) {
+    ImageComponent::snapshot(snapshot);
 }
 
-void Wall::draw() {
-    ImageComponentSlotted<0>::draw(renderer);
-    ImageComponentSlotted<1>::draw(renderer);
-    ImageComponentSlotted<2>::draw(renderer);
-    ImageComponentSlotted<3>::draw(renderer);
+void Wall::snapshot(RenderSnapshot& snapshot) {
+    ImageComponentSlotted<0>::snapshot(snapshot);
+    ImageComponentSlotted<1>::snapshot(snapshot);
+    ImageComponentSlotted<2>::snapshot(snapshot);
+    ImageComponentSlotted<3>::snapshot(snapshot);
 }
\ No newline at end of file
@@ -20,7 +20,7 @@ CLASS_ENTITY_COMPONENTS(Entity, Object,
 public:
     void simulationChanged() override;
 
-    void draw() override;
+    void snapshot(RenderSnapshot& snapshot) override;
 };
 
 /**
@@ -33,7 +33,7 @@ CLASS_ENTITY_COMPONENTS(Entity, Tree,
 public:
     void simulationChanged() override;
 
-    void draw() override;
+    void snapshot(RenderSnapshot& snapshot) override;
 };
 
 /**
@@ -44,7 +44,7 @@ CLASS_ENTITY_COMPONENTS(Entity, Ore,
                         MovementComponent,
                         PaletteComponent)
 public:
-    void draw() override;
+    void snapshot(RenderSnapshot& snapshot) override;
 };
 
 /**
@@ -56,7 +56,7 @@ CLASS_ENTITY_COMPONENTS(Entity, Wall,
                         ImageComponentSlotted<2>,
                         ImageComponentSlotted<3>)
 public:
-    void draw() override;
+    void snapshot(RenderSnapshot& snapshot) override;
 };
 
 #endif //OPENE2140_OBJECT_H
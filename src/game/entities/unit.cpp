@@ -14,6 +14,6 @@ void Unit::simulationChanged() {
     Entity::simulationChanged();
 }
 
-void Unit::draw() {
-    ImageComponent::draw(renderer);
+void Unit::snapshot(RenderSnapshot& snapshot) {
+    ImageComponent::snapshot(snapshot);
 }
\ No newline at end of file
@@ -28,7 +28,7 @@ CLASS_ENTITY_COMPONENTS(Entity, Unit,
 public:
     void simulationChanged() override;
 
-    void draw() override;
+    void snapshot(RenderSnapshot& snapshot) override;
 };
 
 #endif //OPENE2140_UNIT_H
@@ -8,6 +8,8 @@
 #include "engine/gui/game/selection_overlay.h"
 #include "engine/gui/game/simulation_view.h"
 #include "engine/gui/game/camera_view.h"
+#include "engine/gui/metrics_overlay.h"
+#include "engine/io/metrics.h"
 
 /**
  * Provides the running game layout of views
@@ -27,6 +29,13 @@ public:
             simulationView->addView(std::make_unique<SelectionOverlay>());
             simulationView->addView(std::make_unique<CameraView>());
             addView(std::move(simulationView));
+
+            //Add the metrics overlay on top in screen space
+            auto metricsOverlay = std::make_unique<MetricsOverlay>();
+            metricsOverlay->addGraph(METRIC_TICK_MS, GAME_DELTA, Color::GREEN);
+            metricsOverlay->addGraph(METRIC_FRAME_MS, 0, Color::CYAN);
+            metricsOverlay->addGraph(METRIC_ASTAR_EXPANSIONS, 0, Color::YELLOW);
+            addView(std::move(metricsOverlay));
         }
 
     }
@@ -5,12 +5,14 @@
 #include "game/core/game.h"
 #include "engine/simulation/simulation.h"
 #include "engine/simulation/world/world.h"
+#include "engine/io/metrics.h"
 #include "event_listener_debug.h"
 
 EventListenerDebug::EventListenerDebug(const std::shared_ptr<Game>& game): game(game) {
     keyDebugEntities = game->getKeyBind("F2");
     keyDebugTiles = game->getKeyBind("F3");
     keyDebugEvents = game->getKeyBind("F4");
+    keyDebugMetrics = game->getKeyBind("F5");
 }
 
 EventListenerDebug::~EventListenerDebug() {
@@ -30,6 +32,9 @@ bool EventListenerDebug::eventKeyChange(Window* window, input_key_t& key) {
         } else if (key.code == keyDebugEvents) {
             //Print event tree
             game->getEventHandler()->printTree(game->log);
+        } else if (key.code == keyDebugMetrics) {
+            Metrics* metrics = game->getMetrics();
+            metrics->debugOverlay = !metrics->debugOverlay;
         }
     }
     return false;
@@ -26,6 +26,7 @@ private:
     input_key_code_t keyDebugEntities = 0;
     input_key_code_t keyDebugTiles = 0;
     input_key_code_t keyDebugEvents = 0;
+    input_key_code_t keyDebugMetrics = 0;
 public:
     /**
      * Event handler constructor
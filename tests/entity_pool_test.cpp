@@ -0,0 +1,56 @@
+//
+// Created by Ion Agorria on 19/10/26
+//
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+/**
+ * Minimal entity so pools can be tested without the simulation
+ */
+class Entity {
+public:
+    virtual ~Entity() = default;
+};
+
+#include "engine/entities/entity_pool.h"
+
+/**
+ * Entity class which two types share the pool of
+ */
+class TestEntity: public Entity {
+public:
+    int value = 0;
+};
+
+/**
+ * Checks a condition and prints the failure
+ */
+#define TEST_CHECK(CONDITION) \
+    if (!(CONDITION)) { \
+        std::printf("%s:%d check failed: %s\n", __FILE__, __LINE__, #CONDITION); \
+        return 1; \
+    }
+
+int main() {
+    //Two types instanced from same pool with counts that together need more than a chunk
+    EntityPool<TestEntity> pool;
+    size_t countFirst = ENTITY_POOL_CHUNK_SLOTS - 10;
+    size_t countSecond = 20;
+    IEntityPool::prewarm({{&pool, countFirst}, {&pool, countSecond}});
+    size_t capacity = pool.getCapacity();
+    TEST_CHECK(countFirst + countSecond <= capacity)
+
+    //Spawning both counts must not allocate any chunk
+    std::vector<std::shared_ptr<Entity>> entities;
+    for (size_t i = 0; i < countFirst + countSecond; ++i) {
+        entities.emplace_back(pool.make());
+    }
+    TEST_CHECK(pool.getUsed() == countFirst + countSecond)
+    TEST_CHECK(pool.getCapacity() == capacity)
+
+    //Prewarming again only reserves what is missing on top of entities alive
+    IEntityPool::prewarm({{&pool, countSecond}});
+    TEST_CHECK(entities.size() + countSecond <= pool.getCapacity())
+    return 0;
+}
@@ -0,0 +1,254 @@
+//
+// Created by Ion Agorria on 19/10/26
+//
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "engine/simulation/world/world.h"
+#include "engine/simulation/pathfinder/path_request.h"
+#include "engine/simulation/pathfinder/reservation_table.h"
+
+/**
+ * Map used by test world, '#' are walls, room at center has two entrances and bottom right tile is enclosed
+ */
+static const std::vector<std::string> testMap = {
+        "..........",
+        "..######..",
+        "..#....#..",
+        "..#.##.#..",
+        "....#.....",
+        "..###.##..",
+        ".......###",
+        ".......#.#",
+        ".......###",
+};
+
+/**
+ * World where pathfinders of test request search
+ */
+static World* testWorld = nullptr;
+
+/**
+ * Reservations that pathfinders of test request consider
+ */
+static ReservationTable* testReservations = nullptr;
+
+/*
+ * World and request parts used by pathfinders, the rest needs a running simulation
+ */
+
+World::World(AssetLevel*, std::unordered_map<unsigned int, Image*>&, bool, bool): tileSize(1), tilesetIndex(0) {
+    Vector2 size(static_cast<int>(testMap.front().size()), static_cast<int>(testMap.size()));
+    realRectangle.set(Vector2(0), size);
+    for (int y = 0; y < size.y; ++y) {
+        for (int x = 0; x < size.x; ++x) {
+            Vector2 position(x, y);
+            std::unique_ptr<Tile> tile = std::make_unique<Tile>(static_cast<tile_index_t>(tiles.size()), position);
+            tile->tileFlags = testMap[y][x] == '#' ? 0 : TILE_FLAG_PASSABLE;
+            tile->world = this;
+            tiles.emplace_back(std::move(tile));
+        }
+    }
+    for (std::unique_ptr<Tile>& tile : tiles) {
+        for (int y = -1; y <= 1; y++) {
+            for (int x = -1; x <= 1; x++) {
+                int ax = tile->position.x + x;
+                int ay = tile->position.y + y;
+                if ((x == 0 && y == 0) || ax < 0 || ay < 0 || realRectangle.w <= ax || realRectangle.h <= ay) continue;
+                tile->adjacents.emplace_back(getTile(static_cast<unsigned int>(ax), static_cast<unsigned int>(ay)));
+            }
+        }
+    }
+    passability = std::make_unique<Passability>(this);
+    clearance = std::make_unique<Clearance>(this);
+}
+
+World::~World() = default;
+
+std::vector<std::unique_ptr<Tile>>& World::getTiles() {
+    return tiles;
+}
+
+const Rectangle& World::getRealRectangle() {
+    return realRectangle;
+}
+
+Passability* World::getPassability() const {
+    return passability.get();
+}
+
+Clearance* World::getClearance() const {
+    return clearance.get();
+}
+
+Tile* World::getTile(tile_index_t index) const {
+    return index < tiles.size() ? tiles[index].get() : nullptr;
+}
+
+Tile* World::getTile(unsigned int x, unsigned int y) const {
+    return getTile(x + realRectangle.w * y);
+}
+
+Tile::Tile(tile_index_t index, Vector2& position): index(index), position(position) {
+}
+
+std::string Tile::toStringContent() const {
+    return std::to_string(index) + ", " + position.toString();
+}
+
+PathRequest::PathRequest(std::shared_ptr<PathArenas> arenas): arenas(std::move(arenas)) {
+}
+
+PathRequest::~PathRequest() {
+    pathfinders.clear();
+}
+
+void PathRequest::initialize() {
+    vertexesCount = testWorld->getTiles().size();
+}
+
+World* PathRequest::getWorld() const {
+    return testWorld;
+}
+
+PathArenas& PathRequest::getArenas() {
+    return *arenas;
+}
+
+size_t PathRequest::getVertexesCount() const {
+    return vertexesCount;
+}
+
+path_cost_t PathRequest::getReservationCost(const Tile* tile, entity_id_t entity) const {
+    return testReservations && testReservations->isReservedByOther(tile->index, entity) ? RESERVATION_COST : 0;
+}
+
+log_ptr Log::get(const std::string& name) {
+    log_ptr logger = spdlog::get(name);
+    return logger ? logger : spdlog::stdout_logger_mt(name);
+}
+
+/**
+ * Checks a condition and prints the failure
+ */
+#define TEST_CHECK(CONDITION) \
+    if (!(CONDITION)) { \
+        std::printf("%s:%d check failed: %s\n", __FILE__, __LINE__, #CONDITION); \
+        return 1; \
+    }
+
+/**
+ * Checks that path goes from destination at front to start at back through adjacent passable tiles
+ */
+static bool isValidPath(const std::vector<const Tile*>& path, const Tile* start, const Tile* destination) {
+    if (path.empty() || path.front() != destination || path.back() != start) {
+        return false;
+    }
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (!(path[i]->tileFlags & TILE_FLAG_PASSABLE)) {
+            return false;
+        }
+        if (0 < i && (1 < std::abs(path[i]->position.x - path[i - 1]->position.x)
+                   || 1 < std::abs(path[i]->position.y - path[i - 1]->position.y))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Plans and computes the search until is done
+ */
+static PathFinderStatus run(PathFinder& pathfinder, Tile* start, Tile* destination) {
+    pathfinder.plan(start, destination, 0, start->index);
+    while (pathfinder.isComputing()) {
+        pathfinder.compute(16);
+    }
+    return pathfinder.getStatus();
+}
+
+int main() {
+    std::unordered_map<unsigned int, Image*> images;
+    World world(nullptr, images, false, false);
+    testWorld = &world;
+
+    //Two entities sent to same tile share the request like PathHandler does, each search must keep its own chain
+    PathRequest request(std::make_shared<PathArenas>());
+    request.initialize();
+    Tile* destination = world.getTile(6, 2);
+    Tile* startFirst = world.getTile(0, 0);
+    Tile* startSecond = world.getTile(9, 5);
+    JumpPointSearch first(&request, 1, TILE_FLAG_PASSABLE);
+    JumpPointSearch second(&request, 2, TILE_FLAG_PASSABLE);
+    TEST_CHECK(run(first, startFirst, destination) == PathFinderStatus::Success)
+    TEST_CHECK(run(second, startSecond, destination) == PathFinderStatus::Success)
+
+    std::vector<const Tile*> pathFirst;
+    std::vector<const Tile*> pathSecond;
+    TEST_CHECK(first.getPath(pathFirst))
+    TEST_CHECK(second.getPath(pathSecond))
+    TEST_CHECK(isValidPath(pathFirst, startFirst, destination))
+    TEST_CHECK(isValidPath(pathSecond, startSecond, destination))
+
+    //Partial searches of same request don't mix either
+    AStar partialFirst(&request, 1, TILE_FLAG_PASSABLE, 1);
+    AStar partialSecond(&request, 2, TILE_FLAG_PASSABLE, 1);
+    Tile* enclosed = world.getTile(8, 7);
+    TEST_CHECK(run(partialFirst, startFirst, enclosed) == PathFinderStatus::Partial)
+    TEST_CHECK(run(partialSecond, startSecond, enclosed) == PathFinderStatus::Partial)
+    pathFirst.clear();
+    pathSecond.clear();
+    TEST_CHECK(partialFirst.getPath(pathFirst))
+    TEST_CHECK(partialSecond.getPath(pathSecond))
+    TEST_CHECK(!pathFirst.empty() && pathFirst.back() == startFirst)
+    TEST_CHECK(!pathSecond.empty() && pathSecond.back() == startSecond)
+
+    //Entity blocking the top corridor must be avoided without making terrain jumps recalculate
+    Passability* passability = world.getPassability();
+    passability->getJumpLayer(TILE_FLAG_PASSABLE, 0);
+    Tile* occupied = world.getTile(4, 0);
+    occupied->entityFlags = TILE_FLAG_ENTITY_TERRAIN;
+    passability->tileChanged(occupied);
+    TEST_CHECK(!passability->getLayer(TILE_FLAG_PASSABLE, 0).dirty)
+    Tile* corridorEnd = world.getTile(9, 0);
+    JumpPointSearch blocked(&request, 1, TILE_FLAG_PASSABLE);
+    blocked.plan(startFirst, corridorEnd, TILE_FLAG_ENTITY_TERRAIN, startFirst->index);
+    while (blocked.isComputing()) {
+        blocked.compute(16);
+    }
+    TEST_CHECK(blocked.getStatus() == PathFinderStatus::Success)
+    std::vector<const Tile*> pathBlocked;
+    TEST_CHECK(blocked.getPath(pathBlocked))
+    TEST_CHECK(isValidPath(pathBlocked, startFirst, corridorEnd))
+    for (const Tile* tile : pathBlocked) {
+        TEST_CHECK(tile != occupied)
+    }
+
+    //Entity going along bottom row takes a short detour around tile reserved by other one coming from front
+    ReservationTable reservations(world.getTiles().size());
+    testReservations = &reservations;
+    Tile* reserved = world.getTile(3, 6);
+    TEST_CHECK(reservations.reserve(2, reserved->index, 0, 10))
+    Tile* rowStart = world.getTile(0, 6);
+    Tile* rowEnd = world.getTile(6, 6);
+    AStar detour(&request, 1, TILE_FLAG_PASSABLE, 1);
+    TEST_CHECK(run(detour, rowStart, rowEnd) == PathFinderStatus::Success)
+    std::vector<const Tile*> pathDetour;
+    TEST_CHECK(detour.getPath(pathDetour))
+    TEST_CHECK(isValidPath(pathDetour, rowStart, rowEnd))
+    for (const Tile* tile : pathDetour) {
+        TEST_CHECK(tile != reserved)
+    }
+
+    //Own reservations don't add cost so entity keeps the straight path
+    AStar own(&request, 2, TILE_FLAG_PASSABLE, 1);
+    TEST_CHECK(run(own, rowStart, rowEnd) == PathFinderStatus::Success)
+    std::vector<const Tile*> pathOwn;
+    TEST_CHECK(own.getPath(pathOwn))
+    TEST_CHECK(pathOwn.size() == 7)
+    TEST_CHECK(std::find(pathOwn.begin(), pathOwn.end(), reserved) != pathOwn.end())
+    testReservations = nullptr;
+    return 0;
+}